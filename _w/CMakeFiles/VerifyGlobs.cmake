@@ -0,0 +1,24 @@
+# CMAKE generated file: DO NOT EDIT!
+# Generated by CMake Version 3.25
+cmake_policy(SET CMP0009 NEW)
+
+# source at CMakeLists.txt:16 (file)
+file(GLOB_RECURSE NEW_GLOB LIST_DIRECTORIES false "/root/repo/src/*.c")
+set(OLD_GLOB
+  "/root/repo/src/vscc_allocator.c"
+  "/root/repo/src/vscc_array.c"
+  "/root/repo/src/vscc_automaton.c"
+  "/root/repo/src/vscc_cache.c"
+  "/root/repo/src/vscc_grammar.c"
+  "/root/repo/src/vscc_grammar_snapshot.c"
+  "/root/repo/src/vscc_jit.c"
+  "/root/repo/src/vscc_lexer.c"
+  "/root/repo/src/vscc_main.c"
+  "/root/repo/src/vscc_match.c"
+  "/root/repo/src/vscc_rule.c"
+  "/root/repo/src/vscc_rule_parse.c"
+  )
+if(NOT "${NEW_GLOB}" STREQUAL "${OLD_GLOB}")
+  message("-- GLOB mismatch!")
+  file(TOUCH_NOCREATE "/root/repo/_w/CMakeFiles/cmake.verify_globs")
+endif()
@@ -0,0 +1,30 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/vscc_allocator.c" "CMakeFiles/vscc.dir/src/vscc_allocator.c.o" "gcc" "CMakeFiles/vscc.dir/src/vscc_allocator.c.o.d"
+  "/root/repo/src/vscc_array.c" "CMakeFiles/vscc.dir/src/vscc_array.c.o" "gcc" "CMakeFiles/vscc.dir/src/vscc_array.c.o.d"
+  "/root/repo/src/vscc_automaton.c" "CMakeFiles/vscc.dir/src/vscc_automaton.c.o" "gcc" "CMakeFiles/vscc.dir/src/vscc_automaton.c.o.d"
+  "/root/repo/src/vscc_cache.c" "CMakeFiles/vscc.dir/src/vscc_cache.c.o" "gcc" "CMakeFiles/vscc.dir/src/vscc_cache.c.o.d"
+  "/root/repo/src/vscc_grammar.c" "CMakeFiles/vscc.dir/src/vscc_grammar.c.o" "gcc" "CMakeFiles/vscc.dir/src/vscc_grammar.c.o.d"
+  "/root/repo/src/vscc_grammar_snapshot.c" "CMakeFiles/vscc.dir/src/vscc_grammar_snapshot.c.o" "gcc" "CMakeFiles/vscc.dir/src/vscc_grammar_snapshot.c.o.d"
+  "/root/repo/src/vscc_jit.c" "CMakeFiles/vscc.dir/src/vscc_jit.c.o" "gcc" "CMakeFiles/vscc.dir/src/vscc_jit.c.o.d"
+  "/root/repo/src/vscc_lexer.c" "CMakeFiles/vscc.dir/src/vscc_lexer.c.o" "gcc" "CMakeFiles/vscc.dir/src/vscc_lexer.c.o.d"
+  "/root/repo/src/vscc_main.c" "CMakeFiles/vscc.dir/src/vscc_main.c.o" "gcc" "CMakeFiles/vscc.dir/src/vscc_main.c.o.d"
+  "/root/repo/src/vscc_match.c" "CMakeFiles/vscc.dir/src/vscc_match.c.o" "gcc" "CMakeFiles/vscc.dir/src/vscc_match.c.o.d"
+  "/root/repo/src/vscc_rule.c" "CMakeFiles/vscc.dir/src/vscc_rule.c.o" "gcc" "CMakeFiles/vscc.dir/src/vscc_rule.c.o.d"
+  "/root/repo/src/vscc_rule_parse.c" "CMakeFiles/vscc.dir/src/vscc_rule_parse.c.o" "gcc" "CMakeFiles/vscc.dir/src/vscc_rule_parse.c.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
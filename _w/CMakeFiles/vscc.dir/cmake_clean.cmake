@@ -0,0 +1,33 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/vscc.dir/src/vscc_allocator.c.o"
+  "CMakeFiles/vscc.dir/src/vscc_allocator.c.o.d"
+  "CMakeFiles/vscc.dir/src/vscc_array.c.o"
+  "CMakeFiles/vscc.dir/src/vscc_array.c.o.d"
+  "CMakeFiles/vscc.dir/src/vscc_automaton.c.o"
+  "CMakeFiles/vscc.dir/src/vscc_automaton.c.o.d"
+  "CMakeFiles/vscc.dir/src/vscc_cache.c.o"
+  "CMakeFiles/vscc.dir/src/vscc_cache.c.o.d"
+  "CMakeFiles/vscc.dir/src/vscc_grammar.c.o"
+  "CMakeFiles/vscc.dir/src/vscc_grammar.c.o.d"
+  "CMakeFiles/vscc.dir/src/vscc_grammar_snapshot.c.o"
+  "CMakeFiles/vscc.dir/src/vscc_grammar_snapshot.c.o.d"
+  "CMakeFiles/vscc.dir/src/vscc_jit.c.o"
+  "CMakeFiles/vscc.dir/src/vscc_jit.c.o.d"
+  "CMakeFiles/vscc.dir/src/vscc_lexer.c.o"
+  "CMakeFiles/vscc.dir/src/vscc_lexer.c.o.d"
+  "CMakeFiles/vscc.dir/src/vscc_main.c.o"
+  "CMakeFiles/vscc.dir/src/vscc_main.c.o.d"
+  "CMakeFiles/vscc.dir/src/vscc_match.c.o"
+  "CMakeFiles/vscc.dir/src/vscc_match.c.o.d"
+  "CMakeFiles/vscc.dir/src/vscc_rule.c.o"
+  "CMakeFiles/vscc.dir/src/vscc_rule.c.o.d"
+  "CMakeFiles/vscc.dir/src/vscc_rule_parse.c.o"
+  "CMakeFiles/vscc.dir/src/vscc_rule_parse.c.o.d"
+  "vscc"
+  "vscc.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/vscc.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,427 @@
+/**
+ * @brief matching throughput benchmark
+ *
+ * @note usage: vscc_bench [case...], all cases are run if none is given.
+ *       Numbers are meaningful only for optimized builds (-DCMAKE_BUILD_TYPE=Release).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "vscc.h"
+
+/// @brief approximate size of benchmark inputs
+#define VSCC_BENCH_INPUT_SIZE ((size_t)4 << 20)
+
+/// @brief minimal total time of measured runs in seconds
+#define VSCC_BENCH_MIN_TIME 0.25
+
+/// @brief benchmark case function
+typedef bool (* VsccBenchFunction)( void );
+
+/// @brief string terminal matching function (vsccRuleStringTerminalMatch signature)
+typedef bool (* VsccBenchTerminalMatch)( const VsccRule *rule, const char *strBegin, const char *strEnd );
+
+/// @brief benchmark case
+typedef struct __VsccBenchCase {
+    const char        * name;     ///< case name
+    VsccBenchFunction   function; ///< case function (returns false if case failed)
+} VsccBenchCase;
+
+/**
+ * @brief current time getting function
+ *
+ * @return monotonic time in seconds
+ */
+static double vsccBenchGetTime( void ) {
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+} // vsccBenchGetTime
+
+/**
+ * @brief input filling by repeated pieces function
+ *
+ * @param[in]  pieces     pieces to repeat (non-null)
+ * @param[in]  pieceCount count of pieces (non-zero)
+ * @param[out] size       input size destination (non-null)
+ *
+ * @note pieces are picked by fixed-seed generator, so input is the same on every run
+ *
+ * @return input (NULL if allocation failed, should be freed)
+ */
+static char * vsccBenchInput( const char **pieces, size_t pieceCount, size_t *size ) {
+    size_t maxPieceLength = 0;
+
+    for (size_t i = 0; i < pieceCount; i++)
+        if (strlen(pieces[i]) > maxPieceLength)
+            maxPieceLength = strlen(pieces[i]);
+
+    char *input = (char *)malloc(VSCC_BENCH_INPUT_SIZE + maxPieceLength);
+    size_t length = 0;
+    uint32_t state = 1;
+
+    if (input == NULL)
+        return NULL;
+
+    while (length < VSCC_BENCH_INPUT_SIZE) {
+        state = state * 1664525 + 1013904223;
+
+        const char *piece = pieces[(state >> 16) % pieceCount];
+
+        memcpy(input + length, piece, strlen(piece));
+        length += strlen(piece);
+    }
+
+    *size = length;
+    return input;
+} // vsccBenchInput
+
+/**
+ * @brief interpreter throughput measuring function
+ *
+ * @param[in] name      measurement name (non-null)
+ * @param[in] grammar   grammar to match by (non-null, linked)
+ * @param[in] ruleIndex rule to match input by
+ * @param[in] input     input text (non-null)
+ * @param[in] size      input size
+ *
+ * @return true if whole input matched, false otherwise
+ */
+static bool vsccBenchMatcher( const char *name, const VsccGrammar *grammar, size_t ruleIndex, const char *input, size_t size ) {
+    VsccMatcher matcher = vsccMatcherCtor(grammar, NULL);
+    size_t runCount = 0;
+    double time = 0.0;
+    bool matched = matcher != NULL;
+
+    while (matched && time < VSCC_BENCH_MIN_TIME) {
+        const double startTime = vsccBenchGetTime();
+
+        matched = true
+            && vsccMatcherRun(matcher, ruleIndex, input, input + size) == VSCC_MATCH_OK
+            && vsccMatcherLength(matcher) == size
+        ;
+        time += vsccBenchGetTime() - startTime;
+        runCount++;
+    }
+
+    if (matched)
+        printf("%-32s %10.1f MB/s\n", name, size * runCount / time / 1e6);
+    else
+        printf("%-32s FAILED\n", name);
+
+    vsccMatcherDtor(matcher);
+    return matched;
+} // vsccBenchMatcher
+
+/**
+ * @brief JIT throughput measuring function
+ *
+ * @param[in] name      measurement name (non-null)
+ * @param[in] grammar   grammar to match by (non-null, linked)
+ * @param[in] ruleIndex rule to match input by
+ * @param[in] input     input text (non-null)
+ * @param[in] size      input size
+ *
+ * @return true if whole input matched or JIT isn't available, false otherwise
+ */
+static bool vsccBenchJit( const char *name, const VsccGrammar *grammar, size_t ruleIndex, const char *input, size_t size ) {
+    VsccJit jit = vsccJitCtor(grammar, NULL);
+    size_t runCount = 0;
+    double time = 0.0;
+    bool matched = true;
+
+    if (jit == NULL) {
+        printf("%-32s unavailable\n", name);
+        return true;
+    }
+
+    while (matched && time < VSCC_BENCH_MIN_TIME) {
+        const double startTime = vsccBenchGetTime();
+        size_t length = 0;
+
+        matched = vsccJitMatch(jit, ruleIndex, input, input + size, &length) == VSCC_MATCH_OK && length == size;
+        time += vsccBenchGetTime() - startTime;
+        runCount++;
+    }
+
+    if (matched)
+        printf("%-32s %10.1f MB/s\n", name, size * runCount / time / 1e6);
+    else
+        printf("%-32s FAILED\n", name);
+
+    vsccJitDtor(jit);
+    return matched;
+} // vsccBenchJit
+
+/**
+ * @brief string terminal near miss rule constructor
+ *
+ * @param[in] terminal     terminal text (non-null, at least one byte long)
+ * @param[in] missTerminal terminal differing in the last byte only (non-null)
+ *
+ * @return repetition of variant trying missTerminal first (NULL if failed)
+ */
+static VsccRule * vsccBenchMissRule( const char *terminal, const char *missTerminal ) {
+    VsccRule *alternatives[] = {
+        vsccRuleStringTerminal(missTerminal, NULL),
+        vsccRuleStringTerminal(terminal, NULL),
+    };
+
+    return vsccRuleRepeat(vsccRuleVariant(alternatives, 2), false);
+} // vsccBenchMissRule
+
+/**
+ * @brief string terminal matching by strlen and strncmp function (matching before terminals stored their length)
+ *
+ * @param[in] rule     string terminal rule (non-null)
+ * @param[in] strBegin text begin (non-null)
+ * @param[in] strEnd   text end
+ *
+ * @return true if text starts with terminal, false otherwise
+ */
+static bool vsccBenchStrncmpMatch( const VsccRule *rule, const char *strBegin, const char *strEnd ) {
+    const size_t length = strlen(rule->stringTerminal.string);
+
+    return length <= (size_t)(strEnd - strBegin) && strncmp(strBegin, rule->stringTerminal.string, length) == 0;
+} // vsccBenchStrncmpMatch
+
+/**
+ * @brief string terminal scanning throughput measuring function
+ *
+ * @param[in] match        terminal matching function (non-null)
+ * @param[in] terminal     terminal input consists of (non-null)
+ * @param[in] missTerminal terminal tried before 'terminal' at every offset (nullable)
+ * @param[in] input        input text (non-null)
+ * @param[in] size         input size
+ *
+ * @return throughput in MB/s (0 if input isn't scanned completely)
+ */
+static double vsccBenchTerminalScan( VsccBenchTerminalMatch match, const VsccRule *terminal, const VsccRule *missTerminal, const char *input, size_t size ) {
+    const char *inputEnd = input + size;
+    size_t runCount = 0;
+    double time = 0.0;
+
+    while (time < VSCC_BENCH_MIN_TIME) {
+        const double startTime = vsccBenchGetTime();
+        const char *cursor = input;
+
+        while (cursor < inputEnd) {
+            if (missTerminal != NULL && match(missTerminal, cursor, inputEnd))
+                return 0.0;
+            if (!match(terminal, cursor, inputEnd))
+                return 0.0;
+            cursor += terminal->stringTerminal.length;
+        }
+        time += vsccBenchGetTime() - startTime;
+        runCount++;
+    }
+
+    return size * runCount / time / 1e6;
+} // vsccBenchTerminalScan
+
+/**
+ * @brief string terminal matching benchmark case
+ *
+ * @note terminals are 1, 8, 32 and 256 bytes long. In 'hit' runs every terminal matches,
+ *       in 'miss' runs terminal differing in the last byte is tried first. Matcher runs are
+ *       followed by bare terminal scans with vsccRuleStringTerminalMatch and strlen+strncmp baseline.
+ *
+ * @return true if succeeded, false otherwise
+ */
+static bool vsccBenchStringTerminals( void ) {
+    static const size_t lengths[] = { 1, 8, 32, 256 };
+    bool succeeded = true;
+
+    for (size_t i = 0; succeeded && i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+        char terminal[257], missTerminal[257], name[64];
+
+        for (size_t j = 0; j < lengths[i]; j++)
+            terminal[j] = (char)('a' + j % 26);
+        terminal[lengths[i]] = '\0';
+        memcpy(missTerminal, terminal, lengths[i] + 1);
+        missTerminal[lengths[i] - 1] = '#';
+
+        const char *pieces[] = { terminal };
+        size_t size = 0;
+        char *input = vsccBenchInput(pieces, 1, &size);
+        VsccGrammar *grammar = vsccGrammarCtor(NULL);
+
+        succeeded = true
+            && input != NULL
+            && grammar != NULL
+            && vsccGrammarAddRule(grammar, "hit", vsccRuleRepeat(vsccRuleStringTerminal(terminal, NULL), false))
+            && vsccGrammarAddRule(grammar, "miss", vsccBenchMissRule(terminal, missTerminal))
+            && vsccGrammarLink(grammar)
+        ;
+
+        if (succeeded) {
+            sprintf(name, "string terminal %zu hit", lengths[i]);
+            succeeded = vsccBenchMatcher(name, grammar, 0, input, size);
+        }
+        if (succeeded) {
+            sprintf(name, "string terminal %zu miss", lengths[i]);
+            succeeded = vsccBenchMatcher(name, grammar, 1, input, size);
+        }
+
+        VsccRule *hitRule = vsccRuleStringTerminal(terminal, NULL);
+        VsccRule *missRule = vsccRuleStringTerminal(missTerminal, NULL);
+
+        succeeded = succeeded && hitRule != NULL && missRule != NULL;
+
+        for (size_t miss = 0; succeeded && miss < 2; miss++) {
+            const double fast = vsccBenchTerminalScan(vsccRuleStringTerminalMatch, hitRule, miss ? missRule : NULL, input, size);
+            const double baseline = vsccBenchTerminalScan(vsccBenchStrncmpMatch, hitRule, miss ? missRule : NULL, input, size);
+
+            sprintf(name, "string terminal %zu %s scan", lengths[i], miss ? "miss" : "hit");
+            succeeded = fast != 0.0 && baseline != 0.0;
+            if (succeeded)
+                printf("%-32s %10.1f MB/s, strncmp %10.1f MB/s (x%.2f)\n", name, fast, baseline, fast / baseline);
+            else
+                printf("%-32s FAILED\n", name);
+        }
+
+        vsccRuleDtor(hitRule);
+        vsccRuleDtor(missRule);
+        vsccGrammarDtor(grammar);
+        free(input);
+    }
+
+    return succeeded;
+} // vsccBenchStringTerminals
+
+/**
+ * @brief grammar parsing and linking function
+ *
+ * @param[in] source grammar source in .vsg syntax (non-null, null-terminated)
+ *
+ * @return linked grammar (NULL if failed)
+ */
+static VsccGrammar * vsccBenchGrammar( const char *source ) {
+    const VsccGrammarParseResult result = vsccGrammarParse(source, source + strlen(source), NULL);
+
+    if (result.status != VSCC_RULE_PARSE_OK)
+        return NULL;
+    if (!vsccGrammarLink(result.ok)) {
+        vsccGrammarDtor(result.ok);
+        return NULL;
+    }
+    return result.ok;
+} // vsccBenchGrammar
+
+/**
+ * @brief character class matching benchmark case
+ *
+ * @note same word class is matched over ASCII-only and mixed-script (Latin, Cyrillic, Greek, CJK) text
+ *
+ * @return true if succeeded, false otherwise
+ */
+static bool vsccBenchCharClasses( void ) {
+    static const char *asciiPieces[] = { "lorem", "ipsum", "dolor", "sit", "amet", " ", ", ", ".\n" };
+    static const char *mixedPieces[] = { "lorem", "ipsum", "текст", "слово", "λόγος", "κείμενο", "文字", "言葉", " ", ", ", ".\n" };
+    VsccGrammar *grammar = vsccBenchGrammar(
+        "text  ::= { word | space }*\n"
+        "word  ::= [a-zA-Zа-яА-ЯёЁά-ώα-ωΑ-Ω一-鿿]+\n"
+        "space ::= [ \\n.,]+\n"
+    );
+    size_t asciiSize = 0, mixedSize = 0;
+    char *asciiInput = vsccBenchInput(asciiPieces, sizeof(asciiPieces) / sizeof(asciiPieces[0]), &asciiSize);
+    char *mixedInput = vsccBenchInput(mixedPieces, sizeof(mixedPieces) / sizeof(mixedPieces[0]), &mixedSize);
+    const bool succeeded = true
+        && grammar != NULL
+        && asciiInput != NULL
+        && mixedInput != NULL
+        && vsccBenchMatcher("char class ascii", grammar, 0, asciiInput, asciiSize)
+        && vsccBenchMatcher("char class mixed script", grammar, 0, mixedInput, mixedSize)
+    ;
+
+    vsccGrammarDtor(grammar);
+    free(asciiInput);
+    free(mixedInput);
+    return succeeded;
+} // vsccBenchCharClasses
+
+/**
+ * @brief JIT versus interpreter benchmark case
+ *
+ * @note statement language is matched by VsccMatcher and by VsccJit
+ *
+ * @return true if succeeded, false otherwise
+ */
+static bool vsccBenchJitVersusMatcher( void ) {
+    static const char *pieces[] = {
+        "v1 = 867 + (w1 - 32);\n",
+        "value = (a + (b - c)) - 42;\n",
+        "x = y;\n",
+        "total = total + item_17 - (discount + 3) ;\n",
+    };
+    VsccGrammar *grammar = vsccBenchGrammar(
+        "file ::= ws stmt* $\n"
+        "stmt ::= id ws \"=\" ws expr ws \";\" ws\n"
+        "expr ::= term ws { { \"+\" | \"-\" } ws term ws }*\n"
+        "term ::= id | num | \"(\" ws expr ws \")\"\n"
+        "id   ::= [a-zA-Z_] [a-zA-Z0-9_]*\n"
+        "num  ::= [0-9]+\n"
+        "ws   ::= [ \\t\\n\\r]*\n"
+    );
+    size_t size = 0;
+    char *input = vsccBenchInput(pieces, sizeof(pieces) / sizeof(pieces[0]), &size);
+    const bool succeeded = true
+        && grammar != NULL
+        && input != NULL
+        && vsccBenchMatcher("statements interpreter", grammar, 0, input, size)
+        && vsccBenchJit("statements jit", grammar, 0, input, size)
+    ;
+
+    vsccGrammarDtor(grammar);
+    free(input);
+    return succeeded;
+} // vsccBenchJitVersusMatcher
+
+/// @brief benchmark cases
+static const VsccBenchCase vsccBenchCases[] = {
+    { "string",    vsccBenchStringTerminals  },
+    { "charclass", vsccBenchCharClasses      },
+    { "jit",       vsccBenchJitVersusMatcher },
+};
+
+/**
+ * @brief benchmark main function
+ *
+ * @param[in] argc count of command line arguments
+ * @param[in] argv command line arguments (case names)
+ *
+ * @return exit status (0 if all cases succeeded, 1 otherwise)
+ */
+int main( int argc, const char **argv ) {
+    const size_t caseCount = sizeof(vsccBenchCases) / sizeof(vsccBenchCases[0]);
+    bool succeeded = true;
+
+    for (int i = 1; i < argc; i++) {
+        size_t index = 0;
+
+        while (index < caseCount && strcmp(vsccBenchCases[index].name, argv[i]) != 0)
+            index++;
+        if (index == caseCount) {
+            fprintf(stderr, "unknown case '%s'\n", argv[i]);
+            return 1;
+        }
+    }
+
+    for (size_t i = 0; i < caseCount; i++) {
+        bool selected = argc == 1;
+
+        for (int j = 1; !selected && j < argc; j++)
+            selected = strcmp(vsccBenchCases[i].name, argv[j]) == 0;
+
+        if (selected && !vsccBenchCases[i].function())
+            succeeded = false;
+    }
+
+    return succeeded ? 0 : 1;
+} // main
+
+// vscc_bench.c
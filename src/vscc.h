@@ -6,8 +6,81 @@
 #define VSCC_H_
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 
+/// @brief memory allocator interface
+typedef struct __VsccAllocator {
+    void * (* allocate   )( void *context, size_t size );              ///< block allocation function (NULL if failed)
+    void * (* reallocate )( void *context, void *block, size_t size ); ///< block resizing function (NULL if failed, block is kept then)
+    void   (* deallocate )( void *context, void *block );              ///< block freeing function (block is nullable)
+    void   * context;                                                  ///< context passed to functions
+} VsccAllocator;
+
+/**
+ * @brief memory allocation function
+ * 
+ * @param[in] allocator allocator (nullable, malloc is used then)
+ * @param[in] size      block size
+ * 
+ * @return allocated block (NULL if failed)
+ */
+void * vsccAllocate( const VsccAllocator *allocator, size_t size );
+
+/**
+ * @brief zeroed array allocation function
+ * 
+ * @param[in] allocator allocator (nullable, malloc is used then)
+ * @param[in] count     count of elements
+ * @param[in] size      element size
+ * 
+ * @return allocated zeroed block (NULL if failed or count * size overflows)
+ */
+void * vsccAllocateZeroed( const VsccAllocator *allocator, size_t count, size_t size );
+
+/**
+ * @brief memory reallocation function
+ * 
+ * @param[in] allocator allocator block is allocated by (nullable, realloc is used then)
+ * @param[in] block     block to resize (nullable)
+ * @param[in] size      new block size
+ * 
+ * @return resized block (NULL if failed, 'block' is kept valid then)
+ */
+void * vsccReallocate( const VsccAllocator *allocator, void *block, size_t size );
+
+/**
+ * @brief memory freeing function
+ * 
+ * @param[in] allocator allocator block is allocated by (nullable, free is used then)
+ * @param[in] block     block to free (nullable)
+ */
+void vsccDeallocate( const VsccAllocator *allocator, void *block );
+
+/// @brief byte counting (and limiting) allocator
+typedef struct __VsccCountingAllocator {
+    VsccAllocator         allocator;       ///< allocator interface (pass &counting->allocator to constructors)
+    const VsccAllocator * parent;          ///< allocator blocks are taken from (nullable)
+    size_t                limit;           ///< maximal count of simultaneously allocated bytes (SIZE_MAX if unlimited)
+    size_t                size;            ///< count of currently allocated bytes
+    size_t                peakSize;        ///< maximal count of simultaneously allocated bytes
+    size_t                allocationCount; ///< count of successful allocations and reallocations
+    size_t                failureCount;    ///< count of failed allocations and reallocations (refused by limit ones included)
+} VsccCountingAllocator;
+
+/**
+ * @brief counting allocator initialization function
+ * 
+ * @param[out] counting allocator to initialize (non-null, must outlive everything allocated by it)
+ * @param[in]  parent   allocator blocks are taken from (nullable, must outlive counting allocator)
+ * @param[in]  limit    maximal count of simultaneously allocated bytes (SIZE_MAX if unlimited)
+ * 
+ * @note sizes are counted as requested (block headers aren't counted), so 'size' is exact byte count
+ *       of objects allocated by the allocator. Allocations above limit fail just like out-of-memory ones.
+ *       Allocator isn't thread-safe, so it should be used by one thread at time.
+ */
+void vsccCountingAllocatorInit( VsccCountingAllocator *counting, const VsccAllocator *parent, size_t limit );
+
 /// @brief dynamic array representation structure
 typedef struct __VsccArrayImpl * VsccArray;
 
@@ -15,10 +88,11 @@ typedef struct __VsccArrayImpl * VsccArray;
  * @brief array constructor
  * 
  * @param[in] elementSize single array element size ( > 0)
+ * @param[in] allocator   allocator of array memory (nullable, must outlive array)
  * 
  * @return created array (may be NULL)
  */
-VsccArray vsccArrayCtor( size_t elementSize );
+VsccArray vsccArrayCtor( size_t elementSize, const VsccAllocator *allocator );
 
 /**
  * @brief array destructor
@@ -54,6 +128,16 @@ void * vsccArrayData( VsccArray array );
  */
 void * vsccGetArrayElement( VsccArray array, size_t index );
 
+/**
+ * @brief array truncation function
+ * 
+ * @param[in,out] array array to truncate (non-null)
+ * @param[in]     size  new array size (<= vsccArraySize(array))
+ * 
+ * @note array capacity isn't changed, so truncation never fails
+ */
+void vsccArrayTruncate( VsccArray array, size_t size );
+
 /**
  * @brief pushing function
  * 
@@ -76,6 +160,20 @@ bool vsccArrayPush( VsccArray *array, const void *data );
  */
 bool vsccArrayPop( VsccArray *array, void *data );
 
+/// @brief initial value of vsccHashBytes hash
+#define VSCC_HASH_INITIAL ((uint64_t)0xCBF29CE484222325)
+
+/**
+ * @brief byte sequence hashing function (FNV-1a)
+ * 
+ * @param[in] hash previous hash (VSCC_HASH_INITIAL for new one)
+ * @param[in] data data to hash (non-null if size != 0)
+ * @param[in] size data size
+ * 
+ * @return hash of previous hash and data
+ */
+uint64_t vsccHashBytes( uint64_t hash, const void *data, size_t size );
+
 /// @brief rule type ('tag')
 typedef enum __VsccRuleType {
     VSCC_RULE_SEQUENCE,        ///< first and second           ... ...
@@ -92,15 +190,21 @@ typedef enum __VsccRuleType {
 /// @brief grammar rule structure forward declaration
 typedef struct __VsccRule VsccRule;
 
+/// @brief maximal unicode code point
+#define VSCC_CODE_POINT_MAX 0x10FFFF
+
 /// @brief character range
 typedef struct __VsccRuleCharRange {
-    char first; ///< first matched character
-    char last;  ///< last matched character
+    uint32_t first; ///< first matched code point
+    uint32_t last;  ///< last matched code point (>= first, <= VSCC_CODE_POINT_MAX)
 } VsccRuleCharRange;
 
 /// @brief grammar rule representation structure
 struct __VsccRule {
-    VsccRuleType type; ///< rule type
+    VsccRuleType          type;      ///< rule type
+    size_t                id;        ///< terminal index in grammar (set by vsccGrammarLink for terminal and end rules)
+    uint64_t              hash;      ///< structural hash of rule subtree (set by constructors, equal subtrees have equal hashes)
+    const VsccAllocator * allocator; ///< allocator rule is allocated by (nullable)
 
     union {
         struct {
@@ -109,8 +213,9 @@ struct __VsccRule {
         } sequence;
 
         struct {
-            VsccRule ** rules; ///< rules
-            size_t      count; ///< count of rules
+            VsccRule ** rules;     ///< rules
+            size_t      count;     ///< count of rules
+            size_t      automaton; ///< index of terminal automaton in grammar (set by vsccGrammarLink, SIZE_MAX if none)
         } variant;
 
         struct {
@@ -119,13 +224,25 @@ struct __VsccRule {
         } repeat;
 
         struct {
-            VsccRuleCharRange * ranges; ///< character ranges
-            size_t              count;  ///< count of matched character ranges
+            VsccRuleCharRange * ranges;     ///< character ranges
+            size_t              count;      ///< count of matched character ranges
+            uint64_t            ascii[2];   ///< bitmap of matched ASCII characters
+            VsccRuleCharRange * table;      ///< sorted disjoint non-ASCII code point ranges
+            size_t              tableCount; ///< count of non-ASCII ranges
         } charTerminal;
 
+        struct {
+            const char * string; ///< terminal string (null-terminated, may contain zeros)
+            size_t       length; ///< terminal string length
+            uint64_t     prefix; ///< first min(length, 8) terminal bytes in memory order, zero-padded
+        } stringTerminal;
+
+        struct {
+            const char * name;  ///< referenced rule name
+            size_t       index; ///< referenced rule index in grammar (set by vsccGrammarLink)
+        } reference;
+
         VsccRule *optional;         ///< optional rule
-        const char *stringTerminal; ///< string constant
-        const char *reference;      ///< reference to another rule
     };
 }; // struct __VsccRule
 
@@ -136,8 +253,10 @@ struct __VsccRule {
  * @param[in] count count of rules in rule set (>= 1)
  * 
  * @note function gathers ownership of **elements** of 'rules' array, but not of 'rules' array itself
+ * @note rule is allocated by allocator of first element
+ * @note elements may be NULL (failed constructions), all elements are destroyed and NULL is returned then
  * 
- * @return rule that represents concatenation of 'rules' rules.
+ * @return rule that represents concatenation of 'rules' rules (may be NULL)
  */
 VsccRule * vsccRuleSequence( VsccRule **rules, size_t count );
 
@@ -148,8 +267,10 @@ VsccRule * vsccRuleSequence( VsccRule **rules, size_t count );
  * @param[in] count count of rules in rule set (>= 1)
  * 
  * @note function gathers ownership of **elements** of 'rules' array, but not of 'rules' array itself
+ * @note rule is allocated by allocator of first element
+ * @note elements may be NULL (failed constructions), all elements are destroyed and NULL is returned then
  * 
- * @return rule that represents variant of 'rules' rules.
+ * @return rule that represents variant of 'rules' rules (may be NULL)
  */
 VsccRule * vsccRuleVariant( VsccRule **rules, size_t count );
 
@@ -158,6 +279,8 @@ VsccRule * vsccRuleVariant( VsccRule **rules, size_t count );
  * 
  * @param[in] rule rule to create optional for (non-null)
  * 
+ * @note rule is allocated by allocator of 'rule'
+ * 
  * @return rule that represents option of 'rule' rule.
  */
 VsccRule * vsccRuleOptional( VsccRule *rule );
@@ -168,6 +291,8 @@ VsccRule * vsccRuleOptional( VsccRule *rule );
  * @param[in] rule        rule to create repeat of
  * @param[in] atLeastOnce should this rule be repeated at least one time
  * 
+ * @note rule is allocated by allocator of 'rule'
+ * 
  * @return repeat rule
  */
 VsccRule * vsccRuleRepeat( VsccRule *rule, bool atLeastOnce );
@@ -177,69 +302,115 @@ VsccRule * vsccRuleRepeat( VsccRule *rule, bool atLeastOnce );
  * 
  * @param[in] terminalBegin begin of string slice to construct terminal from (inclusive, non-null)
  * @param[in] terminalEnd   end of string slice to construct terminal from (exclusive, non-null, >= terminalBegin)
+ * @param[in] allocator     allocator of rule memory (nullable, must outlive rule)
  * 
  * @return created rule
  */
-VsccRule * vsccRuleStringTerminalFromSlice( const char *terminalBegin, const char *terminalEnd );
+VsccRule * vsccRuleStringTerminalFromSlice( const char *terminalBegin, const char *terminalEnd, const VsccAllocator *allocator );
 
 /**
  * @brief terminal symbol rule constructor
  * 
- * @param[in] terminal terminal symbol to construct rule based on (non-null, null-terminated)
+ * @param[in] terminal  terminal symbol to construct rule based on (non-null, null-terminated)
+ * @param[in] allocator allocator of rule memory (nullable, must outlive rule)
  * 
  * @return created rule
  */
-VsccRule * vsccRuleStringTerminal( const char *terminal );
+VsccRule * vsccRuleStringTerminal( const char *terminal, const VsccAllocator *allocator );
+
+/**
+ * @brief string terminal matching function
+ * 
+ * @param[in] rule     string terminal rule (non-null, type == VSCC_RULE_STRING_TERMINAL)
+ * @param[in] strBegin begin of string slice to match terminal at (non-null)
+ * @param[in] strEnd   end of string slice to match terminal at (non-null, >= strBegin)
+ * 
+ * @return true if slice starts with the terminal, false otherwise
+ * 
+ * @note function never reads bytes outside of [strBegin, strEnd) slice
+ */
+bool vsccRuleStringTerminalMatch( const VsccRule *rule, const char *strBegin, const char *strEnd );
 
 /**
  * @brief terminal symbol rule constructor
  * 
- * @param[in] ranges supported character range array (non-null)
- * @param[in] count  count of ranges in array (>= 1)
+ * @param[in] ranges    supported code point range array (non-null)
+ * @param[in] count     count of ranges in array (>= 1)
+ * @param[in] allocator allocator of rule memory (nullable, must outlive rule)
  * 
  * @return created rule
  */
-VsccRule * vsccRuleCharTerminal( const VsccRuleCharRange *ranges, size_t count );
+VsccRule * vsccRuleCharTerminal( const VsccRuleCharRange *ranges, size_t count, const VsccAllocator *allocator );
+
+/**
+ * @brief UTF-8 encoded code point decoding function
+ * 
+ * @param[in]  strBegin  begin of string slice to decode code point from (non-null)
+ * @param[in]  strEnd    end of string slice to decode code point from (non-null, >= strBegin)
+ * @param[out] codePoint decoded code point destination (non-null)
+ * 
+ * @note overlong sequences, surrogates and code points above VSCC_CODE_POINT_MAX are considered invalid
+ * 
+ * @return length of decoded sequence, 0 if slice doesn't start with valid sequence
+ */
+size_t vsccDecodeUtf8( const char *strBegin, const char *strEnd, uint32_t *codePoint );
+
+/**
+ * @brief character terminal matching function
+ * 
+ * @param[in] rule     character terminal rule (non-null, type == VSCC_RULE_CHAR_TERMINAL)
+ * @param[in] strBegin begin of string slice to match terminal at (non-null)
+ * @param[in] strEnd   end of string slice to match terminal at (non-null, >= strBegin)
+ * 
+ * @return length of UTF-8 sequence matched, 0 if terminal doesn't match
+ */
+size_t vsccRuleCharTerminalMatch( const VsccRule *rule, const char *strBegin, const char *strEnd );
 
 /**
  * @brief refererntial rule from string slice constructor
  * 
- * @param[in] refBegin begin of string slice to construct reference from (inclusive, non-null)
- * @param[in] refEnd   end of string slice to construct reference from (exclusive, non-null, >= refBegin)
+ * @param[in] refBegin  begin of string slice to construct reference from (inclusive, non-null)
+ * @param[in] refEnd    end of string slice to construct reference from (exclusive, non-null, >= refBegin)
+ * @param[in] allocator allocator of rule memory (nullable, must outlive rule)
  * 
  * @return created rule
  */
-VsccRule * vsccRuleReferernceFromSlice( const char *refBegin, const char *refEnd );
+VsccRule * vsccRuleReferernceFromSlice( const char *refBegin, const char *refEnd, const VsccAllocator *allocator );
 
 /**
  * @brief referential rule constructor
  * 
  * @param[in] reference referenced rule name
+ * @param[in] allocator allocator of rule memory (nullable, must outlive rule)
  * 
  * @return created rule
  */
-VsccRule * vsccRuleReference( const char *reference );
+VsccRule * vsccRuleReference( const char *reference, const VsccAllocator *allocator );
 
 /**
  * @brief rule that signals about sequence end create function
  * 
+ * @param[in] allocator allocator of rule memory (nullable, must outlive rule)
+ * 
  * @return end rule
  */
-VsccRule * vsccRuleEnd( void );
+VsccRule * vsccRuleEnd( const VsccAllocator *allocator );
 
 /**
  * @brief empty rule create function
  * 
+ * @param[in] allocator allocator of rule memory (nullable, must outlive rule)
+ * 
  * @return empty rule
  */
-VsccRule * vsccRuleEmpty( void );
+VsccRule * vsccRuleEmpty( const VsccAllocator *allocator );
 
 /**
  * @brief rule cloning function
  * 
  * @param[in] rule rule to clone
  * 
- * @return exact copy of 'rule' rule
+ * @return exact copy of 'rule' rule (allocated by same allocator)
  */
 VsccRule * vsccRuleClone( const VsccRule *rule );
 
@@ -262,7 +433,10 @@ void vsccRulePrint( FILE *out, const VsccRule *rule );
 typedef enum __VsccRuleParseStatus {
     VSCC_RULE_PARSE_OK,                   ///< parsing succeeded
     VSCC_RULE_PARSE_INTERNAL_ERROR,       ///< internal error occured
-    VSCC_RULE_PARSE_UNEXPECTED_TEXT_END, ///< unexpected end of text slice 
+    VSCC_RULE_PARSE_UNEXPECTED_TEXT_END,  ///< unexpected end of text slice 
+    VSCC_RULE_PARSE_UNEXPECTED_CHARACTER, ///< unexpected character (or invalid escape, UTF-8 sequence or character range)
+    VSCC_RULE_PARSE_RULE_REDEFINED,       ///< grammar rule is defined twice
+    VSCC_RULE_PARSE_UNDEFINED_REFERENCE,  ///< grammar rule references undefined rule
 } VsccRuleParseStatus;
 
 /// @brief rule parsing result
@@ -270,32 +444,776 @@ typedef struct __VsccRuleParseResult {
     VsccRuleParseStatus status; ///< operation status
 
     union {
-        VsccRule * ok; ///< parsed rule
+        VsccRule   * ok;    ///< parsed rule
+        const char * error; ///< position parsing failed at (if status isn't VSCC_RULE_PARSE_OK)
     };
 } VsccRuleParseResult;
 
 /**
  * @brief rule parsing function
  * 
- * @param[in]  strBegin start of string slice to parse rule from
- * @param[in]  strEnd   end of string slice to parse rule from
+ * @param[in]  strBegin  start of string slice to parse rule from
+ * @param[in]  strEnd    end of string slice to parse rule from
+ * @param[in]  allocator allocator of rule and parser memory (nullable, must outlive rule)
+ * 
+ * @note slice is right-hand side of .vsg rule definition (variants of sequences of terminals, groups
+ *       and references with postfix operators), newlines are treated as spaces
+ * 
+ * @return parsing result
+ */
+VsccRuleParseResult vsccRuleParse( const char *strBegin, const char *strEnd, const VsccAllocator *allocator );
+
+/**
+ * @brief rule semantic action
+ * 
+ * @param[in]  context    user context action is registered with
+ * @param[in]  strBegin   begin of text slice matched by rule
+ * @param[in]  strEnd     end of text slice matched by rule
+ * @param[in]  children   values produced by rule children (in matching order)
+ * @param[in]  childCount count of children values
+ * @param[out] result     rule value destination (non-null)
  * 
- * @return true if parsed, false if not
+ * @note values produced by backtracked attempts are dropped without notice,
+ *       so actions are expected to allocate from something arena-like.
+ * 
+ * @return true if succeeded, false to abort matching with VSCC_MATCH_INTERNAL_ERROR status
  */
-VsccRuleParseResult vsccRuleParse( const char *strBegin, const char *strEnd );
+typedef bool (* VsccRuleAction)( void *context, const char *strBegin, const char *strEnd, void **children, size_t childCount, void **result );
+
+/// @brief rule tokenization mode
+typedef enum __VsccTokenMode {
+    VSCC_TOKEN_NONE, ///< rule is syntactic (matched over tokens in token mode)
+    VSCC_TOKEN_EMIT, ///< rule is token, lexer emits it to token stream
+    VSCC_TOKEN_SKIP, ///< rule is token, lexer matches it, but drops it (spaces, comments)
+} VsccTokenMode;
 
 /// @brief name-rule pair
 typedef struct __VsccGrammarPair {
-    const char * name; ///< rule name
-    VsccRule   * rule; ///< rule itself
+    const char     * name;          ///< rule name
+    VsccRule       * rule;          ///< rule itself
+    bool             recover;       ///< resynchronize input at this rule in case if it fails after consuming some input
+    VsccRuleAction   action;        ///< action invoked on rule success (nullable)
+    void           * actionContext; ///< action context
+    VsccTokenMode    token;         ///< rule tokenization mode
+    bool             memoize;       ///< true if matchers memoize rule results (set by vsccGrammarLink)
 } VsccGrammarPair;
 
+/// @brief persistent cache of compiled grammar artifacts (blobs keyed by structural hashes)
+typedef struct __VsccCacheImpl * VsccCache;
+
+/**
+ * @brief cache constructor
+ * 
+ * @param[in] path cache file path (non-null)
+ * 
+ * @note missing, outdated or corrupted cache file is treated as empty cache
+ * 
+ * @return created cache (may be NULL)
+ */
+VsccCache vsccCacheCtor( const char *path );
+
+/**
+ * @brief cache destructor
+ * 
+ * @param[in] cache cache to destroy (nullable)
+ * 
+ * @note cache is not saved by destructor
+ */
+void vsccCacheDtor( VsccCache cache );
+
+/**
+ * @brief cache entry finding function
+ * 
+ * @param[in]  cache cache (non-null)
+ * @param[in]  key   entry key
+ * @param[out] size  entry size destination (non-null)
+ * 
+ * @return entry data (valid until entry is replaced or cache is destroyed, NULL if there is no such entry)
+ */
+const void * vsccCacheFind( VsccCache cache, uint64_t key, size_t *size );
+
+/**
+ * @brief cache entry inserting function
+ * 
+ * @param[in,out] cache cache (non-null)
+ * @param[in]     key   entry key
+ * @param[in]     data  entry data (copied, non-null if size != 0)
+ * @param[in]     size  entry size
+ * 
+ * @note entry with same key is replaced
+ * 
+ * @return true if inserted, false if allocation failed
+ */
+bool vsccCacheInsert( VsccCache cache, uint64_t key, const void *data, size_t size );
+
+/**
+ * @brief cache saving function
+ * 
+ * @param[in,out] cache cache (non-null)
+ * @param[in]     prune true if entries that weren't found or inserted since cache load should be dropped
+ * 
+ * @note cache file is replaced atomically and is not written at all if nothing changed
+ * 
+ * @return true if saved, false if writing failed
+ */
+bool vsccCacheSave( VsccCache cache, bool prune );
+
+/// @brief byte-level NFA of terminal alternation (ordered choice of string and character terminals)
+typedef struct __VsccNfaImpl * VsccNfa;
+
+/**
+ * @brief terminal alternation NFA constructor
+ * 
+ * @param[in] rule      variant rule to build NFA of (non-null, must outlive NFA)
+ * @param[in] cache     cache to load NFA from and store built NFA to (nullable)
+ * @param[in] allocator allocator of NFA memory (nullable, must outlive NFA)
+ * 
+ * @note NFA is built only for variants (including nested ones) of at least several string and character terminals
+ * 
+ * @return created NFA (NULL if rule isn't suitable or allocation failed)
+ */
+VsccNfa vsccNfaCtor( const VsccRule *rule, VsccCache cache, const VsccAllocator *allocator );
+
+/**
+ * @brief NFA destructor
+ * 
+ * @param[in] nfa NFA to destroy (nullable)
+ */
+void vsccNfaDtor( VsccNfa nfa );
+
+/**
+ * @brief NFA alternative count getting function
+ * 
+ * @param[in] nfa NFA (non-null)
+ * 
+ * @return count of terminals in alternation
+ */
+size_t vsccNfaAlternativeCount( const VsccNfa nfa );
+
+/**
+ * @brief NFA alternative getting function
+ * 
+ * @param[in] nfa   NFA (non-null)
+ * @param[in] index alternative index (< vsccNfaAlternativeCount(nfa))
+ * 
+ * @return alternative terminal
+ */
+const VsccRule * vsccNfaAlternative( const VsccNfa nfa, size_t index );
+
+/// @brief lazily determinized NFA with bounded state cache
+typedef struct __VsccLazyDfaImpl * VsccLazyDfa;
+
+/**
+ * @brief lazy DFA constructor
+ * 
+ * @param[in] nfa       NFA to determinize (non-null, must outlive DFA)
+ * @param[in] allocator allocator of DFA memory (nullable, must outlive DFA)
+ * 
+ * @return created DFA (may be NULL)
+ */
+VsccLazyDfa vsccLazyDfaCtor( const VsccNfa nfa, const VsccAllocator *allocator );
+
+/**
+ * @brief lazy DFA destructor
+ * 
+ * @param[in] dfa DFA to destroy (nullable)
+ */
+void vsccLazyDfaDtor( VsccLazyDfa dfa );
+
+/**
+ * @brief terminal alternation matching function
+ * 
+ * @param[in,out] dfa         DFA (non-null)
+ * @param[in]     strBegin    begin of string slice to match (non-null)
+ * @param[in]     strEnd      end of string slice to match (non-null, >= strBegin)
+ * @param[out]    alternative index of first alternative matched destination (non-null)
+ * @param[out]    length      matched alternative length destination (non-null)
+ * 
+ * @note DFA states are built when input reaches them and are kept in fixed-size cache, that
+ *       is flushed when full. If cache thrashes, DFA falls back to direct NFA simulation.
+ * 
+ * @return true if some alternative matched, false otherwise
+ */
+bool vsccLazyDfaMatch( VsccLazyDfa dfa, const char *strBegin, const char *strEnd, size_t *alternative, size_t *length );
+
 /// @brief grammar representation structure
 typedef struct __VsccGrammar {
-    size_t            ruleCount; ///< count of rules
-    VsccGrammarPair * rules;     ///< rules themselves
+    size_t                ruleCount;      ///< count of rules
+    VsccGrammarPair     * rules;          ///< rules themselves
+
+    bool                  linked;         ///< true if grammar is linked
+    size_t                terminalCount;  ///< count of distinct terminals (set by vsccGrammarLink)
+    const VsccRule     ** terminals;      ///< distinct terminals indexed by terminal id (set by vsccGrammarLink)
+    size_t                automatonCount; ///< count of terminal alternation automata (set by vsccGrammarLink)
+    VsccNfa             * automata;       ///< terminal alternation automata (set by vsccGrammarLink)
+
+    VsccCache             cache;          ///< compiled artifact cache (nullable, not owned, must outlive grammar)
+    const VsccAllocator * allocator;      ///< allocator of grammar memory (nullable, must outlive grammar)
 } VsccGrammar;
 
+/**
+ * @brief empty grammar constructor
+ * 
+ * @param[in] allocator allocator of grammar memory (names, rule table, link results and automata, nullable, must outlive grammar)
+ * 
+ * @note rules added to grammar keep their own allocators, so they should be created with grammar allocator
+ *       to account all grammar memory by single allocator
+ * 
+ * @return created grammar (may be NULL)
+ */
+VsccGrammar * vsccGrammarCtor( const VsccAllocator *allocator );
+
+/**
+ * @brief grammar destructor
+ * 
+ * @param[in] grammar grammar to destroy (nullable)
+ * 
+ * @note all grammar rules are destroyed too
+ */
+void vsccGrammarDtor( VsccGrammar *grammar );
+
+/**
+ * @brief grammar rule adding function
+ * 
+ * @param[in,out] grammar grammar to add rule to (non-null)
+ * @param[in]     name    rule name (non-null, null-terminated)
+ * @param[in]     rule    rule to add (nullable)
+ * 
+ * @note function gathers ownership of 'rule' (even if it fails) and unlinks grammar
+ * 
+ * @return true if added, false if not
+ */
+bool vsccGrammarAddRule( VsccGrammar *grammar, const char *name, VsccRule *rule );
+
+/**
+ * @brief grammar rule by name finding function
+ * 
+ * @param[in] grammar grammar to find rule in (non-null)
+ * @param[in] name    rule name (non-null, null-terminated)
+ * 
+ * @return rule index if found, grammar->ruleCount if not
+ */
+size_t vsccGrammarFindRule( const VsccGrammar *grammar, const char *name );
+
+/**
+ * @brief rule recovery flag setting function
+ * 
+ * @param[in,out] grammar grammar to set flag in (non-null)
+ * @param[in]     name    rule name (non-null, null-terminated)
+ * @param[in]     recover true if matcher should resynchronize at the rule
+ * 
+ * @return true if rule exists, false if not
+ */
+bool vsccGrammarSetRecover( VsccGrammar *grammar, const char *name, bool recover );
+
+/**
+ * @brief rule semantic action setting function
+ * 
+ * @param[in,out] grammar grammar to set action in (non-null)
+ * @param[in]     name    rule name (non-null, null-terminated)
+ * @param[in]     action  action to invoke on rule success (nullable, NULL to pass children values through)
+ * @param[in]     context action context
+ * 
+ * @return true if rule exists, false if not
+ */
+bool vsccGrammarSetAction( VsccGrammar *grammar, const char *name, VsccRuleAction action, void *context );
+
+/**
+ * @brief rule tokenization mode setting function
+ * 
+ * @param[in,out] grammar grammar to set mode in (non-null)
+ * @param[in]     name    rule name (non-null, null-terminated)
+ * @param[in]     mode    tokenization mode
+ * 
+ * @note token rules must be regular (references are inlined, so they must not be recursive) and
+ *       are matched by lexer as regular expressions with longest match semantics, not as PEG
+ * 
+ * @return true if rule exists, false if not
+ */
+bool vsccGrammarSetToken( VsccGrammar *grammar, const char *name, VsccTokenMode mode );
+
+/**
+ * @brief grammar artifact cache setting function
+ * 
+ * @param[in,out] grammar grammar (non-null)
+ * @param[in]     cache   cache to use (nullable, not owned, must outlive grammar)
+ * 
+ * @note linking and token NFA construction load automata from cache by structural hashes of
+ *       rules, so only automata of changed rules are rebuilt
+ */
+void vsccGrammarSetCache( VsccGrammar *grammar, VsccCache cache );
+
+/**
+ * @brief grammar pair hash computing function
+ * 
+ * @param[in] pair pair to compute hash of (non-null)
+ * 
+ * @return hash of pair name, rule structure and tokenization/recovery settings (action isn't hashed)
+ */
+uint64_t vsccGrammarPairHash( const VsccGrammarPair *pair );
+
+/**
+ * @brief grammar rule dependency closure hash computing function
+ * 
+ * @param[in]  grammar grammar (non-null, linked)
+ * @param[in]  index   rule index (< grammar->ruleCount)
+ * @param[out] hash    hash destination (non-null)
+ * 
+ * @note hash covers rule and all rules reachable from it through references, so it
+ *       changes if and only if rule or some of its dependencies changes
+ * 
+ * @return true if computed, false if allocation failed
+ */
+bool vsccGrammarClosureHash( const VsccGrammar *grammar, size_t index, uint64_t *hash );
+
+/**
+ * @brief grammar linking function
+ * 
+ * @param[in,out] grammar grammar to link (non-null)
+ * 
+ * @note function resolves rule references, assigns ids to distinct terminals,
+ *       builds automata for large terminal alternations and selects rules to memoize (ones that
+ *       different alternatives may invoke after structurally equal prefixes, so at same offset)
+ * 
+ * @return true if linked, false if some reference is unresolved or allocation failed
+ */
+bool vsccGrammarLink( VsccGrammar *grammar );
+
+/// @brief grammar parsing result
+typedef struct __VsccGrammarParseResult {
+    VsccRuleParseStatus status; ///< operation status
+
+    union {
+        VsccGrammar * ok;    ///< parsed grammar (not linked)
+        const char  * error; ///< position parsing failed at (if status isn't VSCC_RULE_PARSE_OK)
+    };
+} VsccGrammarParseResult;
+
+/**
+ * @brief .vsg grammar parsing function
+ * 
+ * @param[in] strBegin  start of grammar text (non-null)
+ * @param[in] strEnd    end of grammar text (>= strBegin)
+ * @param[in] allocator allocator of grammar and parser memory (nullable, must outlive grammar)
+ * 
+ * @note grammar text is a sequence of 'name ::= variants' definitions ending at newlines (groups may
+ *       span several lines), '#' starts comment. Syntax is the same as one of vscc_static.h.
+ * 
+ * @return parsing result (grammar rules are in definition order)
+ */
+VsccGrammarParseResult vsccGrammarParse( const char *strBegin, const char *strEnd, const VsccAllocator *allocator );
+
+/// @brief immutable reference-counted grammar snapshot
+typedef struct __VsccGrammarSnapshotImpl * VsccGrammarSnapshot;
+
+/**
+ * @brief grammar freezing function
+ * 
+ * @param[in] grammar grammar to freeze (non-null)
+ * 
+ * @note function gathers ownership of 'grammar' (even if it fails) and links it if it's not linked yet.
+ *       grammar must not be modified after freezing, so it's safe to share between threads without locks.
+ * 
+ * @return snapshot with single reference (may be NULL)
+ */
+VsccGrammarSnapshot vsccGrammarFreeze( VsccGrammar *grammar );
+
+/**
+ * @brief snapshot reference acquiring function
+ * 
+ * @param[in] snapshot snapshot to acquire reference to (non-null)
+ * 
+ * @return 'snapshot'
+ */
+VsccGrammarSnapshot vsccGrammarSnapshotAcquire( VsccGrammarSnapshot snapshot );
+
+/**
+ * @brief snapshot reference releasing function
+ * 
+ * @param[in] snapshot snapshot to release reference to (nullable)
+ * 
+ * @note snapshot grammar is destroyed after the last reference release
+ */
+void vsccGrammarSnapshotRelease( VsccGrammarSnapshot snapshot );
+
+/**
+ * @brief snapshot grammar getting function
+ * 
+ * @param[in] snapshot snapshot (non-null)
+ * 
+ * @return linked grammar (valid while reference to snapshot is held)
+ */
+const VsccGrammar * vsccGrammarSnapshotGrammar( const VsccGrammarSnapshot snapshot );
+
+/// @brief atomically replaceable grammar snapshot slot
+typedef struct __VsccGrammarSlotImpl * VsccGrammarSlot;
+
+/**
+ * @brief grammar slot constructor
+ * 
+ * @param[in] snapshot  initial slot snapshot (nullable)
+ * @param[in] allocator allocator of slot memory (nullable, must outlive slot)
+ * 
+ * @note function gathers snapshot reference (even if it fails)
+ * 
+ * @return created slot (may be NULL)
+ */
+VsccGrammarSlot vsccGrammarSlotCtor( VsccGrammarSnapshot snapshot, const VsccAllocator *allocator );
+
+/**
+ * @brief grammar slot destructor
+ * 
+ * @param[in] slot slot to destroy (nullable, no concurrent acquires or publishes allowed)
+ */
+void vsccGrammarSlotDtor( VsccGrammarSlot slot );
+
+/**
+ * @brief current slot snapshot acquiring function
+ * 
+ * @param[in] slot slot to acquire snapshot from (non-null)
+ * 
+ * @note function is lock- and wait-free, it's safe to call it concurrently with vsccGrammarSlotPublish
+ * 
+ * @return acquired snapshot reference (NULL if slot is empty), must be released by vsccGrammarSnapshotRelease
+ */
+VsccGrammarSnapshot vsccGrammarSlotAcquire( VsccGrammarSlot slot );
+
+/**
+ * @brief new slot snapshot publishing function
+ * 
+ * @param[in] slot     slot to publish snapshot to (non-null)
+ * @param[in] snapshot snapshot to publish (nullable)
+ * 
+ * @note function gathers snapshot reference. Previous snapshot reference is released after
+ *       all readers that may have seen it without acquiring finish, so publishing waits
+ *       for readers, but never blocks them.
+ */
+void vsccGrammarSlotPublish( VsccGrammarSlot slot, VsccGrammarSnapshot snapshot );
+
+/**
+ * @brief grammar token rules NFA constructor
+ * 
+ * @param[in] grammar   grammar to build NFA of token rules of (non-null, linked, must outlive NFA)
+ * @param[in] allocator allocator of NFA memory (nullable, must outlive NFA)
+ * 
+ * @note NFA alternatives are token rules in grammar order. DFA built from this NFA matches
+ *       longest prefix, ties are resolved in favor of earlier alternative.
+ * 
+ * @return created NFA (NULL if grammar has no tokens, some token rule isn't regular or allocation failed)
+ */
+VsccNfa vsccNfaTokenCtor( const VsccGrammar *grammar, const VsccAllocator *allocator );
+
+/// @brief token (fields are 32-bit to keep token stream compact)
+typedef struct __VsccToken {
+    uint32_t kind;   ///< index of token rule in grammar
+    uint32_t offset; ///< token text offset
+    uint32_t length; ///< token text length
+} VsccToken;
+
+/// @brief lexing status
+typedef enum __VsccLexStatus {
+    VSCC_LEX_OK,             ///< text is tokenized
+    VSCC_LEX_FAILED,         ///< no token matches at some offset
+    VSCC_LEX_TEXT_TOO_LONG,  ///< text doesn't fit 32-bit token offsets
+    VSCC_LEX_INTERNAL_ERROR, ///< internal error occured
+} VsccLexStatus;
+
+/// @brief DFA-based lexer of grammar token rules
+typedef struct __VsccLexerImpl * VsccLexer;
+
+/**
+ * @brief lexer constructor
+ * 
+ * @param[in] grammar   grammar to tokenize text by (non-null, linked, must outlive lexer)
+ * @param[in] allocator allocator of lexer memory (nullable, must outlive lexer)
+ * 
+ * @return created lexer (NULL if grammar has no tokens, some token rule isn't regular or allocation failed)
+ */
+VsccLexer vsccLexerCtor( const VsccGrammar *grammar, const VsccAllocator *allocator );
+
+/**
+ * @brief lexer destructor
+ * 
+ * @param[in] lexer lexer to destroy (nullable)
+ */
+void vsccLexerDtor( VsccLexer lexer );
+
+/**
+ * @brief text tokenizing function
+ * 
+ * @param[in,out] lexer       lexer (non-null)
+ * @param[in]     strBegin    begin of string slice to tokenize (non-null)
+ * @param[in]     strEnd      end of string slice to tokenize (non-null, >= strBegin)
+ * @param[in,out] tokens      token array (non-null, VsccToken elements), truncated and filled with tokens
+ * @param[out]    errorOffset offset no token matches at destination (nullable, set if lexing failed)
+ * 
+ * @note text is tokenized in single linear pass, every token is the longest one matching at its offset.
+ *       Token array doesn't depend on lexer, so it may be reused for any count of matcher runs.
+ * 
+ * @return lexing status
+ */
+VsccLexStatus vsccLexerRun( VsccLexer lexer, const char *strBegin, const char *strEnd, VsccArray *tokens, size_t *errorOffset );
+
+/// @brief matching status
+typedef enum __VsccMatchStatus {
+    VSCC_MATCH_OK,             ///< input prefix matched without errors
+    VSCC_MATCH_RECOVERED,      ///< input prefix matched after recovering from some errors
+    VSCC_MATCH_FAILED,         ///< input doesn't match
+    VSCC_MATCH_INTERNAL_ERROR, ///< internal error occured
+    VSCC_MATCH_TOO_DEEP,       ///< input nests deeper than matching stack budget allows
+} VsccMatchStatus;
+
+/// @brief matching error
+typedef struct __VsccMatchError {
+    size_t         offset;        ///< farthest failure offset
+    const size_t * expected;      ///< ids of terminals expected at offset (id - terminalCount is token rule index if id >= terminalCount)
+    size_t         expectedCount; ///< count of expected terminals
+} VsccMatchError;
+
+/// @brief grammar matcher representation structure
+typedef struct __VsccMatcherImpl * VsccMatcher;
+
+/**
+ * @brief matcher constructor
+ * 
+ * @param[in] grammar   grammar to match input by (non-null, linked, must outlive matcher)
+ * @param[in] allocator allocator of matcher memory (nullable, must outlive matcher)
+ * 
+ * @note all memory matcher runs need (stacks, errors, memo table, lazy DFA states) is taken from
+ *       allocator, so limiting allocator bounds memory of single parse. Run that hits the limit
+ *       returns VSCC_MATCH_INTERNAL_ERROR.
+ * 
+ * @return created matcher (may be NULL)
+ */
+VsccMatcher vsccMatcherCtor( const VsccGrammar *grammar, const VsccAllocator *allocator );
+
+/**
+ * @brief matcher destructor
+ * 
+ * @param[in] matcher matcher to destroy (nullable)
+ */
+void vsccMatcherDtor( VsccMatcher matcher );
+
+/**
+ * @brief count of errors matcher reports before giving up on recovery setting function
+ * 
+ * @param[in,out] matcher matcher to set limit of (non-null)
+ * @param[in]     limit   maximal error count (>= 1)
+ */
+void vsccMatcherSetErrorLimit( VsccMatcher matcher, size_t limit );
+
+/**
+ * @brief whole input matching requirement setting function
+ *
+ * @param[in,out] matcher    matcher to set requirement of (non-null)
+ * @param[in]     requireEnd true if runs should fail unless whole input is matched (false by default)
+ *
+ * @note failed run reports farthest failure then, as if started rule was followed by end rule
+ */
+void vsccMatcherSetRequireEnd( VsccMatcher matcher, bool requireEnd );
+
+/**
+ * @brief stack size matching may use setting function
+ *
+ * @param[in,out] matcher matcher to set stack size of (non-null)
+ * @param[in]     size    stack size in bytes (4 MiB by default)
+ *
+ * @note run returns VSCC_MATCH_TOO_DEEP instead of overflowing stack once rule nesting exceeds budget,
+ *       so size should be lowered for matchers run on threads with small stacks
+ */
+void vsccMatcherSetStackSize( VsccMatcher matcher, size_t size );
+
+/// @brief rule memoization statistics
+typedef struct __VsccMemoStats {
+    size_t lookups; ///< count of memo lookups (rule matches while it is memoized)
+    size_t hits;    ///< count of lookups that reused memoized result
+} VsccMemoStats;
+
+/**
+ * @brief rule memoization setting function
+ * 
+ * @param[in,out] matcher   matcher (non-null)
+ * @param[in]     ruleIndex index of rule to set memoization of
+ * @param[in]     memoize   true if rule results should be memoized
+ * 
+ * @note matcher memoizes rules selected by vsccGrammarLink by default. Rules with recovery are never
+ *       memoized. Memoized rule action is invoked once per offset, later matches reuse its result value.
+ * 
+ * @return true if set, false if allocation failed (memoization is disabled for all rules then)
+ */
+bool vsccMatcherSetMemo( VsccMatcher matcher, size_t ruleIndex, bool memoize );
+
+/**
+ * @brief rule memoization statistics getting function
+ * 
+ * @param[in] matcher   matcher (non-null)
+ * @param[in] ruleIndex rule index
+ * 
+ * @return statistics accumulated over all runs since matcher construction or last profile application
+ */
+VsccMemoStats vsccMatcherMemoStats( const VsccMatcher matcher, size_t ruleIndex );
+
+/**
+ * @brief memoization profile applying function
+ * 
+ * @param[in,out] matcher matcher (non-null)
+ * 
+ * @note memoization is kept only for rules with memo hits recorded by previous runs, statistics are reset
+ * 
+ * @return true if applied, false if allocation failed (memoization is disabled for all rules then)
+ */
+bool vsccMatcherApplyMemoProfile( VsccMatcher matcher );
+
+/**
+ * @brief memo table size getting function
+ * 
+ * @param[in] matcher matcher (non-null)
+ * 
+ * @return peak memo memory over all runs in bytes (table rows and memoized values pool)
+ */
+size_t vsccMatcherMemoSize( const VsccMatcher matcher );
+
+/**
+ * @brief input prefix matching function
+ * 
+ * @param[in,out] matcher   matcher (non-null)
+ * @param[in]     ruleIndex index of rule to match in matcher grammar (< ruleCount)
+ * @param[in]     strBegin  begin of string slice to match (non-null)
+ * @param[in]     strEnd    end of string slice to match (non-null, >= strBegin, must outlive matcher results)
+ * 
+ * @note successful matching costs nothing for error tracking except for farthest position comparisons
+ * 
+ * @return matching status
+ */
+VsccMatchStatus vsccMatcherRun( VsccMatcher matcher, size_t ruleIndex, const char *strBegin, const char *strEnd );
+
+/**
+ * @brief token stream prefix matching function
+ * 
+ * @param[in,out] matcher    matcher (non-null)
+ * @param[in]     ruleIndex  index of syntactic rule to match in matcher grammar (< ruleCount)
+ * @param[in]     strBegin   begin of tokenized text (non-null)
+ * @param[in]     strEnd     end of tokenized text (non-null, >= strBegin, must outlive matcher results)
+ * @param[in]     tokens     tokens produced by vsccLexerRun from the text (nullable if tokenCount == 0, must outlive matcher results)
+ * @param[in]     tokenCount count of tokens
+ * 
+ * @note references to token rules match single token of that kind, string terminals match single token
+ *       with same text and character terminals match single token of one matching character.
+ *       Matched length is measured in tokens, error offsets and action slices are still text-based.
+ * 
+ * @return matching status
+ */
+VsccMatchStatus vsccMatcherRunTokens( VsccMatcher matcher, size_t ruleIndex, const char *strBegin, const char *strEnd, const VsccToken *tokens, size_t tokenCount );
+
+/**
+ * @brief last run matched prefix length getting function
+ * 
+ * @param[in] matcher matcher (non-null)
+ * 
+ * @return length of prefix matched (meaningful only if last run succeeded, count of tokens for token runs)
+ */
+size_t vsccMatcherLength( const VsccMatcher matcher );
+
+/**
+ * @brief last run value count getting function
+ * 
+ * @param[in] matcher matcher (non-null)
+ * 
+ * @return count of values produced by matched rule (meaningful only if last run succeeded)
+ * 
+ * @note rules without action pass children values through, rules recovered from error produce NULL value if they have action.
+ */
+size_t vsccMatcherValueCount( const VsccMatcher matcher );
+
+/**
+ * @brief last run value getting function
+ * 
+ * @param[in] matcher matcher (non-null)
+ * @param[in] index   value index (< vsccMatcherValueCount(matcher))
+ * 
+ * @return value
+ */
+void * vsccMatcherValue( const VsccMatcher matcher, size_t index );
+
+/**
+ * @brief last run error count getting function
+ * 
+ * @param[in] matcher matcher (non-null)
+ * 
+ * @return count of errors reported by last run
+ */
+size_t vsccMatcherErrorCount( const VsccMatcher matcher );
+
+/**
+ * @brief last run error getting function
+ * 
+ * @param[in] matcher matcher (non-null)
+ * @param[in] index   error index (< vsccMatcherErrorCount(matcher))
+ * 
+ * @return error (valid until next run)
+ */
+VsccMatchError vsccMatcherError( const VsccMatcher matcher, size_t index );
+
+/**
+ * @brief last run input offset to line/column converting function
+ * 
+ * @param[in,out] matcher matcher (non-null)
+ * @param[in]     offset  offset in last run input
+ * @param[out]    line    line number destination (non-null, 1-based)
+ * @param[out]    column  column number destination (non-null, 1-based)
+ * 
+ * @note line index is built on first call after run, so successful runs never pay for it
+ * 
+ * @return true if succeeded, false if line index allocation failed
+ */
+bool vsccMatcherLocation( VsccMatcher matcher, size_t offset, size_t *line, size_t *column );
+
+/**
+ * @brief last run errors display function
+ * 
+ * @param[in]     out     text file to write errors to (non-null)
+ * @param[in,out] matcher matcher (non-null)
+ */
+void vsccMatcherPrintErrors( FILE *out, VsccMatcher matcher );
+
+/// @brief native code compiled grammar handle
+typedef struct __VsccJitImpl * VsccJit;
+
+/**
+ * @brief grammar to native code compiling function
+ *
+ * @param[in] grammar   grammar to compile (non-null, linked, must outlive JIT)
+ * @param[in] allocator allocator of JIT bookkeeping memory (nullable, must outlive JIT, code pages are mapped directly)
+ *
+ * @note JIT is recognizer-only: it doesn't run actions, recover or report errors,
+ * so failed inputs should be rerun with VsccMatcher to get diagnostics
+ *
+ * @return compiled grammar (NULL if failed, grammar has no rules or platform isn't x86-64, use VsccMatcher then)
+ */
+VsccJit vsccJitCtor( const VsccGrammar *grammar, const VsccAllocator *allocator );
+
+/**
+ * @brief compiled grammar destructor
+ *
+ * @param[in] jit compiled grammar (nullable)
+ */
+void vsccJitDtor( VsccJit jit );
+
+/**
+ * @brief compiled grammar matching function
+ *
+ * @param[in]  jit       compiled grammar (non-null)
+ * @param[in]  ruleIndex index of rule to start from
+ * @param[in]  strBegin  text begin (non-null)
+ * @param[in]  strEnd    text end
+ * @param[out] length    matched prefix length (non-null)
+ *
+ * @note matching is aborted if input nests too deep for compiled code stack budget
+ *
+ * @return VSCC_MATCH_OK if rule matched, VSCC_MATCH_FAILED if it didn't and VSCC_MATCH_TOO_DEEP if matching was aborted
+ */
+VsccMatchStatus vsccJitMatch( const VsccJit jit, size_t ruleIndex, const char *strBegin, const char *strEnd, size_t *length );
+
 #endif // !defined(VSCC_H_)
 
 // vscc.h
@@ -0,0 +1,158 @@
+/**
+ * @brief memory allocator implementation file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <assert.h>
+
+#include "vscc.h"
+
+/// @brief counting allocator block header
+typedef union __VsccCountingHeader {
+    size_t      size;     ///< block size (as requested)
+    max_align_t _aligner; ///< header alignment forcer (so block data is aligned as malloc result)
+} VsccCountingHeader;
+
+void * vsccAllocate( const VsccAllocator *allocator, size_t size ) {
+    return allocator == NULL
+        ? malloc(size)
+        : allocator->allocate(allocator->context, size)
+    ;
+} // vsccAllocate
+
+void * vsccAllocateZeroed( const VsccAllocator *allocator, size_t count, size_t size ) {
+    if (allocator == NULL)
+        return calloc(count, size);
+
+    if (size != 0 && count > SIZE_MAX / size)
+        return NULL;
+
+    void *block = allocator->allocate(allocator->context, count * size);
+
+    if (block != NULL)
+        memset(block, 0, count * size);
+    return block;
+} // vsccAllocateZeroed
+
+void * vsccReallocate( const VsccAllocator *allocator, void *block, size_t size ) {
+    return allocator == NULL
+        ? realloc(block, size)
+        : allocator->reallocate(allocator->context, block, size)
+    ;
+} // vsccReallocate
+
+void vsccDeallocate( const VsccAllocator *allocator, void *block ) {
+    if (allocator == NULL)
+        free(block);
+    else
+        allocator->deallocate(allocator->context, block);
+} // vsccDeallocate
+
+/**
+ * @brief counting allocator allocation function
+ *
+ * @param[in,out] context counting allocator (VsccCountingAllocator *)
+ * @param[in]     size    block size
+ *
+ * @return allocated block (NULL if failed or limit is exceeded)
+ */
+static void * vsccCountingAllocate( void *context, size_t size ) {
+    VsccCountingAllocator *counting = (VsccCountingAllocator *)context;
+
+    if (size > counting->limit - counting->size || size > SIZE_MAX - sizeof(VsccCountingHeader)) {
+        counting->failureCount++;
+        return NULL;
+    }
+
+    VsccCountingHeader *header = (VsccCountingHeader *)vsccAllocate(counting->parent, sizeof(VsccCountingHeader) + size);
+
+    if (header == NULL) {
+        counting->failureCount++;
+        return NULL;
+    }
+    header->size = size;
+
+    counting->size += size;
+    if (counting->size > counting->peakSize)
+        counting->peakSize = counting->size;
+    counting->allocationCount++;
+
+    return header + 1;
+} // vsccCountingAllocate
+
+/**
+ * @brief counting allocator reallocation function
+ *
+ * @param[in,out] context counting allocator (VsccCountingAllocator *)
+ * @param[in]     block   block to resize (nullable)
+ * @param[in]     size    new block size
+ *
+ * @return resized block (NULL if failed or limit is exceeded)
+ */
+static void * vsccCountingReallocate( void *context, void *block, size_t size ) {
+    VsccCountingAllocator *counting = (VsccCountingAllocator *)context;
+
+    if (block == NULL)
+        return vsccCountingAllocate(context, size);
+
+    VsccCountingHeader *header = (VsccCountingHeader *)block - 1;
+    const size_t oldSize = header->size;
+
+    if (size > oldSize && (size - oldSize > counting->limit - counting->size || size > SIZE_MAX - sizeof(VsccCountingHeader))) {
+        counting->failureCount++;
+        return NULL;
+    }
+
+    VsccCountingHeader *newHeader = (VsccCountingHeader *)vsccReallocate(counting->parent, header, sizeof(VsccCountingHeader) + size);
+
+    if (newHeader == NULL) {
+        counting->failureCount++;
+        return NULL;
+    }
+    newHeader->size = size;
+
+    counting->size = counting->size - oldSize + size;
+    if (counting->size > counting->peakSize)
+        counting->peakSize = counting->size;
+    counting->allocationCount++;
+
+    return newHeader + 1;
+} // vsccCountingReallocate
+
+/**
+ * @brief counting allocator freeing function
+ *
+ * @param[in,out] context counting allocator (VsccCountingAllocator *)
+ * @param[in]     block   block to free (nullable)
+ */
+static void vsccCountingDeallocate( void *context, void *block ) {
+    VsccCountingAllocator *counting = (VsccCountingAllocator *)context;
+
+    if (block == NULL)
+        return;
+
+    VsccCountingHeader *header = (VsccCountingHeader *)block - 1;
+
+    assert(header->size <= counting->size);
+    counting->size -= header->size;
+    vsccDeallocate(counting->parent, header);
+} // vsccCountingDeallocate
+
+void vsccCountingAllocatorInit( VsccCountingAllocator *counting, const VsccAllocator *parent, size_t limit ) {
+    assert(counting != NULL);
+
+    counting->allocator.allocate = vsccCountingAllocate;
+    counting->allocator.reallocate = vsccCountingReallocate;
+    counting->allocator.deallocate = vsccCountingDeallocate;
+    counting->allocator.context = counting;
+    counting->parent = parent;
+    counting->limit = limit;
+    counting->size = 0;
+    counting->peakSize = 0;
+    counting->allocationCount = 0;
+    counting->failureCount = 0;
+} // vsccCountingAllocatorInit
+
+// vscc_allocator.c
@@ -14,9 +14,10 @@
 typedef struct __VsccArrayImpl {
     union {
         struct {
-            size_t elementSize; ///< size of single array element
-            size_t size;        ///< current array size
-            size_t capacity;    ///< current array capacity
+            size_t                elementSize; ///< size of single array element
+            size_t                size;        ///< current array size
+            size_t                capacity;    ///< current array capacity
+            const VsccAllocator * allocator;   ///< allocator of array memory (nullable)
         };
         max_align_t _aligner; ///< array alignment forcer
     };
@@ -38,7 +39,7 @@ bool vsccArrayRealloc( VsccArray *array, size_t newCapacity ) {
 
     size_t oldCapacity = impl->capacity;
 
-    VsccArray newImpl = (VsccArray)realloc(impl, sizeof(VsccArray) + newCapacity * impl->elementSize);
+    VsccArray newImpl = (VsccArray)vsccReallocate(impl->allocator, impl, offsetof(VsccArrayImpl, data) + newCapacity * impl->elementSize);
     if (newImpl == NULL)
         return false;
 
@@ -57,21 +58,23 @@ bool vsccArrayRealloc( VsccArray *array, size_t newCapacity ) {
     return true;
 } // vsccArrayRealloc
 
-VsccArray vsccArrayCtor( size_t elementSize ) {
+VsccArray vsccArrayCtor( size_t elementSize, const VsccAllocator *allocator ) {
     assert(elementSize > 0);
 
-    VsccArray array = (VsccArray)calloc(1, sizeof(VsccArrayImpl));
+    VsccArray array = (VsccArray)vsccAllocateZeroed(allocator, 1, sizeof(VsccArrayImpl));
 
     if (array == NULL)
         return NULL;
 
     array->elementSize = elementSize;
+    array->allocator = allocator;
 
     return array;
 } // vsccArrayCtor
 
 void vsccArrayDtor( VsccArray array ) {
-    free(array);
+    if (array != NULL)
+        vsccDeallocate(array->allocator, array);
 } // vsccArrayDtor
 
 size_t vsccArraySize( const VsccArray array ) {
@@ -84,6 +87,18 @@ void * vsccArrayData( VsccArray array ) {
     return array->data;
 } // vsccArrayData
 
+void * vsccGetArrayElement( VsccArray array, size_t index ) {
+    assert(array != NULL);
+    assert(index < array->size);
+    return array->data + array->elementSize * index;
+} // vsccGetArrayElement
+
+void vsccArrayTruncate( VsccArray array, size_t size ) {
+    assert(array != NULL);
+    assert(size <= array->size);
+    array->size = size;
+} // vsccArrayTruncate
+
 bool vsccArrayPush( VsccArray *array, const void *data ) {
     assert(array != NULL);
     assert(data != NULL);
@@ -0,0 +1,1464 @@
+/**
+ * @brief terminal automaton (NFA and lazy DFA) implementation file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "vscc.h"
+
+/// @brief minimal count of alternatives in variant to build automaton for
+#define VSCC_NFA_MIN_ALTERNATIVE_COUNT 4
+
+/// @brief no alternative accepted
+#define VSCC_NFA_NO_ALTERNATIVE UINT32_MAX
+
+/// @brief lazy DFA state cache memory budget (in bytes)
+#define VSCC_LAZY_DFA_CACHE_SIZE (256 * 1024)
+
+/// @brief maximal count of lazy DFA states kept in cache (state indices are int16_t)
+#define VSCC_LAZY_DFA_STATE_LIMIT 16384
+
+/// @brief count of consecutive short-lived caches after which lazy DFA switches to NFA simulation
+#define VSCC_LAZY_DFA_THRASH_LIMIT 4
+
+/// @brief unknown lazy DFA transition
+#define VSCC_LAZY_DFA_UNKNOWN ((int16_t)-1)
+
+/// @brief dead lazy DFA transition
+#define VSCC_LAZY_DFA_DEAD ((int16_t)-2)
+
+/// @brief NFA byte range transition
+typedef struct __VsccNfaTransition {
+    uint32_t source; ///< source state
+    uint32_t target; ///< target state
+    uint8_t  first;  ///< first byte of range
+    uint8_t  last;   ///< last byte of range
+} VsccNfaTransition;
+
+/// @brief NFA state
+typedef struct __VsccNfaState {
+    uint32_t transitionBegin; ///< index of first state transition
+    uint32_t transitionCount; ///< count of state transitions
+    uint32_t alternative;     ///< index of alternative state belongs to
+    bool     accepting;       ///< true if alternative is matched in this state
+} VsccNfaState;
+
+/// @brief NFA internal representation
+typedef struct __VsccNfaImpl {
+    VsccNfaState      * states;           ///< states
+    size_t              stateCount;       ///< count of states
+    VsccNfaTransition * transitions;      ///< transitions sorted by source state
+    size_t              transitionCount;  ///< count of transitions
+    uint32_t          * starts;           ///< start states
+    size_t              startCount;       ///< count of start states
+    const VsccRule   ** alternatives;     ///< alternative terminals
+    size_t              alternativeCount; ///< count of alternatives
+    uint8_t             byteClasses[256]; ///< byte equivalence classes (bytes of same class are never distinguished by transitions)
+    size_t              byteClassCount;   ///< count of byte classes
+    bool                longest;          ///< true if longest match wins (token NFA), false if first matching alternative wins
+    const VsccAllocator * allocator;      ///< allocator of NFA memory (nullable)
+} VsccNfaImpl;
+
+/// @brief NFA builder
+typedef struct __VsccNfaBuilder {
+    VsccArray states;       ///< states (VsccNfaState)
+    VsccArray transitions;  ///< transitions (VsccNfaTransition)
+    VsccArray starts;       ///< start states (uint32_t)
+    VsccArray alternatives; ///< alternative terminals (const VsccRule *)
+    VsccArray epsilons;     ///< epsilon transitions (VsccNfaTransition, byte range is ignored)
+
+    const VsccAllocator * allocator; ///< allocator of builder and built NFA memory (nullable)
+} VsccNfaBuilder;
+
+/**
+ * @brief terminal alternatives collecting function
+ *
+ * @param[in]     rule         rule to collect terminals of (non-null)
+ * @param[in,out] alternatives terminal array (non-null)
+ *
+ * @return true if rule is terminal alternation and all terminals are collected, false otherwise
+ */
+static bool vsccNfaCollectAlternatives( const VsccRule *rule, VsccArray *alternatives ) {
+    switch (rule->type) {
+    case VSCC_RULE_VARIANT:
+        for (size_t i = 0; i < rule->variant.count; i++)
+            if (!vsccNfaCollectAlternatives(rule->variant.rules[i], alternatives))
+                return false;
+        return true;
+
+    case VSCC_RULE_STRING_TERMINAL:
+    case VSCC_RULE_CHAR_TERMINAL:
+        return vsccArrayPush(alternatives, &rule);
+
+    default:
+        return false;
+    }
+} // vsccNfaCollectAlternatives
+
+/**
+ * @brief NFA state adding function
+ *
+ * @param[in,out] builder     builder (non-null)
+ * @param[in]     alternative alternative state belongs to
+ * @param[in]     accepting   true if state accepts alternative
+ * @param[out]    state       created state index destination (non-null)
+ *
+ * @return true if added, false if allocation failed
+ */
+static bool vsccNfaAddState( VsccNfaBuilder *builder, uint32_t alternative, bool accepting, uint32_t *state ) {
+    const VsccNfaState newState = {
+        .transitionBegin = 0,
+        .transitionCount = 0,
+        .alternative     = alternative,
+        .accepting       = accepting,
+    };
+
+    *state = (uint32_t)vsccArraySize(builder->states);
+    return vsccArrayPush(&builder->states, &newState);
+} // vsccNfaAddState
+
+/**
+ * @brief NFA transition adding function
+ *
+ * @param[in,out] builder builder (non-null)
+ * @param[in]     source  source state
+ * @param[in]     target  target state
+ * @param[in]     first   first byte of range
+ * @param[in]     last    last byte of range
+ *
+ * @return true if added, false if allocation failed
+ */
+static bool vsccNfaAddTransition( VsccNfaBuilder *builder, uint32_t source, uint32_t target, uint8_t first, uint8_t last ) {
+    const VsccNfaTransition transition = {
+        .source = source,
+        .target = target,
+        .first  = first,
+        .last   = last,
+    };
+
+    return vsccArrayPush(&builder->transitions, &transition);
+} // vsccNfaAddTransition
+
+/**
+ * @brief NFA epsilon transition adding function
+ *
+ * @param[in,out] builder builder (non-null)
+ * @param[in]     source  source state
+ * @param[in]     target  target state
+ *
+ * @return true if added, false if allocation failed
+ */
+static bool vsccNfaAddEpsilon( VsccNfaBuilder *builder, uint32_t source, uint32_t target ) {
+    const VsccNfaTransition epsilon = {
+        .source = source,
+        .target = target,
+        .first  = 0,
+        .last   = 0,
+    };
+
+    return vsccArrayPush(&builder->epsilons, &epsilon);
+} // vsccNfaAddEpsilon
+
+/**
+ * @brief code point UTF-8 encoding function
+ *
+ * @param[in]  codePoint code point to encode (<= VSCC_CODE_POINT_MAX)
+ * @param[out] bytes     encoded bytes destination (at least 4 bytes writable)
+ *
+ * @return count of bytes written
+ */
+static size_t vsccNfaEncodeUtf8( uint32_t codePoint, uint8_t *bytes ) {
+    if (codePoint < 0x80) {
+        bytes[0] = (uint8_t)codePoint;
+        return 1;
+    }
+    if (codePoint < 0x800) {
+        bytes[0] = (uint8_t)(0xC0 | codePoint >> 6);
+        bytes[1] = (uint8_t)(0x80 | (codePoint & 0x3F));
+        return 2;
+    }
+    if (codePoint < 0x10000) {
+        bytes[0] = (uint8_t)(0xE0 | codePoint >> 12);
+        bytes[1] = (uint8_t)(0x80 | (codePoint >> 6 & 0x3F));
+        bytes[2] = (uint8_t)(0x80 | (codePoint & 0x3F));
+        return 3;
+    }
+    bytes[0] = (uint8_t)(0xF0 | codePoint >> 18);
+    bytes[1] = (uint8_t)(0x80 | (codePoint >> 12 & 0x3F));
+    bytes[2] = (uint8_t)(0x80 | (codePoint >> 6 & 0x3F));
+    bytes[3] = (uint8_t)(0x80 | (codePoint & 0x3F));
+    return 4;
+} // vsccNfaEncodeUtf8
+
+/**
+ * @brief code point range to UTF-8 byte range sequences compiling function
+ *
+ * @param[in,out] builder builder (non-null)
+ * @param[in]     start   state sequences start from
+ * @param[in]     accept  state sequences end at
+ * @param[in]     first   first code point of range (encoded length must be same as of last)
+ * @param[in]     last    last code point of range
+ *
+ * @note range is split until every piece is representable as sequence of byte ranges
+ *
+ * @return true if compiled, false if allocation failed
+ */
+static bool vsccNfaAddUtf8Range( VsccNfaBuilder *builder, uint32_t start, uint32_t accept, uint32_t first, uint32_t last ) {
+    uint8_t firstBytes[4], lastBytes[4];
+    const size_t length = vsccNfaEncodeUtf8(first, firstBytes);
+
+    for (size_t i = 1; i < length; i++) {
+        const uint32_t mask = ((uint32_t)1 << 6 * i) - 1;
+
+        if ((first & ~mask) == (last & ~mask))
+            continue;
+        if ((first & mask) != 0)
+            return true
+                && vsccNfaAddUtf8Range(builder, start, accept, first, first | mask)
+                && vsccNfaAddUtf8Range(builder, start, accept, (first | mask) + 1, last)
+            ;
+        if ((last & mask) != mask)
+            return true
+                && vsccNfaAddUtf8Range(builder, start, accept, first, (last & ~mask) - 1)
+                && vsccNfaAddUtf8Range(builder, start, accept, last & ~mask, last)
+            ;
+    }
+
+    vsccNfaEncodeUtf8(last, lastBytes);
+
+    const uint32_t alternative = ((const VsccNfaState *)vsccArrayData(builder->states))[start].alternative;
+    uint32_t current = start;
+
+    for (size_t i = 0; i + 1 < length; i++) {
+        uint32_t next;
+
+        if (!vsccNfaAddState(builder, alternative, false, &next))
+            return false;
+        if (!vsccNfaAddTransition(builder, current, next, firstBytes[i], lastBytes[i]))
+            return false;
+        current = next;
+    }
+
+    return vsccNfaAddTransition(builder, current, accept, firstBytes[length - 1], lastBytes[length - 1]);
+} // vsccNfaAddUtf8Range
+
+/**
+ * @brief character terminal compiling function
+ *
+ * @param[in,out] builder builder (non-null)
+ * @param[in]     rule    character terminal (non-null)
+ * @param[in]     start   state terminal match starts at
+ * @param[in]     accept  state terminal match ends at
+ *
+ * @return true if compiled, false if allocation failed
+ */
+static bool vsccNfaAddCharTerminal( VsccNfaBuilder *builder, const VsccRule *rule, uint32_t start, uint32_t accept ) {
+    // split ranges by UTF-8 sequence length and skip surrogates
+    static const VsccRuleCharRange lengthRanges[] = {
+        {0x00,    0x7F},
+        {0x80,    0x7FF},
+        {0x800,   0xD7FF},
+        {0xE000,  0xFFFF},
+        {0x10000, VSCC_CODE_POINT_MAX},
+    };
+
+    for (size_t i = 0; i < rule->charTerminal.count; i++) {
+        const VsccRuleCharRange range = rule->charTerminal.ranges[i];
+
+        for (size_t j = 0; j < sizeof(lengthRanges) / sizeof(lengthRanges[0]); j++) {
+            const uint32_t first = range.first > lengthRanges[j].first ? range.first : lengthRanges[j].first;
+            const uint32_t last = range.last < lengthRanges[j].last ? range.last : lengthRanges[j].last;
+
+            if (first <= last && !vsccNfaAddUtf8Range(builder, start, accept, first, last))
+                return false;
+        }
+    }
+
+    return true;
+} // vsccNfaAddCharTerminal
+
+/**
+ * @brief alternative compiling function
+ *
+ * @param[in,out] builder     builder (non-null)
+ * @param[in]     rule        alternative terminal (non-null)
+ * @param[in]     alternative alternative index
+ *
+ * @return true if compiled, false if allocation failed
+ */
+static bool vsccNfaAddAlternative( VsccNfaBuilder *builder, const VsccRule *rule, uint32_t alternative ) {
+    uint32_t start;
+
+    if (rule->type == VSCC_RULE_STRING_TERMINAL) {
+        if (!vsccNfaAddState(builder, alternative, rule->stringTerminal.length == 0, &start))
+            return false;
+
+        uint32_t current = start;
+        for (size_t i = 0; i < rule->stringTerminal.length; i++) {
+            const uint8_t byte = (uint8_t)rule->stringTerminal.string[i];
+            uint32_t next;
+
+            if (!vsccNfaAddState(builder, alternative, i + 1 == rule->stringTerminal.length, &next))
+                return false;
+            if (!vsccNfaAddTransition(builder, current, next, byte, byte))
+                return false;
+            current = next;
+        }
+
+        return vsccArrayPush(&builder->starts, &start);
+    }
+
+    assert(rule->type == VSCC_RULE_CHAR_TERMINAL);
+
+    uint32_t accept;
+
+    if (!vsccNfaAddState(builder, alternative, false, &start))
+        return false;
+    if (!vsccNfaAddState(builder, alternative, true, &accept))
+        return false;
+    if (!vsccNfaAddCharTerminal(builder, rule, start, accept))
+        return false;
+
+    return vsccArrayPush(&builder->starts, &start);
+} // vsccNfaAddAlternative
+
+/**
+ * @brief regular rule compiling function (Thompson construction)
+ *
+ * @param[in,out] builder builder (non-null)
+ * @param[in]     grammar grammar references are resolved in (non-null, linked)
+ * @param[in]     rule    rule to compile (non-null)
+ * @param[in]     start   state rule match starts at (no other construction may enter it)
+ * @param[in]     accept  state rule match ends at (no other construction may leave it)
+ * @param[in]     depth   reference inlining depth
+ *
+ * @return true if compiled, false if rule isn't regular or allocation failed
+ */
+static bool vsccNfaAddRegular( VsccNfaBuilder *builder, const VsccGrammar *grammar, const VsccRule *rule, uint32_t start, uint32_t accept, size_t depth ) {
+    const uint32_t alternative = ((const VsccNfaState *)vsccArrayData(builder->states))[start].alternative;
+
+    switch (rule->type) {
+    case VSCC_RULE_SEQUENCE: {
+        uint32_t current = start;
+
+        for (size_t i = 0; i < rule->sequence.count; i++) {
+            uint32_t next = accept;
+
+            if (i + 1 < rule->sequence.count && !vsccNfaAddState(builder, alternative, false, &next))
+                return false;
+            if (!vsccNfaAddRegular(builder, grammar, rule->sequence.rules[i], current, next, depth))
+                return false;
+            current = next;
+        }
+        return true;
+    }
+
+    case VSCC_RULE_VARIANT:
+        for (size_t i = 0; i < rule->variant.count; i++)
+            if (!vsccNfaAddRegular(builder, grammar, rule->variant.rules[i], start, accept, depth))
+                return false;
+        return true;
+
+    case VSCC_RULE_OPTIONAL:
+        return true
+            && vsccNfaAddRegular(builder, grammar, rule->optional, start, accept, depth)
+            && vsccNfaAddEpsilon(builder, start, accept)
+        ;
+
+    case VSCC_RULE_REPEAT: {
+        uint32_t loop, body;
+
+        // loop state is fresh, so repetition never reenters start
+        return true
+            && vsccNfaAddState(builder, alternative, false, &loop)
+            && vsccNfaAddState(builder, alternative, false, &body)
+            && vsccNfaAddEpsilon(builder, start, loop)
+            && vsccNfaAddRegular(builder, grammar, rule->repeat.rule, loop, body, depth)
+            && vsccNfaAddEpsilon(builder, body, loop)
+            && vsccNfaAddEpsilon(builder, rule->repeat.atLeastOnce ? body : loop, accept)
+        ;
+    }
+
+    case VSCC_RULE_STRING_TERMINAL: {
+        const size_t length = rule->stringTerminal.length;
+        uint32_t current = start;
+
+        if (length == 0)
+            return vsccNfaAddEpsilon(builder, start, accept);
+
+        for (size_t i = 0; i < length; i++) {
+            const uint8_t byte = (uint8_t)rule->stringTerminal.string[i];
+            uint32_t next = accept;
+
+            if (i + 1 < length && !vsccNfaAddState(builder, alternative, false, &next))
+                return false;
+            if (!vsccNfaAddTransition(builder, current, next, byte, byte))
+                return false;
+            current = next;
+        }
+        return true;
+    }
+
+    case VSCC_RULE_CHAR_TERMINAL:
+        return vsccNfaAddCharTerminal(builder, rule, start, accept);
+
+    case VSCC_RULE_REFERENCE:
+        // inlining deeper than rule count means that references are recursive
+        if (depth >= grammar->ruleCount)
+            return false;
+        return vsccNfaAddRegular(builder, grammar, grammar->rules[rule->reference.index].rule, start, accept, depth + 1);
+
+    case VSCC_RULE_EMPTY:
+        return vsccNfaAddEpsilon(builder, start, accept);
+
+    case VSCC_RULE_END:
+        return false;
+    }
+
+    assert(false && "Unreachable case reached.");
+    return false;
+} // vsccNfaAddRegular
+
+/**
+ * @brief transition by source comparator (for qsort)
+ *
+ * @param[in] lhs first transition pointer
+ * @param[in] rhs second transition pointer
+ *
+ * @return comparison result
+ */
+static int vsccNfaTransitionCompare( const void *lhs, const void *rhs ) {
+    const uint32_t lhsSource = ((const VsccNfaTransition *)lhs)->source;
+    const uint32_t rhsSource = ((const VsccNfaTransition *)rhs)->source;
+
+    return (lhsSource > rhsSource) - (lhsSource < rhsSource);
+} // vsccNfaTransitionCompare
+
+/**
+ * @brief array contents to standalone block copying function
+ *
+ * @param[in] array       array to copy data of (non-null)
+ * @param[in] elementSize array element size
+ * @param[in] allocator   copy allocator (nullable)
+ *
+ * @return allocated copy (may be NULL)
+ */
+static void * vsccNfaCopyArray( VsccArray array, size_t elementSize, const VsccAllocator *allocator ) {
+    const size_t size = vsccArraySize(array) * elementSize;
+    void *result = vsccAllocate(allocator, size + 1);
+
+    if (result != NULL && size != 0)
+        memcpy(result, vsccArrayData(array), size);
+    return result;
+} // vsccNfaCopyArray
+
+/**
+ * @brief transition array to per-state index converting function
+ *
+ * @param[in,out] transitions transitions (non-null, sorted by source)
+ * @param[in]     stateCount  count of NFA states
+ * @param[in]     allocator   index allocator (nullable)
+ *
+ * @return allocated array of stateCount + 1 indices of first transition of every state (may be NULL)
+ */
+static uint32_t * vsccNfaIndexTransitions( VsccArray transitions, size_t stateCount, const VsccAllocator *allocator ) {
+    const VsccNfaTransition *data = (const VsccNfaTransition *)vsccArrayData(transitions);
+    const size_t count = vsccArraySize(transitions);
+    uint32_t *begins = (uint32_t *)vsccAllocateZeroed(allocator, stateCount + 1, sizeof(uint32_t));
+
+    if (begins == NULL)
+        return NULL;
+
+    for (size_t i = 0; i < count; i++)
+        begins[data[i].source + 1]++;
+    for (size_t i = 0; i < stateCount; i++)
+        begins[i + 1] += begins[i];
+    return begins;
+} // vsccNfaIndexTransitions
+
+/**
+ * @brief epsilon transitions eliminating function
+ *
+ * @param[in,out] builder builder (non-null)
+ *
+ * @note every state gets byte transitions and acceptance of its epsilon closure,
+ *       so automaton runtime never deals with epsilon transitions
+ *
+ * @return true if eliminated, false if allocation failed
+ */
+static bool vsccNfaEliminateEpsilons( VsccNfaBuilder *builder ) {
+    const size_t stateCount = vsccArraySize(builder->states);
+    VsccNfaState *states = (VsccNfaState *)vsccArrayData(builder->states);
+
+    qsort(vsccArrayData(builder->transitions), vsccArraySize(builder->transitions), sizeof(VsccNfaTransition), vsccNfaTransitionCompare);
+    qsort(vsccArrayData(builder->epsilons), vsccArraySize(builder->epsilons), sizeof(VsccNfaTransition), vsccNfaTransitionCompare);
+
+    uint32_t *transitionBegins = vsccNfaIndexTransitions(builder->transitions, stateCount, builder->allocator);
+    uint32_t *epsilonBegins = vsccNfaIndexTransitions(builder->epsilons, stateCount, builder->allocator);
+    uint32_t *marks = (uint32_t *)vsccAllocateZeroed(builder->allocator, stateCount + 1, sizeof(uint32_t));
+    uint32_t *stack = (uint32_t *)vsccAllocateZeroed(builder->allocator, stateCount + 1, sizeof(uint32_t));
+    VsccArray transitions = vsccArrayCtor(sizeof(VsccNfaTransition), builder->allocator);
+    bool eliminated = true
+        && transitionBegins != NULL
+        && epsilonBegins != NULL
+        && marks != NULL
+        && stack != NULL
+        && transitions != NULL
+    ;
+
+    const VsccNfaTransition *byteTransitions = (const VsccNfaTransition *)vsccArrayData(builder->transitions);
+    const VsccNfaTransition *epsilons = (const VsccNfaTransition *)vsccArrayData(builder->epsilons);
+
+    for (uint32_t state = 0; eliminated && state < stateCount; state++) {
+        size_t stackSize = 0;
+
+        // state index + 1 is used as mark, so marks never have to be cleared
+        stack[stackSize++] = state;
+        marks[state] = state + 1;
+
+        while (eliminated && stackSize != 0) {
+            const uint32_t closure = stack[--stackSize];
+
+            if (states[closure].accepting)
+                states[state].accepting = true;
+
+            for (uint32_t t = transitionBegins[closure]; eliminated && t < transitionBegins[closure + 1]; t++) {
+                VsccNfaTransition transition = byteTransitions[t];
+
+                transition.source = state;
+                eliminated = vsccArrayPush(&transitions, &transition);
+            }
+
+            for (uint32_t e = epsilonBegins[closure]; e < epsilonBegins[closure + 1]; e++) {
+                if (marks[epsilons[e].target] == state + 1)
+                    continue;
+                marks[epsilons[e].target] = state + 1;
+                stack[stackSize++] = epsilons[e].target;
+            }
+        }
+    }
+
+    if (eliminated) {
+        vsccArrayDtor(builder->transitions);
+        builder->transitions = transitions;
+        vsccArrayTruncate(builder->epsilons, 0);
+    } else {
+        vsccArrayDtor(transitions);
+    }
+
+    vsccDeallocate(builder->allocator, transitionBegins);
+    vsccDeallocate(builder->allocator, epsilonBegins);
+    vsccDeallocate(builder->allocator, marks);
+    vsccDeallocate(builder->allocator, stack);
+
+    return eliminated;
+} // vsccNfaEliminateEpsilons
+
+/**
+ * @brief NFA by builder contents creating function
+ *
+ * @param[in,out] builder builder (non-null, without epsilon transitions)
+ * @param[in]     longest true if longest match should win, false if first matching alternative should
+ *
+ * @return created NFA (NULL if allocation failed)
+ */
+static VsccNfa vsccNfaBuild( VsccNfaBuilder *builder, bool longest ) {
+    assert(vsccArraySize(builder->epsilons) == 0);
+
+    VsccNfa nfa = (VsccNfa)vsccAllocateZeroed(builder->allocator, 1, sizeof(VsccNfaImpl));
+
+    if (nfa == NULL)
+        return NULL;
+    nfa->allocator = builder->allocator;
+
+    qsort(vsccArrayData(builder->transitions), vsccArraySize(builder->transitions), sizeof(VsccNfaTransition), vsccNfaTransitionCompare);
+
+    nfa->stateCount = vsccArraySize(builder->states);
+    nfa->transitionCount = vsccArraySize(builder->transitions);
+    nfa->startCount = vsccArraySize(builder->starts);
+    nfa->alternativeCount = vsccArraySize(builder->alternatives);
+    nfa->longest = longest;
+    nfa->states = (VsccNfaState *)vsccNfaCopyArray(builder->states, sizeof(VsccNfaState), nfa->allocator);
+    nfa->transitions = (VsccNfaTransition *)vsccNfaCopyArray(builder->transitions, sizeof(VsccNfaTransition), nfa->allocator);
+    nfa->starts = (uint32_t *)vsccNfaCopyArray(builder->starts, sizeof(uint32_t), nfa->allocator);
+    nfa->alternatives = (const VsccRule **)vsccNfaCopyArray(builder->alternatives, sizeof(const VsccRule *), nfa->allocator);
+
+    if (nfa->states == NULL || nfa->transitions == NULL || nfa->starts == NULL || nfa->alternatives == NULL) {
+        vsccNfaDtor(nfa);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < nfa->transitionCount; i++) {
+        VsccNfaState *source = &nfa->states[nfa->transitions[i].source];
+
+        if (source->transitionCount++ == 0)
+            source->transitionBegin = (uint32_t)i;
+    }
+
+    // byte class changes at every transition range bound
+    bool bounds[257] = {};
+
+    for (size_t i = 0; i < nfa->transitionCount; i++) {
+        bounds[nfa->transitions[i].first] = true;
+        bounds[nfa->transitions[i].last + 1] = true;
+    }
+
+    size_t byteClass = 0;
+    for (size_t i = 0; i < 256; i++) {
+        if (bounds[i] && i != 0)
+            byteClass++;
+        nfa->byteClasses[i] = (uint8_t)byteClass;
+    }
+    nfa->byteClassCount = byteClass + 1;
+
+    return nfa;
+} // vsccNfaBuild
+
+/**
+ * @brief NFA builder constructor
+ *
+ * @param[in] allocator allocator of builder and built NFA memory (nullable)
+ *
+ * @return created builder (its arrays may be NULL if allocation failed)
+ */
+static VsccNfaBuilder vsccNfaBuilderCtor( const VsccAllocator *allocator ) {
+    return (VsccNfaBuilder) {
+        .states       = vsccArrayCtor(sizeof(VsccNfaState), allocator),
+        .transitions  = vsccArrayCtor(sizeof(VsccNfaTransition), allocator),
+        .starts       = vsccArrayCtor(sizeof(uint32_t), allocator),
+        .alternatives = vsccArrayCtor(sizeof(const VsccRule *), allocator),
+        .epsilons     = vsccArrayCtor(sizeof(VsccNfaTransition), allocator),
+        .allocator    = allocator,
+    };
+} // vsccNfaBuilderCtor
+
+/**
+ * @brief NFA builder validity checking function
+ *
+ * @param[in] builder builder (non-null)
+ *
+ * @return true if all builder arrays are allocated, false otherwise
+ */
+static bool vsccNfaBuilderValid( const VsccNfaBuilder *builder ) {
+    return true
+        && builder->states != NULL
+        && builder->transitions != NULL
+        && builder->starts != NULL
+        && builder->alternatives != NULL
+        && builder->epsilons != NULL
+    ;
+} // vsccNfaBuilderValid
+
+/**
+ * @brief NFA builder destructor
+ *
+ * @param[in] builder builder to destroy (non-null)
+ */
+static void vsccNfaBuilderDtor( VsccNfaBuilder *builder ) {
+    vsccArrayDtor(builder->states);
+    vsccArrayDtor(builder->transitions);
+    vsccArrayDtor(builder->starts);
+    vsccArrayDtor(builder->alternatives);
+    vsccArrayDtor(builder->epsilons);
+} // vsccNfaBuilderDtor
+
+/// @brief NFA cache entry format version (must be incremented on NFA layout change)
+#define VSCC_NFA_CACHE_VERSION 2
+
+/**
+ * @brief NFA cache key computing function
+ *
+ * @param[in] hash    structural hash of rules NFA is built of
+ * @param[in] longest true for longest match NFA, false for first match one
+ *
+ * @return cache key
+ */
+static uint64_t vsccNfaCacheKey( uint64_t hash, bool longest ) {
+    const uint64_t format[5] = { VSCC_NFA_CACHE_VERSION, longest, sizeof(VsccNfaState), sizeof(VsccNfaTransition), 0x61666E /* "nfa" */ };
+
+    return vsccHashBytes(hash, format, sizeof(format));
+} // vsccNfaCacheKey
+
+/**
+ * @brief NFA cache digest updating function
+ *
+ * @param[in] digest digest to update
+ * @param[in] data   data to digest (non-null if size != 0)
+ * @param[in] size   data size
+ *
+ * @note digest uses other mixing function and seed than vsccHashBytes, so it's independent from structural hashes
+ *
+ * @return updated digest
+ */
+static uint64_t vsccNfaDigestBytes( uint64_t digest, const void *data, size_t size ) {
+    const uint8_t *bytes = (const uint8_t *)data;
+
+    for (size_t i = 0; i < size; i++) {
+        digest = (digest + bytes[i] + 1) * 0x9E3779B97F4A7C15;
+        digest ^= digest >> 29;
+    }
+
+    // size is digested too, so adjacent fields can't be shifted into each other
+    const uint64_t size64 = size;
+
+    digest = (digest ^ size64) * 0xBF58476D1CE4E5B9;
+    return digest ^ digest >> 31;
+} // vsccNfaDigestBytes
+
+/**
+ * @brief NFA cache rule digest updating function
+ *
+ * @param[in] digest  digest to update
+ * @param[in] grammar grammar to inline references from (nullable, references are digested by name only if NULL)
+ * @param[in] rule    rule to digest (non-null)
+ * @param[in] depth   count of references inlined before rule
+ *
+ * @note digest covers everything NFA is built of (terminal contents and inlined references)
+ *
+ * @return updated digest
+ */
+static uint64_t vsccNfaDigestRule( uint64_t digest, const VsccGrammar *grammar, const VsccRule *rule, size_t depth ) {
+    const uint8_t type = (uint8_t)rule->type;
+
+    digest = vsccNfaDigestBytes(digest, &type, 1);
+
+    switch (rule->type) {
+    case VSCC_RULE_SEQUENCE:
+        for (size_t i = 0; i < rule->sequence.count; i++)
+            digest = vsccNfaDigestRule(digest, grammar, rule->sequence.rules[i], depth);
+        return vsccNfaDigestBytes(digest, &rule->sequence.count, sizeof(size_t));
+
+    case VSCC_RULE_VARIANT:
+        for (size_t i = 0; i < rule->variant.count; i++)
+            digest = vsccNfaDigestRule(digest, grammar, rule->variant.rules[i], depth);
+        return vsccNfaDigestBytes(digest, &rule->variant.count, sizeof(size_t));
+
+    case VSCC_RULE_OPTIONAL:
+        return vsccNfaDigestRule(digest, grammar, rule->optional, depth);
+
+    case VSCC_RULE_REPEAT:
+        digest = vsccNfaDigestBytes(digest, &rule->repeat.atLeastOnce, sizeof(bool));
+        return vsccNfaDigestRule(digest, grammar, rule->repeat.rule, depth);
+
+    case VSCC_RULE_STRING_TERMINAL:
+        return vsccNfaDigestBytes(digest, rule->stringTerminal.string, rule->stringTerminal.length);
+
+    case VSCC_RULE_CHAR_TERMINAL:
+        return vsccNfaDigestBytes(digest, rule->charTerminal.ranges, rule->charTerminal.count * sizeof(VsccRuleCharRange));
+
+    case VSCC_RULE_REFERENCE:
+        digest = vsccNfaDigestBytes(digest, rule->reference.name, strlen(rule->reference.name));
+
+        // recursive references are rejected by NFA construction, so they are not followed here too
+        if (grammar == NULL || depth >= grammar->ruleCount)
+            return digest;
+        return vsccNfaDigestRule(digest, grammar, grammar->rules[rule->reference.index].rule, depth + 1);
+
+    case VSCC_RULE_END:
+    case VSCC_RULE_EMPTY:
+        return digest;
+    }
+
+    return digest;
+} // vsccNfaDigestRule
+
+/**
+ * @brief NFA alternatives digest computing function
+ *
+ * @param[in] alternatives alternative rules (const VsccRule *)
+ * @param[in] grammar      grammar to inline references from (nullable)
+ *
+ * @return digest of alternatives
+ */
+static uint64_t vsccNfaDigest( VsccArray alternatives, const VsccGrammar *grammar ) {
+    const VsccRule **rules = (const VsccRule **)vsccArrayData(alternatives);
+    uint64_t digest = 0x736E6F6974706F;
+
+    for (size_t i = 0; i < vsccArraySize(alternatives); i++)
+        digest = vsccNfaDigestRule(digest, grammar, rules[i], 0);
+    return digest;
+} // vsccNfaDigest
+
+/**
+ * @brief NFA storing to cache function
+ *
+ * @param[in]     nfa    NFA to store (non-null)
+ * @param[in,out] cache  cache (non-null)
+ * @param[in]     key    cache key
+ * @param[in]     digest digest of rules NFA is built of (see vsccNfaDigest)
+ *
+ * @note alternatives are not stored, as they are rules NFA is loaded for, digest is stored instead
+ *
+ * @return true if stored, false if allocation failed
+ */
+static bool vsccNfaStore( const VsccNfaImpl *nfa, VsccCache cache, uint64_t key, uint64_t digest ) {
+    const uint64_t header[6] = { nfa->stateCount, nfa->transitionCount, nfa->startCount, nfa->alternativeCount, nfa->byteClassCount, digest };
+    const size_t statesSize = nfa->stateCount * sizeof(VsccNfaState);
+    const size_t transitionsSize = nfa->transitionCount * sizeof(VsccNfaTransition);
+    const size_t startsSize = nfa->startCount * sizeof(uint32_t);
+    const size_t size = sizeof(header) + sizeof(nfa->byteClasses) + statesSize + transitionsSize + startsSize;
+    uint8_t *data = (uint8_t *)vsccAllocateZeroed(nfa->allocator, size, 1);
+
+    if (data == NULL)
+        return false;
+
+    uint8_t *dst = data;
+
+    memcpy(dst, header, sizeof(header));
+    dst += sizeof(header);
+    memcpy(dst, nfa->byteClasses, sizeof(nfa->byteClasses));
+    dst += sizeof(nfa->byteClasses);
+    memcpy(dst, nfa->states, statesSize);
+    dst += statesSize;
+    memcpy(dst, nfa->transitions, transitionsSize);
+    dst += transitionsSize;
+    memcpy(dst, nfa->starts, startsSize);
+
+    const bool stored = vsccCacheInsert(cache, key, data, size);
+
+    vsccDeallocate(nfa->allocator, data);
+    return stored;
+} // vsccNfaStore
+
+/**
+ * @brief NFA loading from cache function
+ *
+ * @param[in] cache        cache (non-null)
+ * @param[in] key          cache key
+ * @param[in] digest       digest of rules NFA is built of (see vsccNfaDigest)
+ * @param[in] alternatives alternative rules of NFA (const VsccRule *)
+ * @param[in] longest      true if longest match should win, false if first matching alternative should
+ * @param[in] allocator    allocator of NFA memory (nullable)
+ *
+ * @note cache entry is validated, so corrupted entries and entries built of other rules with colliding key are not loaded
+ *
+ * @return loaded NFA (NULL if there is no valid entry or allocation failed)
+ */
+static VsccNfa vsccNfaLoad( VsccCache cache, uint64_t key, uint64_t digest, VsccArray alternatives, bool longest, const VsccAllocator *allocator ) {
+    size_t size = 0;
+    const uint8_t *data = (const uint8_t *)vsccCacheFind(cache, key, &size);
+    uint64_t header[6];
+
+    if (data == NULL || size < sizeof(header) + 256)
+        return NULL;
+    memcpy(header, data, sizeof(header));
+
+    const uint64_t stateCount = header[0], transitionCount = header[1], startCount = header[2];
+
+    if (false
+        || stateCount >= UINT32_MAX || transitionCount >= UINT32_MAX || startCount >= UINT32_MAX
+        || header[3] != vsccArraySize(alternatives)
+        || header[4] == 0 || header[4] > 256
+        || header[5] != digest
+        || size != sizeof(header) + 256 + stateCount * sizeof(VsccNfaState) + transitionCount * sizeof(VsccNfaTransition) + startCount * sizeof(uint32_t)
+    )
+        return NULL;
+
+    VsccNfa nfa = (VsccNfa)vsccAllocateZeroed(allocator, 1, sizeof(VsccNfaImpl));
+
+    if (nfa == NULL)
+        return NULL;
+
+    nfa->allocator = allocator;
+    nfa->stateCount = stateCount;
+    nfa->transitionCount = transitionCount;
+    nfa->startCount = startCount;
+    nfa->alternativeCount = vsccArraySize(alternatives);
+    nfa->byteClassCount = header[4];
+    nfa->longest = longest;
+    nfa->states = (VsccNfaState *)vsccAllocateZeroed(allocator, stateCount + 1, sizeof(VsccNfaState));
+    nfa->transitions = (VsccNfaTransition *)vsccAllocateZeroed(allocator, transitionCount + 1, sizeof(VsccNfaTransition));
+    nfa->starts = (uint32_t *)vsccAllocateZeroed(allocator, startCount + 1, sizeof(uint32_t));
+    nfa->alternatives = (const VsccRule **)vsccNfaCopyArray(alternatives, sizeof(const VsccRule *), allocator);
+
+    if (nfa->states == NULL || nfa->transitions == NULL || nfa->starts == NULL || nfa->alternatives == NULL) {
+        vsccNfaDtor(nfa);
+        return NULL;
+    }
+
+    const uint8_t *src = data + sizeof(header);
+
+    memcpy(nfa->byteClasses, src, 256);
+    src += 256;
+    memcpy(nfa->states, src, stateCount * sizeof(VsccNfaState));
+    src += stateCount * sizeof(VsccNfaState);
+    memcpy(nfa->transitions, src, transitionCount * sizeof(VsccNfaTransition));
+    src += transitionCount * sizeof(VsccNfaTransition);
+    memcpy(nfa->starts, src, startCount * sizeof(uint32_t));
+
+    // matching trusts NFA indices, so they are checked once here
+    bool valid = true;
+
+    for (size_t i = 0; valid && i < 256; i++)
+        valid = nfa->byteClasses[i] < nfa->byteClassCount;
+    for (size_t i = 0; valid && i < stateCount; i++)
+        valid = true
+            && (nfa->states[i].alternative < nfa->alternativeCount)
+            && (uint64_t)nfa->states[i].transitionBegin + nfa->states[i].transitionCount <= transitionCount
+        ;
+    for (size_t i = 0; valid && i < transitionCount; i++)
+        valid = true
+            && nfa->transitions[i].source < stateCount
+            && nfa->transitions[i].target < stateCount
+            && nfa->transitions[i].first <= nfa->transitions[i].last
+        ;
+    for (size_t i = 0; valid && i < startCount; i++)
+        valid = nfa->starts[i] < stateCount;
+
+    if (!valid) {
+        vsccNfaDtor(nfa);
+        return NULL;
+    }
+
+    return nfa;
+} // vsccNfaLoad
+
+VsccNfa vsccNfaCtor( const VsccRule *rule, VsccCache cache, const VsccAllocator *allocator ) {
+    assert(rule != NULL);
+
+    if (rule->type != VSCC_RULE_VARIANT)
+        return NULL;
+
+    VsccNfaBuilder builder = vsccNfaBuilderCtor(allocator);
+    VsccNfa nfa = NULL;
+    uint64_t digest = 0;
+
+    if (false
+        || !vsccNfaBuilderValid(&builder)
+        || !vsccNfaCollectAlternatives(rule, &builder.alternatives)
+        || vsccArraySize(builder.alternatives) < VSCC_NFA_MIN_ALTERNATIVE_COUNT
+    )
+        goto vsccNfaCtor_end;
+
+    digest = vsccNfaDigest(builder.alternatives, NULL);
+
+    if (cache != NULL && (nfa = vsccNfaLoad(cache, vsccNfaCacheKey(rule->hash, false), digest, builder.alternatives, false, allocator)) != NULL)
+        goto vsccNfaCtor_end;
+
+    for (size_t i = 0; i < vsccArraySize(builder.alternatives); i++)
+        if (!vsccNfaAddAlternative(&builder, ((const VsccRule **)vsccArrayData(builder.alternatives))[i], (uint32_t)i))
+            goto vsccNfaCtor_end;
+
+    nfa = vsccNfaBuild(&builder, false);
+
+    // cache is an optimization only, so failure to store NFA is ignored
+    if (nfa != NULL && cache != NULL)
+        vsccNfaStore(nfa, cache, vsccNfaCacheKey(rule->hash, false), digest);
+
+vsccNfaCtor_end:
+    vsccNfaBuilderDtor(&builder);
+
+    return nfa;
+} // vsccNfaCtor
+
+VsccNfa vsccNfaTokenCtor( const VsccGrammar *grammar, const VsccAllocator *allocator ) {
+    assert(grammar != NULL);
+    assert(grammar->linked);
+
+    VsccNfaBuilder builder = vsccNfaBuilderCtor(allocator);
+    VsccNfa nfa = NULL;
+    uint64_t key = VSCC_HASH_INITIAL;
+    uint64_t digest = 0;
+    bool cached = grammar->cache != NULL;
+
+    if (!vsccNfaBuilderValid(&builder))
+        goto vsccNfaTokenCtor_end;
+
+    // token NFA depends on token rules and everything they reference
+    for (size_t i = 0; cached && i < grammar->ruleCount; i++) {
+        const VsccRule *rule = grammar->rules[i].rule;
+        uint64_t closure;
+
+        if (grammar->rules[i].token == VSCC_TOKEN_NONE)
+            continue;
+        cached = true
+            && vsccGrammarClosureHash(grammar, i, &closure)
+            && vsccArrayPush(&builder.alternatives, &rule)
+        ;
+        key = vsccHashBytes(key, &closure, sizeof(closure));
+    }
+    key = vsccNfaCacheKey(key, true);
+    if (cached)
+        digest = vsccNfaDigest(builder.alternatives, grammar);
+
+    if (cached && (nfa = vsccNfaLoad(grammar->cache, key, digest, builder.alternatives, true, allocator)) != NULL)
+        goto vsccNfaTokenCtor_end;
+    vsccArrayTruncate(builder.alternatives, 0);
+
+    for (size_t i = 0; i < grammar->ruleCount; i++) {
+        if (grammar->rules[i].token == VSCC_TOKEN_NONE)
+            continue;
+
+        const uint32_t alternative = (uint32_t)vsccArraySize(builder.alternatives);
+        const VsccRule *rule = grammar->rules[i].rule;
+        uint32_t start, accept;
+
+        if (false
+            || !vsccNfaAddState(&builder, alternative, false, &start)
+            || !vsccNfaAddState(&builder, alternative, true, &accept)
+            || !vsccNfaAddRegular(&builder, grammar, rule, start, accept, 0)
+            || !vsccArrayPush(&builder.starts, &start)
+            || !vsccArrayPush(&builder.alternatives, &rule)
+        )
+            goto vsccNfaTokenCtor_end;
+    }
+
+    if (vsccArraySize(builder.alternatives) == 0 || !vsccNfaEliminateEpsilons(&builder))
+        goto vsccNfaTokenCtor_end;
+
+    nfa = vsccNfaBuild(&builder, true);
+
+    if (nfa != NULL && cached)
+        vsccNfaStore(nfa, grammar->cache, key, digest);
+
+vsccNfaTokenCtor_end:
+    vsccNfaBuilderDtor(&builder);
+
+    return nfa;
+} // vsccNfaTokenCtor
+
+void vsccNfaDtor( VsccNfa nfa ) {
+    if (nfa == NULL)
+        return;
+
+    vsccDeallocate(nfa->allocator, nfa->states);
+    vsccDeallocate(nfa->allocator, nfa->transitions);
+    vsccDeallocate(nfa->allocator, nfa->starts);
+    vsccDeallocate(nfa->allocator, nfa->alternatives);
+    vsccDeallocate(nfa->allocator, nfa);
+} // vsccNfaDtor
+
+size_t vsccNfaAlternativeCount( const VsccNfa nfa ) {
+    assert(nfa != NULL);
+    return nfa->alternativeCount;
+} // vsccNfaAlternativeCount
+
+const VsccRule * vsccNfaAlternative( const VsccNfa nfa, size_t index ) {
+    assert(nfa != NULL);
+    assert(index < nfa->alternativeCount);
+    return nfa->alternatives[index];
+} // vsccNfaAlternative
+
+/// @brief lazy DFA state
+typedef struct __VsccLazyDfaState {
+    uint32_t setBegin; ///< index of first NFA state of set in set pool
+    uint32_t setCount; ///< count of NFA states in set
+    uint32_t accept;   ///< best alternative accepted in state
+    bool     live;     ///< true if state has some transitions
+} VsccLazyDfaState;
+
+/// @brief lazy DFA internal representation
+typedef struct __VsccLazyDfaImpl {
+    const VsccNfaImpl * nfa;             ///< NFA to determinize
+    VsccArray           states;          ///< built states (VsccLazyDfaState)
+    size_t              stateLimit;      ///< maximal count of states in cache
+    int16_t           * next;            ///< transition table (stateLimit rows of byteClassCount next states)
+    VsccArray           setPool;         ///< NFA state sets of built states (uint32_t)
+    size_t              setPoolLimit;    ///< maximal count of NFA states in set pool
+    int16_t             start;           ///< start state (VSCC_LAZY_DFA_UNKNOWN if not built)
+    int16_t           * index;           ///< state by NFA state set hash table
+    size_t              indexSize;       ///< hash table size (power of 2)
+    uint32_t          * marks;           ///< NFA state marks (for set deduplication)
+    uint32_t            generation;      ///< current mark generation
+    uint32_t          * currentSet;      ///< NFA simulation current set
+    uint32_t          * nextSet;         ///< NFA simulation next set / set construction buffer
+    size_t              bytesSinceFlush; ///< count of bytes scanned since last cache flush
+    size_t              shortFlushCount; ///< count of consecutive flushes of caches that didn't survive long
+    bool                simulate;        ///< true if cache thrashes, so NFA is simulated directly
+    const VsccAllocator * allocator;     ///< allocator of DFA memory (nullable)
+} VsccLazyDfaImpl;
+
+VsccLazyDfa vsccLazyDfaCtor( const VsccNfa nfa, const VsccAllocator *allocator ) {
+    assert(nfa != NULL);
+
+    VsccLazyDfa dfa = (VsccLazyDfa)vsccAllocateZeroed(allocator, 1, sizeof(VsccLazyDfaImpl));
+
+    if (dfa == NULL)
+        return NULL;
+
+    dfa->allocator = allocator;
+
+    // split memory budget between transition table and set pool
+    dfa->nfa = nfa;
+    dfa->start = VSCC_LAZY_DFA_UNKNOWN;
+    dfa->stateLimit = VSCC_LAZY_DFA_CACHE_SIZE / 2 / (nfa->byteClassCount * sizeof(int16_t) + sizeof(VsccLazyDfaState));
+    if (dfa->stateLimit > VSCC_LAZY_DFA_STATE_LIMIT)
+        dfa->stateLimit = VSCC_LAZY_DFA_STATE_LIMIT;
+    dfa->setPoolLimit = VSCC_LAZY_DFA_CACHE_SIZE / 2 / sizeof(uint32_t);
+    if (dfa->setPoolLimit < nfa->stateCount)
+        dfa->setPoolLimit = nfa->stateCount;
+
+    dfa->indexSize = 1;
+    while (dfa->indexSize < dfa->stateLimit * 2)
+        dfa->indexSize *= 2;
+
+    dfa->states = vsccArrayCtor(sizeof(VsccLazyDfaState), allocator);
+    dfa->setPool = vsccArrayCtor(sizeof(uint32_t), allocator);
+    dfa->next = (int16_t *)vsccAllocate(allocator, dfa->stateLimit * nfa->byteClassCount * sizeof(int16_t));
+    dfa->index = (int16_t *)vsccAllocate(allocator, dfa->indexSize * sizeof(int16_t));
+    dfa->marks = (uint32_t *)vsccAllocateZeroed(allocator, nfa->stateCount + 1, sizeof(uint32_t));
+    dfa->currentSet = (uint32_t *)vsccAllocateZeroed(allocator, nfa->stateCount + 1, sizeof(uint32_t));
+    dfa->nextSet = (uint32_t *)vsccAllocateZeroed(allocator, nfa->stateCount + 1, sizeof(uint32_t));
+
+    if (false
+        || dfa->states == NULL
+        || dfa->setPool == NULL
+        || dfa->next == NULL
+        || dfa->index == NULL
+        || dfa->marks == NULL
+        || dfa->currentSet == NULL
+        || dfa->nextSet == NULL
+    ) {
+        vsccLazyDfaDtor(dfa);
+        return NULL;
+    }
+
+    memset(dfa->index, 0xFF, dfa->indexSize * sizeof(int16_t));
+
+    return dfa;
+} // vsccLazyDfaCtor
+
+void vsccLazyDfaDtor( VsccLazyDfa dfa ) {
+    if (dfa == NULL)
+        return;
+
+    vsccArrayDtor(dfa->states);
+    vsccArrayDtor(dfa->setPool);
+    vsccDeallocate(dfa->allocator, dfa->next);
+    vsccDeallocate(dfa->allocator, dfa->index);
+    vsccDeallocate(dfa->allocator, dfa->marks);
+    vsccDeallocate(dfa->allocator, dfa->currentSet);
+    vsccDeallocate(dfa->allocator, dfa->nextSet);
+    vsccDeallocate(dfa->allocator, dfa);
+} // vsccLazyDfaDtor
+
+/**
+ * @brief NFA state set normalizing function
+ *
+ * @param[in]     dfa    lazy DFA (non-null)
+ * @param[in,out] set    set to normalize (non-null)
+ * @param[in]     count  count of states in set
+ * @param[out]    accept best alternative accepted by set destination (non-null)
+ * @param[out]    live   true if set has some transitions destination (non-null)
+ *
+ * @note unless longest match is required, states of alternatives that are worse than accepted one
+ *       are dropped, as they can't win anymore
+ *
+ * @return count of states in normalized set
+ */
+static size_t vsccLazyDfaNormalize( const VsccLazyDfaImpl *dfa, uint32_t *set, size_t count, uint32_t *accept, bool *live ) {
+    const VsccNfaState *states = dfa->nfa->states;
+    uint32_t best = VSCC_NFA_NO_ALTERNATIVE;
+
+    for (size_t i = 0; i < count; i++)
+        if (states[set[i]].accepting && states[set[i]].alternative < best)
+            best = states[set[i]].alternative;
+
+    size_t newCount = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        const VsccNfaState *state = &states[set[i]];
+
+        if ((!dfa->nfa->longest && state->alternative > best) || state->transitionCount == 0)
+            continue;
+        set[newCount++] = set[i];
+    }
+
+    // insertion sort, sets are small and almost sorted
+    for (size_t i = 1; i < newCount; i++)
+        for (size_t j = i; j > 0 && set[j - 1] > set[j]; j--) {
+            const uint32_t tmp = set[j];
+            set[j] = set[j - 1];
+            set[j - 1] = tmp;
+        }
+
+    *accept = best;
+    *live = newCount != 0;
+    return newCount;
+} // vsccLazyDfaNormalize
+
+/**
+ * @brief NFA state set single byte stepping function
+ *
+ * @param[in,out] dfa    lazy DFA (non-null)
+ * @param[in]     set    source state set (non-null)
+ * @param[in]     count  count of states in source set
+ * @param[in]     byte   input byte
+ * @param[out]    result target state set destination (non-null, at least nfa state count elements writable)
+ *
+ * @return count of states in target set (not normalized)
+ */
+static size_t vsccLazyDfaStep( VsccLazyDfaImpl *dfa, const uint32_t *set, size_t count, uint8_t byte, uint32_t *result ) {
+    const VsccNfaImpl *nfa = dfa->nfa;
+    size_t resultCount = 0;
+
+    if (++dfa->generation == 0) {
+        memset(dfa->marks, 0, nfa->stateCount * sizeof(uint32_t));
+        dfa->generation = 1;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        const VsccNfaState *state = &nfa->states[set[i]];
+
+        for (uint32_t t = state->transitionBegin; t < state->transitionBegin + state->transitionCount; t++) {
+            const VsccNfaTransition *transition = &nfa->transitions[t];
+
+            if (byte < transition->first || byte > transition->last || dfa->marks[transition->target] == dfa->generation)
+                continue;
+            dfa->marks[transition->target] = dfa->generation;
+            result[resultCount++] = transition->target;
+        }
+    }
+
+    return resultCount;
+} // vsccLazyDfaStep
+
+/**
+ * @brief NFA state set hashing function
+ *
+ * @param[in] set   set to hash (non-null)
+ * @param[in] count count of states in set
+ *
+ * @return hash
+ */
+static uint64_t vsccLazyDfaHashSet( const uint32_t *set, size_t count ) {
+    uint64_t hash = 0xCBF29CE484222325;
+
+    for (size_t i = 0; i < count; i++)
+        hash = (hash ^ set[i]) * 0x100000001B3;
+    return hash ^ hash >> 29;
+} // vsccLazyDfaHashSet
+
+/**
+ * @brief cache flushing function
+ *
+ * @param[in,out] dfa lazy DFA (non-null)
+ */
+static void vsccLazyDfaFlush( VsccLazyDfaImpl *dfa ) {
+    // cache that didn't live long means that input walks too many distinct states
+    if (dfa->bytesSinceFlush < 4 * vsccArraySize(dfa->states))
+        dfa->shortFlushCount++;
+    else
+        dfa->shortFlushCount = 0;
+
+    if (dfa->shortFlushCount >= VSCC_LAZY_DFA_THRASH_LIMIT)
+        dfa->simulate = true;
+
+    vsccArrayTruncate(dfa->states, 0);
+    vsccArrayTruncate(dfa->setPool, 0);
+    memset(dfa->index, 0xFF, dfa->indexSize * sizeof(int16_t));
+    dfa->start = VSCC_LAZY_DFA_UNKNOWN;
+    dfa->bytesSinceFlush = 0;
+} // vsccLazyDfaFlush
+
+/**
+ * @brief normalized NFA state set interning function
+ *
+ * @param[in,out] dfa    lazy DFA (non-null)
+ * @param[in]     set    normalized set (non-null, must not point into set pool)
+ * @param[in]     count  count of states in set
+ * @param[in]     accept best alternative accepted by set
+ * @param[in]     live   true if set has some transitions
+ *
+ * @return state index, VSCC_LAZY_DFA_DEAD if set accepts nothing and is empty, VSCC_LAZY_DFA_UNKNOWN if cache is full or allocation failed
+ */
+static int16_t vsccLazyDfaIntern( VsccLazyDfaImpl *dfa, const uint32_t *set, size_t count, uint32_t accept, bool live ) {
+    if (count == 0 && accept == VSCC_NFA_NO_ALTERNATIVE)
+        return VSCC_LAZY_DFA_DEAD;
+
+    const VsccLazyDfaState *states = (const VsccLazyDfaState *)vsccArrayData(dfa->states);
+    const uint32_t *pool = (const uint32_t *)vsccArrayData(dfa->setPool);
+    size_t slot = (vsccLazyDfaHashSet(set, count) ^ accept) & (dfa->indexSize - 1);
+
+    for (; dfa->index[slot] >= 0; slot = (slot + 1) & (dfa->indexSize - 1)) {
+        const VsccLazyDfaState *state = &states[dfa->index[slot]];
+
+        if (true
+            && state->accept == accept
+            && state->setCount == count
+            && memcmp(pool + state->setBegin, set, count * sizeof(uint32_t)) == 0
+        )
+            return dfa->index[slot];
+    }
+
+    const size_t stateCount = vsccArraySize(dfa->states);
+    const size_t poolSize = vsccArraySize(dfa->setPool);
+
+    if (stateCount >= dfa->stateLimit || poolSize + count > dfa->setPoolLimit)
+        return VSCC_LAZY_DFA_UNKNOWN;
+
+    const VsccLazyDfaState state = {
+        .setBegin = (uint32_t)poolSize,
+        .setCount = (uint32_t)count,
+        .accept   = accept,
+        .live     = live,
+    };
+
+    for (size_t i = 0; i < count; i++)
+        if (!vsccArrayPush(&dfa->setPool, &set[i]))
+            return VSCC_LAZY_DFA_UNKNOWN;
+    if (!vsccArrayPush(&dfa->states, &state))
+        return VSCC_LAZY_DFA_UNKNOWN;
+
+    memset(dfa->next + stateCount * dfa->nfa->byteClassCount, 0xFF, dfa->nfa->byteClassCount * sizeof(int16_t));
+    dfa->index[slot] = (int16_t)stateCount;
+    return (int16_t)stateCount;
+} // vsccLazyDfaIntern
+
+/**
+ * @brief start NFA state set building function
+ *
+ * @param[in,out] dfa    lazy DFA (non-null)
+ * @param[out]    set    start set destination (non-null, at least nfa state count elements writable)
+ * @param[out]    accept best accepted alternative destination (non-null)
+ * @param[out]    live   true if set has some transitions destination (non-null)
+ *
+ * @return count of states in set
+ */
+static size_t vsccLazyDfaStartSet( const VsccLazyDfaImpl *dfa, uint32_t *set, uint32_t *accept, bool *live ) {
+    memcpy(set, dfa->nfa->starts, dfa->nfa->startCount * sizeof(uint32_t));
+    return vsccLazyDfaNormalize(dfa, set, dfa->nfa->startCount, accept, live);
+} // vsccLazyDfaStartSet
+
+/**
+ * @brief direct NFA simulation function
+ *
+ * @param[in,out] dfa         lazy DFA (non-null)
+ * @param[in]     strBegin    begin of string slice to match (non-null)
+ * @param[in]     strEnd      end of string slice to match (non-null)
+ * @param[out]    alternative matched alternative destination (non-null)
+ * @param[out]    length      matched length destination (non-null)
+ *
+ * @return true if some alternative matched, false otherwise
+ */
+static bool vsccLazyDfaSimulate( VsccLazyDfaImpl *dfa, const char *strBegin, const char *strEnd, size_t *alternative, size_t *length ) {
+    uint32_t accept;
+    bool live;
+    size_t count = vsccLazyDfaStartSet(dfa, dfa->currentSet, &accept, &live);
+    bool matched = false;
+
+    for (const char *str = strBegin; ; str++) {
+        if (accept != VSCC_NFA_NO_ALTERNATIVE) {
+            *alternative = accept;
+            *length = str - strBegin;
+            matched = true;
+        }
+        if (!live || str == strEnd)
+            break;
+
+        count = vsccLazyDfaStep(dfa, dfa->currentSet, count, (uint8_t)*str, dfa->nextSet);
+        count = vsccLazyDfaNormalize(dfa, dfa->nextSet, count, &accept, &live);
+
+        uint32_t *tmp = dfa->currentSet;
+        dfa->currentSet = dfa->nextSet;
+        dfa->nextSet = tmp;
+    }
+
+    return matched;
+} // vsccLazyDfaSimulate
+
+/**
+ * @brief missing lazy DFA transition building function
+ *
+ * @param[in,out] dfa     lazy DFA (non-null)
+ * @param[in,out] current current state (non-null, may be changed if cache is flushed)
+ * @param[in]     byte    input byte
+ *
+ * @return next state, VSCC_LAZY_DFA_UNKNOWN if DFA switched to NFA simulation
+ */
+static int16_t vsccLazyDfaBuildTransition( VsccLazyDfaImpl *dfa, int16_t *current, uint8_t byte ) {
+    const VsccLazyDfaState state = ((const VsccLazyDfaState *)vsccArrayData(dfa->states))[*current];
+    const uint32_t *set = (const uint32_t *)vsccArrayData(dfa->setPool) + state.setBegin;
+    uint32_t accept;
+    bool live;
+
+    size_t count = vsccLazyDfaStep(dfa, set, state.setCount, byte, dfa->nextSet);
+    count = vsccLazyDfaNormalize(dfa, dfa->nextSet, count, &accept, &live);
+
+    int16_t next = vsccLazyDfaIntern(dfa, dfa->nextSet, count, accept, live);
+
+    if (next == VSCC_LAZY_DFA_UNKNOWN) {
+        // cache is full, flush it and continue from the copy of current state
+        memcpy(dfa->currentSet, set, state.setCount * sizeof(uint32_t));
+        vsccLazyDfaFlush(dfa);
+
+        if (dfa->simulate)
+            return VSCC_LAZY_DFA_UNKNOWN;
+
+        *current = vsccLazyDfaIntern(dfa, dfa->currentSet, state.setCount, state.accept, state.live);
+        next = vsccLazyDfaIntern(dfa, dfa->nextSet, count, accept, live);
+
+        if (*current < 0 || next == VSCC_LAZY_DFA_UNKNOWN) {
+            dfa->simulate = true;
+            return VSCC_LAZY_DFA_UNKNOWN;
+        }
+    }
+
+    dfa->next[*current * dfa->nfa->byteClassCount + dfa->nfa->byteClasses[byte]] = next;
+    return next;
+} // vsccLazyDfaBuildTransition
+
+bool vsccLazyDfaMatch( VsccLazyDfa dfa, const char *strBegin, const char *strEnd, size_t *alternative, size_t *length ) {
+    assert(dfa != NULL);
+    assert(strBegin <= strEnd);
+    assert(alternative != NULL);
+    assert(length != NULL);
+
+    if (dfa->simulate)
+        return vsccLazyDfaSimulate(dfa, strBegin, strEnd, alternative, length);
+
+    if (dfa->start == VSCC_LAZY_DFA_UNKNOWN) {
+        uint32_t accept;
+        bool live;
+        const size_t count = vsccLazyDfaStartSet(dfa, dfa->nextSet, &accept, &live);
+
+        dfa->start = vsccLazyDfaIntern(dfa, dfa->nextSet, count, accept, live);
+        if (dfa->start == VSCC_LAZY_DFA_UNKNOWN) {
+            dfa->simulate = true;
+            return vsccLazyDfaSimulate(dfa, strBegin, strEnd, alternative, length);
+        }
+    }
+
+    if (dfa->start == VSCC_LAZY_DFA_DEAD)
+        return false;
+
+    const uint8_t *byteClasses = dfa->nfa->byteClasses;
+    const size_t byteClassCount = dfa->nfa->byteClassCount;
+    int16_t current = dfa->start;
+    bool matched = false;
+    const char *str = strBegin;
+
+    for (;; str++) {
+        const VsccLazyDfaState *state = (const VsccLazyDfaState *)vsccArrayData(dfa->states) + current;
+
+        if (state->accept != VSCC_NFA_NO_ALTERNATIVE) {
+            *alternative = state->accept;
+            *length = str - strBegin;
+            matched = true;
+        }
+        if (!state->live || str == strEnd)
+            break;
+
+        const uint8_t byte = (uint8_t)*str;
+        int16_t next = dfa->next[current * byteClassCount + byteClasses[byte]];
+
+        if (next == VSCC_LAZY_DFA_UNKNOWN) {
+            next = vsccLazyDfaBuildTransition(dfa, &current, byte);
+
+            // cache thrashes, so just rematch with simulation
+            if (next == VSCC_LAZY_DFA_UNKNOWN)
+                return vsccLazyDfaSimulate(dfa, strBegin, strEnd, alternative, length);
+        }
+
+        if (next == VSCC_LAZY_DFA_DEAD)
+            break;
+        current = next;
+    }
+
+    dfa->bytesSinceFlush += str - strBegin;
+    return matched;
+} // vsccLazyDfaMatch
+
+// vscc_automaton.c
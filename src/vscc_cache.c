@@ -0,0 +1,315 @@
+/**
+ * @brief persistent artifact cache implementation file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "vscc.h"
+
+/// @brief cache file format magic
+#define VSCC_CACHE_MAGIC "VSCCACHE"
+
+/// @brief cache file format version
+#define VSCC_CACHE_VERSION 1
+
+/// @brief cache entry
+typedef struct __VsccCacheEntry {
+    uint64_t   key;  ///< entry key
+    void     * data; ///< entry data
+    size_t     size; ///< entry data size
+    bool       used; ///< true if entry was found or inserted since cache load
+} VsccCacheEntry;
+
+/// @brief cache internal representation
+typedef struct __VsccCacheImpl {
+    char      * path;      ///< cache file path
+    VsccArray   entries;   ///< entries (VsccCacheEntry)
+    size_t    * index;     ///< entry by key hash table (SIZE_MAX if slot is empty)
+    size_t      indexSize; ///< hash table size (power of 2)
+    bool        modified;  ///< true if cache has entries that are not saved yet
+} VsccCacheImpl;
+
+/**
+ * @brief hash table rebuilding function
+ *
+ * @param[in,out] cache cache (non-null)
+ * @param[in]     size  new hash table size (power of 2, > entry count)
+ *
+ * @return true if rebuilt, false if allocation failed (old table is kept then)
+ */
+static bool vsccCacheRebuildIndex( VsccCacheImpl *cache, size_t size ) {
+    size_t *index = (size_t *)malloc(size * sizeof(size_t));
+
+    if (index == NULL)
+        return false;
+    memset(index, 0xFF, size * sizeof(size_t));
+
+    const VsccCacheEntry *entries = (const VsccCacheEntry *)vsccArrayData(cache->entries);
+
+    for (size_t i = 0; i < vsccArraySize(cache->entries); i++) {
+        size_t slot = entries[i].key & (size - 1);
+
+        while (index[slot] != SIZE_MAX)
+            slot = (slot + 1) & (size - 1);
+        index[slot] = i;
+    }
+
+    free(cache->index);
+    cache->index = index;
+    cache->indexSize = size;
+    return true;
+} // vsccCacheRebuildIndex
+
+/**
+ * @brief entry by key finding function
+ *
+ * @param[in] cache cache (non-null)
+ * @param[in] key   key to find entry of
+ *
+ * @return entry (NULL if there is no entry with such key)
+ */
+static VsccCacheEntry * vsccCacheFindEntry( VsccCacheImpl *cache, uint64_t key ) {
+    VsccCacheEntry *entries = (VsccCacheEntry *)vsccArrayData(cache->entries);
+
+    for (size_t slot = key & (cache->indexSize - 1); cache->index[slot] != SIZE_MAX; slot = (slot + 1) & (cache->indexSize - 1))
+        if (entries[cache->index[slot]].key == key)
+            return &entries[cache->index[slot]];
+    return NULL;
+} // vsccCacheFindEntry
+
+/**
+ * @brief cache file contents loading function
+ *
+ * @param[in,out] cache cache (non-null)
+ * @param[in]     data  file contents (non-null)
+ * @param[in]     size  file size
+ *
+ * @note invalid file contents are ignored, as cache may always be rebuilt
+ */
+static void vsccCacheParse( VsccCacheImpl *cache, const uint8_t *data, size_t size ) {
+    const size_t headerSize = 8 + sizeof(uint32_t) * 2 + sizeof(uint64_t);
+
+    if (size < headerSize || memcmp(data, VSCC_CACHE_MAGIC, 8) != 0)
+        return;
+
+    uint32_t version;
+    uint64_t count;
+
+    memcpy(&version, data + 8, sizeof(version));
+    memcpy(&count, data + 8 + sizeof(uint32_t) * 2, sizeof(count));
+    if (version != VSCC_CACHE_VERSION)
+        return;
+
+    size_t offset = headerSize;
+
+    for (uint64_t i = 0; i < count; i++) {
+        uint64_t key, entrySize;
+
+        if (size - offset < sizeof(uint64_t) * 2)
+            return;
+        memcpy(&key, data + offset, sizeof(key));
+        memcpy(&entrySize, data + offset + sizeof(uint64_t), sizeof(entrySize));
+        offset += sizeof(uint64_t) * 2;
+
+        if (size - offset < entrySize)
+            return;
+        if (!vsccCacheInsert(cache, key, data + offset, entrySize))
+            return;
+        offset += entrySize;
+    }
+} // vsccCacheParse
+
+VsccCache vsccCacheCtor( const char *path ) {
+    assert(path != NULL);
+
+    VsccCache cache = (VsccCache)calloc(1, sizeof(VsccCacheImpl));
+
+    if (cache == NULL)
+        return NULL;
+
+    const size_t pathLength = strlen(path);
+
+    cache->path = (char *)calloc(pathLength + 1, 1);
+    cache->entries = vsccArrayCtor(sizeof(VsccCacheEntry), NULL);
+
+    if (cache->path == NULL || cache->entries == NULL || !vsccCacheRebuildIndex(cache, 16)) {
+        vsccCacheDtor(cache);
+        return NULL;
+    }
+    memcpy(cache->path, path, pathLength);
+
+    FILE *file = fopen(path, "rb");
+
+    if (file == NULL)
+        return cache;
+
+    long size = -1;
+    uint8_t *data = NULL;
+
+    if (fseek(file, 0, SEEK_END) == 0)
+        size = ftell(file);
+    if (size > 0 && fseek(file, 0, SEEK_SET) == 0 && (data = (uint8_t *)malloc(size)) != NULL && fread(data, 1, size, file) == (size_t)size)
+        vsccCacheParse(cache, data, size);
+    free(data);
+    fclose(file);
+
+    // freshly loaded entries are neither used nor modified
+    VsccCacheEntry *entries = (VsccCacheEntry *)vsccArrayData(cache->entries);
+
+    for (size_t i = 0; i < vsccArraySize(cache->entries); i++)
+        entries[i].used = false;
+    cache->modified = false;
+
+    return cache;
+} // vsccCacheCtor
+
+void vsccCacheDtor( VsccCache cache ) {
+    if (cache == NULL)
+        return;
+
+    if (cache->entries != NULL)
+        for (size_t i = 0; i < vsccArraySize(cache->entries); i++)
+            free(((VsccCacheEntry *)vsccArrayData(cache->entries))[i].data);
+    vsccArrayDtor(cache->entries);
+    free(cache->index);
+    free(cache->path);
+    free(cache);
+} // vsccCacheDtor
+
+const void * vsccCacheFind( VsccCache cache, uint64_t key, size_t *size ) {
+    assert(cache != NULL);
+    assert(size != NULL);
+
+    VsccCacheEntry *entry = vsccCacheFindEntry(cache, key);
+
+    if (entry == NULL)
+        return NULL;
+
+    entry->used = true;
+    *size = entry->size;
+    return entry->data;
+} // vsccCacheFind
+
+bool vsccCacheInsert( VsccCache cache, uint64_t key, const void *data, size_t size ) {
+    assert(cache != NULL);
+    assert(data != NULL || size == 0);
+
+    void *copy = malloc(size + 1);
+
+    if (copy == NULL)
+        return false;
+    if (size != 0)
+        memcpy(copy, data, size);
+
+    VsccCacheEntry *entry = vsccCacheFindEntry(cache, key);
+
+    if (entry != NULL) {
+        free(entry->data);
+        entry->data = copy;
+        entry->size = size;
+        entry->used = true;
+        cache->modified = true;
+        return true;
+    }
+
+    // keep hash table at most half full
+    const size_t count = vsccArraySize(cache->entries);
+
+    if ((count + 1) * 2 > cache->indexSize && !vsccCacheRebuildIndex(cache, cache->indexSize * 2)) {
+        free(copy);
+        return false;
+    }
+
+    const VsccCacheEntry newEntry = {
+        .key  = key,
+        .data = copy,
+        .size = size,
+        .used = true,
+    };
+
+    if (!vsccArrayPush(&cache->entries, &newEntry)) {
+        free(copy);
+        return false;
+    }
+
+    size_t slot = key & (cache->indexSize - 1);
+
+    while (cache->index[slot] != SIZE_MAX)
+        slot = (slot + 1) & (cache->indexSize - 1);
+    cache->index[slot] = count;
+    cache->modified = true;
+
+    return true;
+} // vsccCacheInsert
+
+bool vsccCacheSave( VsccCache cache, bool prune ) {
+    assert(cache != NULL);
+
+    const VsccCacheEntry *entries = (const VsccCacheEntry *)vsccArrayData(cache->entries);
+    const size_t entryCount = vsccArraySize(cache->entries);
+    uint64_t count = 0;
+
+    for (size_t i = 0; i < entryCount; i++)
+        count += !prune || entries[i].used;
+
+    if (!cache->modified && count == entryCount)
+        return true;
+
+    // write to unique temporary file and rename it, so concurrent readers never see partially written cache
+    // and concurrent writers never write to the same file
+    const size_t pathLength = strlen(cache->path);
+    char *temporaryPath = (char *)calloc(pathLength + 8, 1);
+
+    if (temporaryPath == NULL)
+        return false;
+    memcpy(temporaryPath, cache->path, pathLength);
+    memcpy(temporaryPath + pathLength, ".XXXXXX", 7);
+
+    const int descriptor = mkstemp(temporaryPath);
+    FILE *file = NULL;
+
+    // mkstemp creates owner-only file, but cache is as readable as other files
+    if (descriptor != -1 && (fchmod(descriptor, 0644) != 0 || (file = fdopen(descriptor, "wb")) == NULL)) {
+        close(descriptor);
+        remove(temporaryPath);
+    }
+
+    bool saved = file != NULL;
+
+    if (saved) {
+        const uint32_t header[2] = { VSCC_CACHE_VERSION, 0 };
+
+        saved = true
+            && fwrite(VSCC_CACHE_MAGIC, 1, 8, file) == 8
+            && fwrite(header, sizeof(header), 1, file) == 1
+            && fwrite(&count, sizeof(count), 1, file) == 1
+        ;
+
+        for (size_t i = 0; saved && i < entryCount; i++) {
+            if (prune && !entries[i].used)
+                continue;
+
+            const uint64_t entryHeader[2] = { entries[i].key, entries[i].size };
+
+            saved = true
+                && fwrite(entryHeader, sizeof(entryHeader), 1, file) == 1
+                && (entries[i].size == 0 || fwrite(entries[i].data, entries[i].size, 1, file) == 1)
+            ;
+        }
+
+        saved = fclose(file) == 0 && saved;
+        saved = saved && rename(temporaryPath, cache->path) == 0;
+        if (!saved)
+            remove(temporaryPath);
+    }
+
+    free(temporaryPath);
+    cache->modified = cache->modified && !saved;
+    return saved;
+} // vsccCacheSave
+
+// vscc_cache.c
@@ -0,0 +1,966 @@
+/**
+ * @brief grammar-related functions implementation file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "vscc.h"
+
+VsccGrammar * vsccGrammarCtor( const VsccAllocator *allocator ) {
+    VsccGrammar *grammar = (VsccGrammar *)vsccAllocateZeroed(allocator, 1, sizeof(VsccGrammar));
+
+    if (grammar != NULL)
+        grammar->allocator = allocator;
+    return grammar;
+} // vsccGrammarCtor
+
+/**
+ * @brief grammar link results resetting function
+ *
+ * @param[in,out] grammar grammar to unlink (non-null)
+ */
+static void vsccGrammarUnlink( VsccGrammar *grammar ) {
+    vsccDeallocate(grammar->allocator, grammar->terminals);
+    for (size_t i = 0; i < grammar->automatonCount; i++)
+        vsccNfaDtor(grammar->automata[i]);
+    vsccDeallocate(grammar->allocator, grammar->automata);
+
+    grammar->linked = false;
+    grammar->terminals = NULL;
+    grammar->terminalCount = 0;
+    grammar->automata = NULL;
+    grammar->automatonCount = 0;
+} // vsccGrammarUnlink
+
+void vsccGrammarDtor( VsccGrammar *grammar ) {
+    if (grammar == NULL)
+        return;
+
+    vsccGrammarUnlink(grammar);
+
+    for (size_t i = 0; i < grammar->ruleCount; i++) {
+        vsccDeallocate(grammar->allocator, (char *)grammar->rules[i].name);
+        vsccRuleDtor(grammar->rules[i].rule);
+    }
+    vsccDeallocate(grammar->allocator, grammar->rules);
+    vsccDeallocate(grammar->allocator, grammar);
+} // vsccGrammarDtor
+
+bool vsccGrammarAddRule( VsccGrammar *grammar, const char *name, VsccRule *rule ) {
+    assert(grammar != NULL);
+    assert(name != NULL);
+
+    if (rule == NULL)
+        return false;
+
+    const size_t nameLength = strlen(name);
+    char *nameCopy = (char *)vsccAllocateZeroed(grammar->allocator, nameLength + 1, 1);
+    VsccGrammarPair *newRules = (VsccGrammarPair *)vsccReallocate(grammar->allocator, grammar->rules, sizeof(VsccGrammarPair) * (grammar->ruleCount + 1));
+
+    if (newRules != NULL)
+        grammar->rules = newRules;
+
+    if (nameCopy == NULL || newRules == NULL) {
+        vsccDeallocate(grammar->allocator, nameCopy);
+        vsccRuleDtor(rule);
+        return false;
+    }
+    memcpy(nameCopy, name, nameLength);
+
+    vsccGrammarUnlink(grammar);
+
+    grammar->rules[grammar->ruleCount++] = (VsccGrammarPair) {
+        .name          = nameCopy,
+        .rule          = rule,
+        .recover       = false,
+        .action        = NULL,
+        .actionContext = NULL,
+        .token         = VSCC_TOKEN_NONE,
+        .memoize       = false,
+    };
+
+    return true;
+} // vsccGrammarAddRule
+
+size_t vsccGrammarFindRule( const VsccGrammar *grammar, const char *name ) {
+    assert(grammar != NULL);
+    assert(name != NULL);
+
+    for (size_t i = 0; i < grammar->ruleCount; i++)
+        if (strcmp(grammar->rules[i].name, name) == 0)
+            return i;
+    return grammar->ruleCount;
+} // vsccGrammarFindRule
+
+bool vsccGrammarSetRecover( VsccGrammar *grammar, const char *name, bool recover ) {
+    const size_t index = vsccGrammarFindRule(grammar, name);
+
+    if (index == grammar->ruleCount)
+        return false;
+    grammar->rules[index].recover = recover;
+    return true;
+} // vsccGrammarSetRecover
+
+bool vsccGrammarSetAction( VsccGrammar *grammar, const char *name, VsccRuleAction action, void *context ) {
+    const size_t index = vsccGrammarFindRule(grammar, name);
+
+    if (index == grammar->ruleCount)
+        return false;
+    grammar->rules[index].action = action;
+    grammar->rules[index].actionContext = context;
+    return true;
+} // vsccGrammarSetAction
+
+bool vsccGrammarSetToken( VsccGrammar *grammar, const char *name, VsccTokenMode mode ) {
+    const size_t index = vsccGrammarFindRule(grammar, name);
+
+    if (index == grammar->ruleCount)
+        return false;
+    grammar->rules[index].token = mode;
+    return true;
+} // vsccGrammarSetToken
+
+void vsccGrammarSetCache( VsccGrammar *grammar, VsccCache cache ) {
+    assert(grammar != NULL);
+
+    grammar->cache = cache;
+} // vsccGrammarSetCache
+
+uint64_t vsccGrammarPairHash( const VsccGrammarPair *pair ) {
+    assert(pair != NULL);
+
+    const uint32_t settings[2] = { pair->recover, (uint32_t)pair->token };
+    uint64_t hash = vsccHashBytes(VSCC_HASH_INITIAL, pair->name, strlen(pair->name) + 1);
+
+    hash = vsccHashBytes(hash, &pair->rule->hash, sizeof(uint64_t));
+    return vsccHashBytes(hash, settings, sizeof(settings));
+} // vsccGrammarPairHash
+
+/**
+ * @brief rule references collecting function
+ *
+ * @param[in]     rule    rule to collect references of (non-null, linked)
+ * @param[in,out] visited rule visit flags (non-null)
+ * @param[in,out] pending indices of visited rules that are not scanned yet (non-null)
+ *
+ * @return true if collected, false if allocation failed
+ */
+static bool vsccGrammarCollectReferences( const VsccRule *rule, bool *visited, VsccArray *pending ) {
+    switch (rule->type) {
+    case VSCC_RULE_SEQUENCE:
+        for (size_t i = 0; i < rule->sequence.count; i++)
+            if (!vsccGrammarCollectReferences(rule->sequence.rules[i], visited, pending))
+                return false;
+        return true;
+
+    case VSCC_RULE_VARIANT:
+        for (size_t i = 0; i < rule->variant.count; i++)
+            if (!vsccGrammarCollectReferences(rule->variant.rules[i], visited, pending))
+                return false;
+        return true;
+
+    case VSCC_RULE_OPTIONAL:
+        return vsccGrammarCollectReferences(rule->optional, visited, pending);
+
+    case VSCC_RULE_REPEAT:
+        return vsccGrammarCollectReferences(rule->repeat.rule, visited, pending);
+
+    case VSCC_RULE_REFERENCE:
+        if (visited[rule->reference.index])
+            return true;
+        visited[rule->reference.index] = true;
+        return vsccArrayPush(pending, &rule->reference.index);
+
+    default:
+        return true;
+    }
+} // vsccGrammarCollectReferences
+
+bool vsccGrammarClosureHash( const VsccGrammar *grammar, size_t index, uint64_t *hash ) {
+    assert(grammar != NULL);
+    assert(grammar->linked);
+    assert(index < grammar->ruleCount);
+    assert(hash != NULL);
+
+    bool *visited = (bool *)vsccAllocateZeroed(grammar->allocator, grammar->ruleCount, sizeof(bool));
+    VsccArray pending = vsccArrayCtor(sizeof(size_t), grammar->allocator);
+    bool computed = visited != NULL && pending != NULL;
+
+    // dependencies are combined by sum, so their traversal order doesn't matter
+    uint64_t dependencies = 0;
+
+    if (computed) {
+        visited[index] = true;
+        computed = vsccGrammarCollectReferences(grammar->rules[index].rule, visited, &pending);
+    }
+
+    while (computed && vsccArraySize(pending) != 0) {
+        size_t dependency;
+
+        vsccArrayPop(&pending, &dependency);
+        if (dependency != index)
+            dependencies += vsccGrammarPairHash(&grammar->rules[dependency]);
+        computed = vsccGrammarCollectReferences(grammar->rules[dependency].rule, visited, &pending);
+    }
+
+    if (computed)
+        *hash = vsccHashBytes(vsccGrammarPairHash(&grammar->rules[index]), &dependencies, sizeof(dependencies));
+
+    vsccArrayDtor(pending);
+    vsccDeallocate(grammar->allocator, visited);
+
+    return computed;
+} // vsccGrammarClosureHash
+
+/**
+ * @brief terminal rule equality checking function
+ *
+ * @param[in] lhs first terminal (non-null)
+ * @param[in] rhs second terminal (non-null)
+ *
+ * @return true if terminals match exactly same strings, false otherwise
+ */
+static bool vsccGrammarTerminalsEqual( const VsccRule *lhs, const VsccRule *rhs ) {
+    if (lhs->type != rhs->type)
+        return false;
+
+    switch (lhs->type) {
+    case VSCC_RULE_STRING_TERMINAL:
+        return true
+            && lhs->stringTerminal.length == rhs->stringTerminal.length
+            && memcmp(lhs->stringTerminal.string, rhs->stringTerminal.string, lhs->stringTerminal.length) == 0
+        ;
+
+    case VSCC_RULE_CHAR_TERMINAL:
+        return true
+            && lhs->charTerminal.count == rhs->charTerminal.count
+            && memcmp(lhs->charTerminal.ranges, rhs->charTerminal.ranges, lhs->charTerminal.count * sizeof(VsccRuleCharRange)) == 0
+        ;
+
+    case VSCC_RULE_END:
+        return true;
+
+    default:
+        assert(false && "Non-terminal rule passed.");
+        return false;
+    }
+} // vsccGrammarTerminalsEqual
+
+/// @brief grammar linking state
+typedef struct __VsccGrammarLinker {
+    VsccGrammar * grammar;           ///< grammar to link
+    VsccArray     terminals;         ///< distinct terminals (const VsccRule *)
+    VsccArray     automata;          ///< terminal alternation automata (VsccNfa)
+    size_t      * ruleIndex;         ///< rule index by name hash table (SIZE_MAX if slot is empty)
+    size_t        ruleIndexSize;     ///< rule hash table size (power of 2)
+    size_t      * terminalIndex;     ///< terminal id by structural hash table (SIZE_MAX if slot is empty)
+    size_t        terminalIndexSize; ///< terminal hash table size (power of 2)
+} VsccGrammarLinker;
+
+/**
+ * @brief hash table allocating function
+ *
+ * @param[in]  allocator    table allocator (nullable)
+ * @param[in]  minimalCount minimal count of elements table should fit in
+ * @param[out] size         table size destination (non-null)
+ *
+ * @return allocated table with all slots empty (NULL if allocation failed)
+ */
+static size_t * vsccGrammarIndexCtor( const VsccAllocator *allocator, size_t minimalCount, size_t *size ) {
+    // tables are kept at most half full
+    *size = 16;
+    while (*size < minimalCount * 2)
+        *size *= 2;
+
+    size_t *index = (size_t *)vsccAllocate(allocator, *size * sizeof(size_t));
+
+    if (index != NULL)
+        memset(index, 0xFF, *size * sizeof(size_t));
+    return index;
+} // vsccGrammarIndexCtor
+
+/**
+ * @brief name hashing function
+ *
+ * @param[in] name name to hash (non-null)
+ *
+ * @return name hash
+ */
+static uint64_t vsccGrammarHashName( const char *name ) {
+    return vsccHashBytes(VSCC_HASH_INITIAL, name, strlen(name));
+} // vsccGrammarHashName
+
+/**
+ * @brief terminal id by terminal finding function
+ *
+ * @param[in,out] linker linker (non-null)
+ * @param[in,out] rule   terminal to assign id to (non-null)
+ *
+ * @return true if id assigned, false if allocation failed
+ */
+static bool vsccGrammarLinkTerminal( VsccGrammarLinker *linker, VsccRule *rule ) {
+    const VsccRule **known = (const VsccRule **)vsccArrayData(linker->terminals);
+    size_t mask = linker->terminalIndexSize - 1;
+    size_t slot = rule->hash & mask;
+
+    for (; linker->terminalIndex[slot] != SIZE_MAX; slot = (slot + 1) & mask)
+        if (vsccGrammarTerminalsEqual(known[linker->terminalIndex[slot]], rule)) {
+            rule->id = linker->terminalIndex[slot];
+            return true;
+        }
+
+    const size_t count = vsccArraySize(linker->terminals);
+
+    if (!vsccArrayPush(&linker->terminals, &rule))
+        return false;
+    rule->id = count;
+
+    if ((count + 1) * 2 <= linker->terminalIndexSize) {
+        linker->terminalIndex[slot] = count;
+        return true;
+    }
+
+    // grow table and reinsert all terminals
+    size_t size;
+    size_t *index = vsccGrammarIndexCtor(linker->grammar->allocator, count + 1, &size);
+
+    if (index == NULL)
+        return false;
+    known = (const VsccRule **)vsccArrayData(linker->terminals);
+    mask = size - 1;
+
+    for (size_t i = 0; i <= count; i++) {
+        for (slot = known[i]->hash & mask; index[slot] != SIZE_MAX; slot = (slot + 1) & mask)
+            ;
+        index[slot] = i;
+    }
+
+    vsccDeallocate(linker->grammar->allocator, linker->terminalIndex);
+    linker->terminalIndex = index;
+    linker->terminalIndexSize = size;
+
+    return true;
+} // vsccGrammarLinkTerminal
+
+/**
+ * @brief rule linking function
+ *
+ * @param[in,out] linker linker (non-null)
+ * @param[in,out] rule   rule to link (non-null)
+ *
+ * @return true if linked, false otherwise
+ */
+static bool vsccGrammarLinkRule( VsccGrammarLinker *linker, VsccRule *rule ) {
+    switch (rule->type) {
+    case VSCC_RULE_SEQUENCE:
+        for (size_t i = 0; i < rule->sequence.count; i++)
+            if (!vsccGrammarLinkRule(linker, rule->sequence.rules[i]))
+                return false;
+        return true;
+
+    case VSCC_RULE_VARIANT: {
+        for (size_t i = 0; i < rule->variant.count; i++)
+            if (!vsccGrammarLinkRule(linker, rule->variant.rules[i]))
+                return false;
+
+        // NULL means that variant is not a large terminal alternation, so allocation failure is just ignored here
+        VsccNfa nfa = vsccNfaCtor(rule, linker->grammar->cache, linker->grammar->allocator);
+
+        rule->variant.automaton = SIZE_MAX;
+        if (nfa == NULL)
+            return true;
+
+        if (!vsccArrayPush(&linker->automata, &nfa)) {
+            vsccNfaDtor(nfa);
+            return false;
+        }
+        rule->variant.automaton = vsccArraySize(linker->automata) - 1;
+        return true;
+    }
+
+    case VSCC_RULE_OPTIONAL:
+        return vsccGrammarLinkRule(linker, rule->optional);
+
+    case VSCC_RULE_REPEAT:
+        return vsccGrammarLinkRule(linker, rule->repeat.rule);
+
+    case VSCC_RULE_REFERENCE: {
+        const VsccGrammarPair *rules = linker->grammar->rules;
+        const size_t mask = linker->ruleIndexSize - 1;
+
+        // first rule with same name is found first, as in vsccGrammarFindRule
+        for (size_t slot = vsccGrammarHashName(rule->reference.name) & mask; linker->ruleIndex[slot] != SIZE_MAX; slot = (slot + 1) & mask)
+            if (strcmp(rules[linker->ruleIndex[slot]].name, rule->reference.name) == 0) {
+                rule->reference.index = linker->ruleIndex[slot];
+                return true;
+            }
+        return false;
+    }
+
+    case VSCC_RULE_STRING_TERMINAL:
+    case VSCC_RULE_CHAR_TERMINAL:
+    case VSCC_RULE_END:
+        return vsccGrammarLinkTerminal(linker, rule);
+
+    case VSCC_RULE_EMPTY:
+        return true;
+    }
+
+    assert(false && "Unreachable case reached.");
+    return false;
+} // vsccGrammarLinkRule
+
+/// @brief depth of references followed to find rules invoked by rule
+#define VSCC_GRAMMAR_INVOCATION_DEPTH 4
+
+/// @brief polynomial base of input prefix hashes
+#define VSCC_GRAMMAR_PREFIX_BASE ((uint64_t)0x9E3779B97F4A7C15)
+
+/// @brief input prefix (sequence of rules matched before some point)
+typedef struct __VsccGrammarPrefix {
+    uint64_t hash;  ///< polynomial hash of prefix rule structural hashes
+    uint64_t scale; ///< VSCC_GRAMMAR_PREFIX_BASE in power of prefix length
+} VsccGrammarPrefix;
+
+/// @brief empty input prefix
+#define VSCC_GRAMMAR_PREFIX_EMPTY ((VsccGrammarPrefix) { .hash = 0, .scale = 1 })
+
+/**
+ * @brief prefix extending function
+ *
+ * @param[in] prefix prefix to extend
+ * @param[in] hash   structural hash of rule matched after prefix
+ *
+ * @return extended prefix
+ */
+static inline VsccGrammarPrefix vsccGrammarPrefixAppend( VsccGrammarPrefix prefix, uint64_t hash ) {
+    return (VsccGrammarPrefix) {
+        .hash  = prefix.hash * VSCC_GRAMMAR_PREFIX_BASE + hash,
+        .scale = prefix.scale * VSCC_GRAMMAR_PREFIX_BASE,
+    };
+} // vsccGrammarPrefixAppend
+
+/**
+ * @brief prefix concatenating function
+ *
+ * @param[in] head first prefix
+ * @param[in] tail prefix matched after the first one
+ *
+ * @note hash is polynomial, so prefix of referenced rule body is concatenated to prefix of reference
+ *       without traversing body again, and the result is same as if body was inlined
+ *
+ * @return concatenation of prefixes
+ */
+static inline VsccGrammarPrefix vsccGrammarPrefixConcat( VsccGrammarPrefix head, VsccGrammarPrefix tail ) {
+    return (VsccGrammarPrefix) {
+        .hash  = head.hash * tail.scale + tail.hash,
+        .scale = head.scale * tail.scale,
+    };
+} // vsccGrammarPrefixConcat
+
+/// @brief rule invocation
+typedef struct __VsccGrammarInvocation {
+    VsccGrammarPrefix prefix; ///< sequence elements matched before invocation
+    size_t            index;  ///< invoked rule index
+    size_t            branch; ///< index of branch invocation is made from
+} VsccGrammarInvocation;
+
+/// @brief memoized rules selecting state
+typedef struct __VsccGrammarSelector {
+    VsccGrammar * grammar;     ///< grammar (with references resolved)
+    VsccArray   * summaries;   ///< invocations made by rule bodies by rule index and depth (VsccGrammarInvocation, NULL if not computed yet)
+    VsccArray     invocations; ///< invocation buffer (VsccGrammarInvocation)
+    VsccArray     retried;     ///< retried invocation buffer (VsccGrammarInvocation)
+    size_t      * table;       ///< invocation hash table buffer (invocation indices, SIZE_MAX if slot is empty)
+    size_t        tableSize;   ///< invocation hash table buffer size
+} VsccGrammarSelector;
+
+/**
+ * @brief invocation comparator
+ *
+ * @param[in] lhs first invocation (non-null)
+ * @param[in] rhs second invocation (non-null)
+ *
+ * @return comparison result, invocations are ordered by prefix, rule index and branch
+ */
+static int vsccGrammarInvocationCompare( const void *lhs, const void *rhs ) {
+    const VsccGrammarInvocation *l = (const VsccGrammarInvocation *)lhs;
+    const VsccGrammarInvocation *r = (const VsccGrammarInvocation *)rhs;
+
+    if (l->prefix.hash != r->prefix.hash)
+        return l->prefix.hash < r->prefix.hash ? -1 : 1;
+    if (l->prefix.scale != r->prefix.scale)
+        return l->prefix.scale < r->prefix.scale ? -1 : 1;
+    if (l->index != r->index)
+        return l->index < r->index ? -1 : 1;
+    return (l->branch > r->branch) - (l->branch < r->branch);
+} // vsccGrammarInvocationCompare
+
+/**
+ * @brief covered invocation checking function
+ *
+ * @param[in] covered sorted invocations without branch (nullable)
+ * @param[in] prefix  invocation prefix
+ * @param[in] index   invoked rule index
+ *
+ * @return true if invocation is covered
+ */
+static bool vsccGrammarIsCovered( VsccArray covered, VsccGrammarPrefix prefix, size_t index ) {
+    // covered invocations are stored without branch
+    const VsccGrammarInvocation key = {
+        .prefix = prefix,
+        .index  = index,
+        .branch = 0,
+    };
+
+    return covered != NULL && bsearch(&key, vsccArrayData(covered), vsccArraySize(covered), sizeof(VsccGrammarInvocation), vsccGrammarInvocationCompare) != NULL;
+} // vsccGrammarIsCovered
+
+static bool vsccGrammarCollectInvocations( VsccGrammarSelector *self, const VsccRule *rule, VsccGrammarPrefix prefix, size_t branch, size_t depth, VsccArray covered, VsccArray *invocations );
+
+/**
+ * @brief sequence elements invocations collecting function
+ *
+ * @param[in,out] self        selector (non-null)
+ * @param[in]     rules       sequence elements (non-null if count != 0)
+ * @param[in]     count       count of sequence elements
+ * @param[in]     prefix      input prefix matched before sequence
+ * @param[in]     branch      branch index to mark invocations with
+ * @param[in]     depth       count of references to follow
+ * @param[in]     covered     sorted invocations that are not followed (nullable)
+ * @param[in,out] invocations invocation array (non-null)
+ *
+ * @return true if collected, false if allocation failed
+ */
+static bool vsccGrammarCollectSequenceInvocations( VsccGrammarSelector *self, VsccRule *const *rules, size_t count, VsccGrammarPrefix prefix, size_t branch, size_t depth, VsccArray covered, VsccArray *invocations ) {
+    for (size_t i = 0; i < count; i++) {
+        if (!vsccGrammarCollectInvocations(self, rules[i], prefix, branch, depth, covered, invocations))
+            return false;
+        prefix = vsccGrammarPrefixAppend(prefix, rules[i]->hash);
+    }
+    return true;
+} // vsccGrammarCollectSequenceInvocations
+
+/**
+ * @brief sorted invocations deduplicating function
+ *
+ * @param[in,out] invocations invocations (non-null, sorted)
+ */
+static void vsccGrammarUniqueInvocations( VsccArray invocations ) {
+    VsccGrammarInvocation *data = (VsccGrammarInvocation *)vsccArrayData(invocations);
+    const size_t count = vsccArraySize(invocations);
+    size_t uniqueCount = 0;
+
+    for (size_t i = 0; i < count; i++)
+        if (uniqueCount == 0 || vsccGrammarInvocationCompare(&data[uniqueCount - 1], &data[i]) != 0)
+            data[uniqueCount++] = data[i];
+
+    vsccArrayTruncate(invocations, uniqueCount);
+} // vsccGrammarUniqueInvocations
+
+/**
+ * @brief rule body invocation summary getting function
+ *
+ * @param[in,out] self  selector (non-null)
+ * @param[in]     index rule index
+ * @param[in]     depth count of references to follow (< VSCC_GRAMMAR_INVOCATION_DEPTH)
+ *
+ * @note summary is the set of invocations body makes relative to body start, it's computed once
+ *       per rule and depth and reused by all invocations of the rule
+ *
+ * @return summary (sorted, branch is 0, NULL if allocation failed)
+ */
+static VsccArray vsccGrammarInvocationSummary( VsccGrammarSelector *self, size_t index, size_t depth ) {
+    assert(depth < VSCC_GRAMMAR_INVOCATION_DEPTH);
+
+    VsccArray *summary = &self->summaries[index * VSCC_GRAMMAR_INVOCATION_DEPTH + depth];
+
+    if (*summary != NULL)
+        return *summary;
+
+    VsccArray invocations = vsccArrayCtor(sizeof(VsccGrammarInvocation), self->grammar->allocator);
+
+    // summaries of depth - 1 are completed before this one, so references never cycle here
+    if (invocations == NULL || !vsccGrammarCollectInvocations(self, self->grammar->rules[index].rule, VSCC_GRAMMAR_PREFIX_EMPTY, 0, depth, NULL, &invocations)) {
+        vsccArrayDtor(invocations);
+        return NULL;
+    }
+
+    qsort(vsccArrayData(invocations), vsccArraySize(invocations), sizeof(VsccGrammarInvocation), vsccGrammarInvocationCompare);
+    vsccGrammarUniqueInvocations(invocations);
+
+    *summary = invocations;
+    return invocations;
+} // vsccGrammarInvocationSummary
+
+/**
+ * @brief reference invocations collecting function
+ *
+ * @param[in,out] self        selector (non-null)
+ * @param[in]     index       referenced rule index
+ * @param[in]     prefix      input prefix matched before reference
+ * @param[in]     branch      branch index to mark invocations with
+ * @param[in]     depth       count of references to follow
+ * @param[in]     covered     sorted invocations that are not followed (nullable)
+ * @param[in,out] invocations invocation array (non-null)
+ *
+ * @return true if collected, false if allocation failed
+ */
+static bool vsccGrammarCollectReferenceInvocations( VsccGrammarSelector *self, size_t index, VsccGrammarPrefix prefix, size_t branch, size_t depth, VsccArray covered, VsccArray *invocations ) {
+    const VsccGrammarInvocation invocation = {
+        .prefix = prefix,
+        .index  = index,
+        .branch = branch,
+    };
+
+    if (!vsccArrayPush(invocations, &invocation))
+        return false;
+
+    // invocations inside memoized invocation are never retried
+    if (depth == 0 || vsccGrammarIsCovered(covered, prefix, index))
+        return true;
+
+    const VsccArray summary = vsccGrammarInvocationSummary(self, index, depth - 1);
+
+    if (summary == NULL)
+        return false;
+
+    const VsccGrammarInvocation *inner = (const VsccGrammarInvocation *)vsccArrayData(summary);
+    const size_t innerCount = vsccArraySize(summary);
+
+    // summary can't be cut at covered invocations it contains, so body is traversed then
+    for (size_t i = 0; covered != NULL && i < innerCount; i++)
+        if (vsccGrammarIsCovered(covered, vsccGrammarPrefixConcat(prefix, inner[i].prefix), inner[i].index))
+            return vsccGrammarCollectInvocations(self, self->grammar->rules[index].rule, prefix, branch, depth - 1, covered, invocations);
+
+    for (size_t i = 0; i < innerCount; i++) {
+        const VsccGrammarInvocation shifted = {
+            .prefix = vsccGrammarPrefixConcat(prefix, inner[i].prefix),
+            .index  = inner[i].index,
+            .branch = branch,
+        };
+
+        if (!vsccArrayPush(invocations, &shifted))
+            return false;
+    }
+    return true;
+} // vsccGrammarCollectReferenceInvocations
+
+/**
+ * @brief rule invocations collecting function
+ *
+ * @param[in,out] self        selector (non-null)
+ * @param[in]     rule        rule to collect invocations of (non-null)
+ * @param[in]     prefix      input prefix matched before rule
+ * @param[in]     branch      branch index to mark invocations with
+ * @param[in]     depth       count of references to follow
+ * @param[in]     covered     sorted invocations that are not followed (nullable)
+ * @param[in,out] invocations invocation array (non-null)
+ *
+ * @note matching is deterministic, so invocations with same prefix from same offset happen at same offset
+ *
+ * @return true if collected, false if allocation failed
+ */
+static bool vsccGrammarCollectInvocations( VsccGrammarSelector *self, const VsccRule *rule, VsccGrammarPrefix prefix, size_t branch, size_t depth, VsccArray covered, VsccArray *invocations ) {
+    switch (rule->type) {
+    case VSCC_RULE_SEQUENCE:
+        return vsccGrammarCollectSequenceInvocations(self, rule->sequence.rules, rule->sequence.count, prefix, branch, depth, covered, invocations);
+
+    case VSCC_RULE_VARIANT:
+        for (size_t i = 0; i < rule->variant.count; i++)
+            if (!vsccGrammarCollectInvocations(self, rule->variant.rules[i], prefix, branch, depth, covered, invocations))
+                return false;
+        return true;
+
+    // only first iteration starts at known offset
+
+    case VSCC_RULE_OPTIONAL:
+        return vsccGrammarCollectInvocations(self, rule->optional, prefix, branch, depth, covered, invocations);
+
+    case VSCC_RULE_REPEAT:
+        return vsccGrammarCollectInvocations(self, rule->repeat.rule, prefix, branch, depth, covered, invocations);
+
+    case VSCC_RULE_REFERENCE:
+        return vsccGrammarCollectReferenceInvocations(self, rule->reference.index, prefix, branch, depth, covered, invocations);
+
+    default:
+        return true;
+    }
+} // vsccGrammarCollectInvocations
+
+/**
+ * @brief choice point branch invocations collecting function
+ *
+ * @param[in,out] self        selector (non-null)
+ * @param[in]     rule        variant or sequence (non-null)
+ * @param[in]     element     index of optional or repeat element (sequence only)
+ * @param[in]     covered     sorted invocations that are not followed (nullable)
+ * @param[in,out] invocations invocation array (non-null)
+ *
+ * @note branches are variant alternatives or sequence element body and sequence rest (that is
+ *       matched from offset failed element body started at)
+ *
+ * @return true if collected, false if allocation failed
+ */
+static bool vsccGrammarCollectBranches( VsccGrammarSelector *self, const VsccRule *rule, size_t element, VsccArray covered, VsccArray *invocations ) {
+    if (rule->type == VSCC_RULE_VARIANT) {
+        for (size_t i = 0; i < rule->variant.count; i++)
+            if (!vsccGrammarCollectInvocations(self, rule->variant.rules[i], VSCC_GRAMMAR_PREFIX_EMPTY, i, VSCC_GRAMMAR_INVOCATION_DEPTH, covered, invocations))
+                return false;
+        return true;
+    }
+
+    const VsccRule *optional = rule->sequence.rules[element];
+    const VsccRule *body = optional->type == VSCC_RULE_OPTIONAL
+        ? optional->optional
+        : optional->repeat.rule
+    ;
+
+    return true
+        && vsccGrammarCollectInvocations(self, body, VSCC_GRAMMAR_PREFIX_EMPTY, 0, VSCC_GRAMMAR_INVOCATION_DEPTH, covered, invocations)
+        && vsccGrammarCollectSequenceInvocations(self, rule->sequence.rules + element + 1, rule->sequence.count - element - 1, VSCC_GRAMMAR_PREFIX_EMPTY, 1, VSCC_GRAMMAR_INVOCATION_DEPTH, covered, invocations)
+    ;
+} // vsccGrammarCollectBranches
+
+/**
+ * @brief same invocation checking function
+ *
+ * @param[in] lhs first invocation (non-null)
+ * @param[in] rhs second invocation (non-null)
+ *
+ * @return true if invocations invoke same rule after same prefix (branches are ignored)
+ */
+static inline bool vsccGrammarSameInvocation( const VsccGrammarInvocation *lhs, const VsccGrammarInvocation *rhs ) {
+    return true
+        && lhs->prefix.hash == rhs->prefix.hash
+        && lhs->prefix.scale == rhs->prefix.scale
+        && lhs->index == rhs->index
+    ;
+} // vsccGrammarSameInvocation
+
+/**
+ * @brief retried invocations finding function
+ *
+ * @param[in,out] self        selector (non-null)
+ * @param[in,out] invocations collected invocations (non-null)
+ *
+ * @note only invocations made from several branches are kept (sorted, branch is 0), as they are retried at
+ *       same offset if first branch fails. Invocations are grouped by hash table, so cost is linear in their count.
+ *
+ * @return true if found, false if allocation failed
+ */
+static bool vsccGrammarFindRetried( VsccGrammarSelector *self, VsccArray invocations ) {
+    VsccGrammarInvocation *data = (VsccGrammarInvocation *)vsccArrayData(invocations);
+    const size_t count = vsccArraySize(invocations);
+    size_t tableSize = 16;
+
+    // table is kept at most half full
+    while (tableSize < count * 2)
+        tableSize *= 2;
+
+    if (tableSize > self->tableSize) {
+        size_t *table = (size_t *)vsccReallocate(self->grammar->allocator, self->table, tableSize * sizeof(size_t));
+
+        if (table == NULL)
+            return false;
+        self->table = table;
+        self->tableSize = tableSize;
+    }
+    memset(self->table, 0xFF, tableSize * sizeof(size_t));
+
+    // first occurrence of invocation made from several branches is marked by SIZE_MAX branch
+    for (size_t i = 0; i < count; i++) {
+        uint64_t hash = data[i].prefix.hash ^ data[i].prefix.scale * 0xFF51AFD7ED558CCD ^ data[i].index * 0xC4CEB9FE1A85EC53;
+        size_t slot;
+
+        hash ^= hash >> 32;
+        slot = (size_t)hash & (tableSize - 1);
+
+        while (self->table[slot] != SIZE_MAX && !vsccGrammarSameInvocation(&data[self->table[slot]], &data[i]))
+            slot = (slot + 1) & (tableSize - 1);
+
+        if (self->table[slot] == SIZE_MAX)
+            self->table[slot] = i;
+        else if (data[self->table[slot]].branch != data[i].branch)
+            data[self->table[slot]].branch = SIZE_MAX;
+    }
+
+    size_t retriedCount = 0;
+
+    for (size_t i = 0; i < count; i++)
+        if (data[i].branch == SIZE_MAX)
+            data[retriedCount++] = (VsccGrammarInvocation) { .prefix = data[i].prefix, .index = data[i].index, .branch = 0 };
+
+    vsccArrayTruncate(invocations, retriedCount);
+    qsort(data, retriedCount, sizeof(VsccGrammarInvocation), vsccGrammarInvocationCompare);
+    return true;
+} // vsccGrammarFindRetried
+
+/**
+ * @brief choice point memoized rules selecting function
+ *
+ * @param[in,out] self    selector (non-null, buffers are empty)
+ * @param[in]     rule    variant or sequence (non-null)
+ * @param[in]     element index of optional or repeat element (sequence only)
+ *
+ * @note only outermost retried invocations are memoized, inner ones are covered by them
+ *
+ * @return true if selected, false if allocation failed
+ */
+static bool vsccGrammarSelectChoice( VsccGrammarSelector *self, const VsccRule *rule, size_t element ) {
+    if (!vsccGrammarCollectBranches(self, rule, element, NULL, &self->retried) || !vsccGrammarFindRetried(self, self->retried))
+        return false;
+
+    if (vsccArraySize(self->retried) == 0)
+        return true;
+
+    if (!vsccGrammarCollectBranches(self, rule, element, self->retried, &self->invocations) || !vsccGrammarFindRetried(self, self->invocations))
+        return false;
+
+    const VsccGrammarInvocation *selected = (const VsccGrammarInvocation *)vsccArrayData(self->invocations);
+
+    for (size_t i = 0; i < vsccArraySize(self->invocations); i++)
+        self->grammar->rules[selected[i].index].memoize = true;
+
+    vsccArrayTruncate(self->invocations, 0);
+    vsccArrayTruncate(self->retried, 0);
+    return true;
+} // vsccGrammarSelectChoice
+
+/**
+ * @brief memoized rules selecting function
+ *
+ * @param[in,out] self selector (non-null, buffers are empty)
+ * @param[in]     rule rule to scan choice points of (non-null)
+ *
+ * @note rules retried at same offset after alternative or optional part fails are memoized
+ *
+ * @return true if scanned, false if allocation failed
+ */
+static bool vsccGrammarSelectMemoized( VsccGrammarSelector *self, const VsccRule *rule ) {
+    switch (rule->type) {
+    case VSCC_RULE_SEQUENCE:
+        for (size_t i = 0; i < rule->sequence.count; i++) {
+            const VsccRule *element = rule->sequence.rules[i];
+
+            if (!vsccGrammarSelectMemoized(self, element))
+                return false;
+            if ((element->type == VSCC_RULE_OPTIONAL || element->type == VSCC_RULE_REPEAT) && !vsccGrammarSelectChoice(self, rule, i))
+                return false;
+        }
+        return true;
+
+    case VSCC_RULE_VARIANT:
+        for (size_t i = 0; i < rule->variant.count; i++)
+            if (!vsccGrammarSelectMemoized(self, rule->variant.rules[i]))
+                return false;
+        return vsccGrammarSelectChoice(self, rule, 0);
+
+    case VSCC_RULE_OPTIONAL:
+        return vsccGrammarSelectMemoized(self, rule->optional);
+
+    case VSCC_RULE_REPEAT:
+        return vsccGrammarSelectMemoized(self, rule->repeat.rule);
+
+    default:
+        return true;
+    }
+} // vsccGrammarSelectMemoized
+
+bool vsccGrammarLink( VsccGrammar *grammar ) {
+    assert(grammar != NULL);
+
+    vsccGrammarUnlink(grammar);
+
+    VsccGrammarLinker linker = {
+        .grammar           = grammar,
+        .terminals         = vsccArrayCtor(sizeof(const VsccRule *), grammar->allocator),
+        .automata          = vsccArrayCtor(sizeof(VsccNfa), grammar->allocator),
+        .ruleIndex         = NULL,
+        .ruleIndexSize     = 0,
+        .terminalIndex     = NULL,
+        .terminalIndexSize = 0,
+    };
+    linker.ruleIndex = vsccGrammarIndexCtor(grammar->allocator, grammar->ruleCount, &linker.ruleIndexSize);
+    linker.terminalIndex = vsccGrammarIndexCtor(grammar->allocator, 0, &linker.terminalIndexSize);
+
+    bool linked = true
+        && linker.terminals != NULL
+        && linker.automata != NULL
+        && linker.ruleIndex != NULL
+        && linker.terminalIndex != NULL
+    ;
+
+    for (size_t i = 0; linked && i < grammar->ruleCount; i++) {
+        const size_t mask = linker.ruleIndexSize - 1;
+        size_t slot = vsccGrammarHashName(grammar->rules[i].name) & mask;
+
+        while (linker.ruleIndex[slot] != SIZE_MAX)
+            slot = (slot + 1) & mask;
+        linker.ruleIndex[slot] = i;
+    }
+
+    for (size_t i = 0; linked && i < grammar->ruleCount; i++)
+        linked = vsccGrammarLinkRule(&linker, grammar->rules[i].rule);
+
+    if (linked) {
+        const size_t summaryCount = grammar->ruleCount * VSCC_GRAMMAR_INVOCATION_DEPTH;
+        VsccGrammarSelector selector = {
+            .grammar     = grammar,
+            .summaries   = (VsccArray *)vsccAllocateZeroed(grammar->allocator, summaryCount + 1, sizeof(VsccArray)),
+            .invocations = vsccArrayCtor(sizeof(VsccGrammarInvocation), grammar->allocator),
+            .retried     = vsccArrayCtor(sizeof(VsccGrammarInvocation), grammar->allocator),
+            .table       = NULL,
+            .tableSize   = 0,
+        };
+
+        for (size_t i = 0; i < grammar->ruleCount; i++)
+            grammar->rules[i].memoize = false;
+        linked = selector.summaries != NULL && selector.invocations != NULL && selector.retried != NULL;
+        for (size_t i = 0; linked && i < grammar->ruleCount; i++)
+            linked = vsccGrammarSelectMemoized(&selector, grammar->rules[i].rule);
+
+        for (size_t i = 0; selector.summaries != NULL && i < summaryCount; i++)
+            vsccArrayDtor(selector.summaries[i]);
+        vsccDeallocate(grammar->allocator, selector.summaries);
+        vsccArrayDtor(selector.invocations);
+        vsccArrayDtor(selector.retried);
+        vsccDeallocate(grammar->allocator, selector.table);
+    }
+
+    if (linked) {
+        const size_t terminalCount = vsccArraySize(linker.terminals);
+        const size_t automatonCount = vsccArraySize(linker.automata);
+
+        grammar->terminals = (const VsccRule **)vsccAllocateZeroed(grammar->allocator, terminalCount + 1, sizeof(const VsccRule *));
+        grammar->automata = (VsccNfa *)vsccAllocateZeroed(grammar->allocator, automatonCount + 1, sizeof(VsccNfa));
+        linked = grammar->terminals != NULL && grammar->automata != NULL;
+
+        if (linked) {
+            if (terminalCount != 0)
+                memcpy(grammar->terminals, vsccArrayData(linker.terminals), terminalCount * sizeof(const VsccRule *));
+            if (automatonCount != 0)
+                memcpy(grammar->automata, vsccArrayData(linker.automata), automatonCount * sizeof(VsccNfa));
+            grammar->terminalCount = terminalCount;
+            grammar->automatonCount = automatonCount;
+            grammar->linked = true;
+        }
+    }
+
+    if (!linked) {
+        for (size_t i = 0; linker.automata != NULL && i < vsccArraySize(linker.automata); i++)
+            vsccNfaDtor(((VsccNfa *)vsccArrayData(linker.automata))[i]);
+        vsccGrammarUnlink(grammar);
+    }
+
+    vsccArrayDtor(linker.terminals);
+    vsccArrayDtor(linker.automata);
+    vsccDeallocate(grammar->allocator, linker.ruleIndex);
+    vsccDeallocate(grammar->allocator, linker.terminalIndex);
+
+    return linked;
+} // vsccGrammarLink
+
+// vscc_grammar.c
@@ -0,0 +1,134 @@
+/**
+ * @brief grammar snapshot and slot implementation file
+ */
+
+#include <assert.h>
+#include <sched.h>
+
+#include "vscc.h"
+
+/// @brief grammar snapshot internal representation
+typedef struct __VsccGrammarSnapshotImpl {
+    size_t        refCount; ///< count of references (atomic)
+    VsccGrammar * grammar;  ///< frozen grammar
+} VsccGrammarSnapshotImpl;
+
+/// @brief grammar slot internal representation
+typedef struct __VsccGrammarSlotImpl {
+    VsccGrammarSnapshot snapshot;   ///< current snapshot (atomic)
+    size_t              epoch;      ///< current reader epoch, its lowest bit selects reader counter (atomic)
+    size_t              readers[2]; ///< count of readers that are between epoch load and snapshot reference acquire (atomic)
+    bool                publishing; ///< publisher lock (atomic)
+
+    const VsccAllocator * allocator; ///< allocator of slot memory (nullable)
+} VsccGrammarSlotImpl;
+
+VsccGrammarSnapshot vsccGrammarFreeze( VsccGrammar *grammar ) {
+    assert(grammar != NULL);
+
+    if (!grammar->linked && !vsccGrammarLink(grammar)) {
+        vsccGrammarDtor(grammar);
+        return NULL;
+    }
+
+    VsccGrammarSnapshot snapshot = (VsccGrammarSnapshot)vsccAllocateZeroed(grammar->allocator, 1, sizeof(VsccGrammarSnapshotImpl));
+
+    if (snapshot == NULL) {
+        vsccGrammarDtor(grammar);
+        return NULL;
+    }
+
+    snapshot->refCount = 1;
+    snapshot->grammar = grammar;
+
+    return snapshot;
+} // vsccGrammarFreeze
+
+VsccGrammarSnapshot vsccGrammarSnapshotAcquire( VsccGrammarSnapshot snapshot ) {
+    assert(snapshot != NULL);
+
+    __atomic_fetch_add(&snapshot->refCount, 1, __ATOMIC_RELAXED);
+    return snapshot;
+} // vsccGrammarSnapshotAcquire
+
+void vsccGrammarSnapshotRelease( VsccGrammarSnapshot snapshot ) {
+    if (snapshot == NULL)
+        return;
+
+    if (__atomic_sub_fetch(&snapshot->refCount, 1, __ATOMIC_ACQ_REL) != 0)
+        return;
+
+    // snapshot is allocated by grammar allocator
+    const VsccAllocator *allocator = snapshot->grammar->allocator;
+
+    vsccGrammarDtor(snapshot->grammar);
+    vsccDeallocate(allocator, snapshot);
+} // vsccGrammarSnapshotRelease
+
+const VsccGrammar * vsccGrammarSnapshotGrammar( const VsccGrammarSnapshot snapshot ) {
+    assert(snapshot != NULL);
+    return snapshot->grammar;
+} // vsccGrammarSnapshotGrammar
+
+VsccGrammarSlot vsccGrammarSlotCtor( VsccGrammarSnapshot snapshot, const VsccAllocator *allocator ) {
+    VsccGrammarSlot slot = (VsccGrammarSlot)vsccAllocateZeroed(allocator, 1, sizeof(VsccGrammarSlotImpl));
+
+    if (slot == NULL) {
+        vsccGrammarSnapshotRelease(snapshot);
+        return NULL;
+    }
+
+    slot->snapshot = snapshot;
+    slot->allocator = allocator;
+
+    return slot;
+} // vsccGrammarSlotCtor
+
+void vsccGrammarSlotDtor( VsccGrammarSlot slot ) {
+    if (slot == NULL)
+        return;
+
+    vsccGrammarSnapshotRelease(slot->snapshot);
+    vsccDeallocate(slot->allocator, slot);
+} // vsccGrammarSlotDtor
+
+VsccGrammarSnapshot vsccGrammarSlotAcquire( VsccGrammarSlot slot ) {
+    assert(slot != NULL);
+
+    // register as reader, so publisher won't release snapshot until reference is acquired
+    const size_t epoch = __atomic_load_n(&slot->epoch, __ATOMIC_SEQ_CST) & 1;
+    __atomic_fetch_add(&slot->readers[epoch], 1, __ATOMIC_SEQ_CST);
+
+    VsccGrammarSnapshot snapshot = __atomic_load_n(&slot->snapshot, __ATOMIC_SEQ_CST);
+
+    if (snapshot != NULL)
+        __atomic_fetch_add(&snapshot->refCount, 1, __ATOMIC_RELAXED);
+
+    __atomic_fetch_sub(&slot->readers[epoch], 1, __ATOMIC_RELEASE);
+
+    return snapshot;
+} // vsccGrammarSlotAcquire
+
+void vsccGrammarSlotPublish( VsccGrammarSlot slot, VsccGrammarSnapshot snapshot ) {
+    assert(slot != NULL);
+
+    while (__atomic_test_and_set(&slot->publishing, __ATOMIC_ACQUIRE))
+        sched_yield();
+
+    VsccGrammarSnapshot old = __atomic_exchange_n(&slot->snapshot, snapshot, __ATOMIC_SEQ_CST);
+
+    // wait for two grace periods. New readers enter counter of the new epoch, so
+    // each wait drains only readers that may have loaded old snapshot pointer.
+    for (size_t phase = 0; phase < 2; phase++) {
+        const size_t epoch = __atomic_fetch_add(&slot->epoch, 1, __ATOMIC_SEQ_CST) & 1;
+
+        while (__atomic_load_n(&slot->readers[epoch], __ATOMIC_ACQUIRE) != 0)
+            sched_yield();
+    }
+
+    __atomic_clear(&slot->publishing, __ATOMIC_RELEASE);
+
+    vsccGrammarSnapshotRelease(old);
+} // vsccGrammarSlotPublish
+
+// vscc_grammar_snapshot.c
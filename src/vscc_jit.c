@@ -0,0 +1,668 @@
+/**
+ * @brief x86-64 grammar JIT compiler implementation file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "vscc.h"
+
+#if defined(__x86_64__) && (defined(__linux__) || defined(__unix__))
+#define VSCC_JIT_SUPPORTED
+#endif
+
+#ifdef VSCC_JIT_SUPPORTED
+
+#include <sys/mman.h>
+
+/// @brief stack size compiled code may use, matching is aborted once it's exceeded
+#define VSCC_JIT_STACK_SIZE ((size_t)1 << 20)
+
+/// @brief result of rule function that aborted matching because of stack exhaustion
+#define VSCC_JIT_ABORTED ((const char *)1)
+
+/// @brief compiled rule function (returns end of match, NULL if failed or VSCC_JIT_ABORTED if stack limit is reached)
+typedef const char * (* VsccJitFunction)( const char *strBegin, const char *strEnd, const char *stackLimit );
+
+/// @brief JIT internal representation
+typedef struct __VsccJitImpl {
+    uint8_t * code;        ///< executable code
+    size_t    codeSize;    ///< code mapping size
+    size_t  * ruleOffsets; ///< rule function offsets in code
+    size_t    ruleCount;   ///< count of rules
+
+    const VsccAllocator * allocator; ///< allocator of JIT memory except code mapping (nullable)
+} VsccJitImpl;
+
+/// @brief code label fixup
+typedef struct __VsccJitFixup {
+    size_t offset; ///< offset of rel32 to patch
+    size_t label;  ///< label rel32 should point to
+} VsccJitFixup;
+
+/// @brief JIT compiler
+typedef struct __VsccJitCompiler {
+    const VsccGrammar * grammar;   ///< grammar to compile
+    VsccArray           code;      ///< emitted code (uint8_t)
+    VsccArray           labels;    ///< label offsets (size_t, SIZE_MAX if not bound)
+    VsccArray           fixups;    ///< label fixups (VsccJitFixup)
+    size_t              slotCount; ///< count of backtracking slots used by current function
+    size_t              abort;     ///< abort label of current function
+    bool                failed;    ///< true if some allocation failed
+} VsccJitCompiler;
+
+/**
+ * @brief byte sequence emitting function
+ *
+ * @param[in,out] self  compiler (non-null)
+ * @param[in]     bytes bytes to emit (non-null)
+ * @param[in]     count count of bytes
+ */
+static void vsccJitEmit( VsccJitCompiler *self, const void *bytes, size_t count ) {
+    for (size_t i = 0; i < count; i++)
+        if (!vsccArrayPush(&self->code, (const uint8_t *)bytes + i))
+            self->failed = true;
+} // vsccJitEmit
+
+/// @brief instruction bytes emitting macro
+#define VSCC_JIT_EMIT(self, ...) do {                 \
+    static const uint8_t __bytes[] = {__VA_ARGS__};  \
+    vsccJitEmit((self), __bytes, sizeof(__bytes));   \
+} while (false)
+
+/**
+ * @brief single byte emitting function
+ *
+ * @param[in,out] self compiler (non-null)
+ * @param[in]     byte byte to emit
+ */
+static void vsccJitEmitByte( VsccJitCompiler *self, uint8_t byte ) {
+    vsccJitEmit(self, &byte, 1);
+} // vsccJitEmitByte
+
+/**
+ * @brief 32-bit little-endian value emitting function
+ *
+ * @param[in,out] self  compiler (non-null)
+ * @param[in]     value value to emit
+ */
+static void vsccJitEmit32( VsccJitCompiler *self, uint32_t value ) {
+    const uint8_t bytes[4] = {
+        (uint8_t)value,
+        (uint8_t)(value >> 8),
+        (uint8_t)(value >> 16),
+        (uint8_t)(value >> 24),
+    };
+
+    vsccJitEmit(self, bytes, 4);
+} // vsccJitEmit32
+
+/**
+ * @brief 64-bit little-endian value emitting function
+ *
+ * @param[in,out] self  compiler (non-null)
+ * @param[in]     value value to emit
+ */
+static void vsccJitEmit64( VsccJitCompiler *self, uint64_t value ) {
+    vsccJitEmit32(self, (uint32_t)value);
+    vsccJitEmit32(self, (uint32_t)(value >> 32));
+} // vsccJitEmit64
+
+/**
+ * @brief new label creating function
+ *
+ * @param[in,out] self compiler (non-null)
+ *
+ * @return label index
+ */
+static size_t vsccJitLabel( VsccJitCompiler *self ) {
+    const size_t unbound = SIZE_MAX;
+
+    if (!vsccArrayPush(&self->labels, &unbound))
+        self->failed = true;
+    return vsccArraySize(self->labels) - 1;
+} // vsccJitLabel
+
+/**
+ * @brief label to current code offset binding function
+ *
+ * @param[in,out] self  compiler (non-null)
+ * @param[in]     label label to bind
+ */
+static void vsccJitBind( VsccJitCompiler *self, size_t label ) {
+    if (self->failed)
+        return;
+    ((size_t *)vsccArrayData(self->labels))[label] = vsccArraySize(self->code);
+} // vsccJitBind
+
+/**
+ * @brief label-relative rel32 emitting function
+ *
+ * @param[in,out] self  compiler (non-null)
+ * @param[in]     label label rel32 points to
+ */
+static void vsccJitEmitRel32( VsccJitCompiler *self, size_t label ) {
+    const VsccJitFixup fixup = {
+        .offset = vsccArraySize(self->code),
+        .label  = label,
+    };
+
+    if (!vsccArrayPush(&self->fixups, &fixup))
+        self->failed = true;
+    vsccJitEmit32(self, 0);
+} // vsccJitEmitRel32
+
+/// @brief x86 condition codes used by compiler
+typedef enum __VsccJitCondition {
+    VSCC_JIT_CONDITION_B  = 0x2, ///< below (unsigned)
+    VSCC_JIT_CONDITION_AE = 0x3, ///< above or equal (unsigned)
+    VSCC_JIT_CONDITION_E  = 0x4, ///< equal
+    VSCC_JIT_CONDITION_NE = 0x5, ///< not equal
+    VSCC_JIT_CONDITION_BE = 0x6, ///< below or equal (unsigned)
+} VsccJitCondition;
+
+/**
+ * @brief unconditional jump emitting function
+ *
+ * @param[in,out] self  compiler (non-null)
+ * @param[in]     label jump target
+ */
+static void vsccJitJmp( VsccJitCompiler *self, size_t label ) {
+    vsccJitEmitByte(self, 0xE9);
+    vsccJitEmitRel32(self, label);
+} // vsccJitJmp
+
+/**
+ * @brief conditional jump emitting function
+ *
+ * @param[in,out] self      compiler (non-null)
+ * @param[in]     condition jump condition
+ * @param[in]     label     jump target
+ */
+static void vsccJitJcc( VsccJitCompiler *self, VsccJitCondition condition, size_t label ) {
+    vsccJitEmitByte(self, 0x0F);
+    vsccJitEmitByte(self, (uint8_t)(0x80 | condition));
+    vsccJitEmitRel32(self, label);
+} // vsccJitJcc
+
+/**
+ * @brief backtracking slot displacement (relative to rbp) getting function
+ *
+ * @param[in,out] self compiler (non-null)
+ * @param[in]     slot slot index
+ *
+ * @return displacement
+ */
+static uint32_t vsccJitSlot( VsccJitCompiler *self, size_t slot ) {
+    if (slot + 1 > self->slotCount)
+        self->slotCount = slot + 1;
+
+    // rbx, r12 and r13 are saved right below rbp
+    return (uint32_t)-(int32_t)(32 + 8 * slot);
+} // vsccJitSlot
+
+/**
+ * @brief cursor saving (mov [rbp + slot], rbx) emitting function
+ *
+ * @param[in,out] self compiler (non-null)
+ * @param[in]     slot slot to save cursor to
+ */
+static void vsccJitSaveCursor( VsccJitCompiler *self, size_t slot ) {
+    VSCC_JIT_EMIT(self, 0x48, 0x89, 0x9D);
+    vsccJitEmit32(self, vsccJitSlot(self, slot));
+} // vsccJitSaveCursor
+
+/**
+ * @brief cursor restoring (mov rbx, [rbp + slot]) emitting function
+ *
+ * @param[in,out] self compiler (non-null)
+ * @param[in]     slot slot to restore cursor from
+ */
+static void vsccJitRestoreCursor( VsccJitCompiler *self, size_t slot ) {
+    VSCC_JIT_EMIT(self, 0x48, 0x8B, 0x9D);
+    vsccJitEmit32(self, vsccJitSlot(self, slot));
+} // vsccJitRestoreCursor
+
+/**
+ * @brief string terminal compiling function
+ *
+ * @param[in,out] self  compiler (non-null)
+ * @param[in]     rule  string terminal (non-null)
+ * @param[in]     fail  failure label
+ */
+static void vsccJitCompileStringTerminal( VsccJitCompiler *self, const VsccRule *rule, size_t fail ) {
+    const size_t length = rule->stringTerminal.length;
+    const uint8_t *string = (const uint8_t *)rule->stringTerminal.string;
+
+    if (length == 0)
+        return;
+
+    // mov rax, r12; sub rax, rbx; cmp rax, length; jb fail
+    VSCC_JIT_EMIT(self, 0x4C, 0x89, 0xE0, 0x48, 0x29, 0xD8, 0x48, 0x3D);
+    vsccJitEmit32(self, (uint32_t)length);
+    vsccJitJcc(self, VSCC_JIT_CONDITION_B, fail);
+
+    size_t offset = 0;
+
+    // unrolled compares: qwords by immediate in rax, then dword/word/byte immediates
+    for (; length - offset >= 8; offset += 8) {
+        uint64_t word;
+        memcpy(&word, string + offset, 8);
+
+        VSCC_JIT_EMIT(self, 0x48, 0xB8);
+        vsccJitEmit64(self, word);
+        VSCC_JIT_EMIT(self, 0x48, 0x39, 0x83);
+        vsccJitEmit32(self, (uint32_t)offset);
+        vsccJitJcc(self, VSCC_JIT_CONDITION_NE, fail);
+    }
+
+    if (length - offset >= 4) {
+        uint32_t word;
+        memcpy(&word, string + offset, 4);
+
+        VSCC_JIT_EMIT(self, 0x81, 0xBB);
+        vsccJitEmit32(self, (uint32_t)offset);
+        vsccJitEmit32(self, word);
+        vsccJitJcc(self, VSCC_JIT_CONDITION_NE, fail);
+        offset += 4;
+    }
+
+    if (length - offset >= 2) {
+        VSCC_JIT_EMIT(self, 0x66, 0x81, 0xBB);
+        vsccJitEmit32(self, (uint32_t)offset);
+        vsccJitEmit(self, string + offset, 2);
+        vsccJitJcc(self, VSCC_JIT_CONDITION_NE, fail);
+        offset += 2;
+    }
+
+    if (length - offset >= 1) {
+        VSCC_JIT_EMIT(self, 0x80, 0xBB);
+        vsccJitEmit32(self, (uint32_t)offset);
+        vsccJitEmitByte(self, string[offset]);
+        vsccJitJcc(self, VSCC_JIT_CONDITION_NE, fail);
+    }
+
+    // add rbx, length
+    VSCC_JIT_EMIT(self, 0x48, 0x81, 0xC3);
+    vsccJitEmit32(self, (uint32_t)length);
+} // vsccJitCompileStringTerminal
+
+/**
+ * @brief character terminal compiling function
+ *
+ * @param[in,out] self compiler (non-null)
+ * @param[in]     rule character terminal (non-null)
+ * @param[in]     fail failure label
+ */
+static void vsccJitCompileCharTerminal( VsccJitCompiler *self, const VsccRule *rule, size_t fail ) {
+    const size_t matched = vsccJitLabel(self);
+    const size_t done = vsccJitLabel(self);
+
+    // cmp rbx, r12; jae fail; movzx eax, byte [rbx]
+    VSCC_JIT_EMIT(self, 0x4C, 0x39, 0xE3);
+    vsccJitJcc(self, VSCC_JIT_CONDITION_AE, fail);
+    VSCC_JIT_EMIT(self, 0x0F, 0xB6, 0x03);
+
+    // inline range compares for ASCII runs of the bitmap
+    for (uint32_t c = 0; c < 0x80; ) {
+        if (!((rule->charTerminal.ascii[c / 64] >> c % 64) & 1)) {
+            c++;
+            continue;
+        }
+
+        const uint32_t first = c;
+        while (c < 0x80 && ((rule->charTerminal.ascii[c / 64] >> c % 64) & 1))
+            c++;
+
+        if (c - first == 1) {
+            // cmp eax, first; je matched
+            vsccJitEmitByte(self, 0x3D);
+            vsccJitEmit32(self, first);
+            vsccJitJcc(self, VSCC_JIT_CONDITION_E, matched);
+        } else {
+            // mov ecx, eax; sub ecx, first; cmp ecx, last - first; jbe matched
+            VSCC_JIT_EMIT(self, 0x89, 0xC1, 0x81, 0xE9);
+            vsccJitEmit32(self, first);
+            VSCC_JIT_EMIT(self, 0x81, 0xF9);
+            vsccJitEmit32(self, c - 1 - first);
+            vsccJitJcc(self, VSCC_JIT_CONDITION_BE, matched);
+        }
+    }
+
+    if (rule->charTerminal.tableCount == 0) {
+        vsccJitJmp(self, fail);
+    } else {
+        // cmp eax, 0x80; jb fail
+        vsccJitEmitByte(self, 0x3D);
+        vsccJitEmit32(self, 0x80);
+        vsccJitJcc(self, VSCC_JIT_CONDITION_B, fail);
+
+        // rax = vsccRuleCharTerminalMatch(rule, rbx, r12)
+        VSCC_JIT_EMIT(self, 0x48, 0xBF);
+        vsccJitEmit64(self, (uint64_t)(uintptr_t)rule);
+        VSCC_JIT_EMIT(self, 0x48, 0x89, 0xDE, 0x4C, 0x89, 0xE2, 0x48, 0xB8);
+        vsccJitEmit64(self, (uint64_t)(uintptr_t)&vsccRuleCharTerminalMatch);
+        VSCC_JIT_EMIT(self, 0xFF, 0xD0);
+
+        // test rax, rax; je fail; add rbx, rax; jmp done
+        VSCC_JIT_EMIT(self, 0x48, 0x85, 0xC0);
+        vsccJitJcc(self, VSCC_JIT_CONDITION_E, fail);
+        VSCC_JIT_EMIT(self, 0x48, 0x01, 0xC3);
+        vsccJitJmp(self, done);
+    }
+
+    // matched: add rbx, 1
+    vsccJitBind(self, matched);
+    VSCC_JIT_EMIT(self, 0x48, 0x83, 0xC3, 0x01);
+    vsccJitBind(self, done);
+} // vsccJitCompileCharTerminal
+
+/**
+ * @brief rule compiling function
+ *
+ * @param[in,out] self       compiler (non-null)
+ * @param[in]     rule       rule to compile (non-null)
+ * @param[in]     fail       label to jump to on failure (cursor may be garbage there)
+ * @param[in]     slot       first free backtracking slot
+ * @param[in]     ruleLabels rule function labels (non-null)
+ */
+static void vsccJitCompileRule( VsccJitCompiler *self, const VsccRule *rule, size_t fail, size_t slot, const size_t *ruleLabels ) {
+    switch (rule->type) {
+    case VSCC_RULE_SEQUENCE:
+        for (size_t i = 0; i < rule->sequence.count; i++)
+            vsccJitCompileRule(self, rule->sequence.rules[i], fail, slot, ruleLabels);
+        break;
+
+    case VSCC_RULE_VARIANT: {
+        const size_t done = vsccJitLabel(self);
+
+        vsccJitSaveCursor(self, slot);
+        for (size_t i = 0; i + 1 < rule->variant.count; i++) {
+            const size_t next = vsccJitLabel(self);
+
+            vsccJitCompileRule(self, rule->variant.rules[i], next, slot + 1, ruleLabels);
+            vsccJitJmp(self, done);
+            vsccJitBind(self, next);
+            vsccJitRestoreCursor(self, slot);
+        }
+        vsccJitCompileRule(self, rule->variant.rules[rule->variant.count - 1], fail, slot + 1, ruleLabels);
+        vsccJitBind(self, done);
+        break;
+    }
+
+    case VSCC_RULE_OPTIONAL: {
+        const size_t none = vsccJitLabel(self);
+        const size_t done = vsccJitLabel(self);
+
+        vsccJitSaveCursor(self, slot);
+        vsccJitCompileRule(self, rule->optional, none, slot + 1, ruleLabels);
+        vsccJitJmp(self, done);
+        vsccJitBind(self, none);
+        vsccJitRestoreCursor(self, slot);
+        vsccJitBind(self, done);
+        break;
+    }
+
+    case VSCC_RULE_REPEAT: {
+        const size_t loop = vsccJitLabel(self);
+        const size_t exit = vsccJitLabel(self);
+        const size_t done = vsccJitLabel(self);
+
+        if (rule->repeat.atLeastOnce)
+            vsccJitCompileRule(self, rule->repeat.rule, fail, slot, ruleLabels);
+
+        vsccJitBind(self, loop);
+        vsccJitSaveCursor(self, slot);
+        vsccJitCompileRule(self, rule->repeat.rule, exit, slot + 1, ruleLabels);
+
+        // cmp rbx, [rbp + slot]; jne loop (stop on empty iteration)
+        VSCC_JIT_EMIT(self, 0x48, 0x3B, 0x9D);
+        vsccJitEmit32(self, vsccJitSlot(self, slot));
+        vsccJitJcc(self, VSCC_JIT_CONDITION_NE, loop);
+        vsccJitJmp(self, done);
+
+        vsccJitBind(self, exit);
+        vsccJitRestoreCursor(self, slot);
+        vsccJitBind(self, done);
+        break;
+    }
+
+    case VSCC_RULE_STRING_TERMINAL:
+        vsccJitCompileStringTerminal(self, rule, fail);
+        break;
+
+    case VSCC_RULE_CHAR_TERMINAL:
+        vsccJitCompileCharTerminal(self, rule, fail);
+        break;
+
+    case VSCC_RULE_REFERENCE:
+        // mov rdi, rbx; mov rsi, r12; mov rdx, r13; call rule
+        VSCC_JIT_EMIT(self, 0x48, 0x89, 0xDF, 0x4C, 0x89, 0xE6, 0x4C, 0x89, 0xEA, 0xE8);
+        vsccJitEmitRel32(self, ruleLabels[rule->reference.index]);
+
+        // abort isn't a failure, so it skips all alternatives: cmp rax, 1; je abort
+        VSCC_JIT_EMIT(self, 0x48, 0x83, 0xF8, 0x01);
+        vsccJitJcc(self, VSCC_JIT_CONDITION_E, self->abort);
+
+        // test rax, rax; je fail; mov rbx, rax
+        VSCC_JIT_EMIT(self, 0x48, 0x85, 0xC0);
+        vsccJitJcc(self, VSCC_JIT_CONDITION_E, fail);
+        VSCC_JIT_EMIT(self, 0x48, 0x89, 0xC3);
+        break;
+
+    case VSCC_RULE_END:
+        // cmp rbx, r12; jne fail
+        VSCC_JIT_EMIT(self, 0x4C, 0x39, 0xE3);
+        vsccJitJcc(self, VSCC_JIT_CONDITION_NE, fail);
+        break;
+
+    case VSCC_RULE_EMPTY:
+        break;
+    }
+} // vsccJitCompileRule
+
+/**
+ * @brief rule function compiling function
+ *
+ * @param[in,out] self       compiler (non-null)
+ * @param[in]     rule       rule to compile function of (non-null)
+ * @param[in]     ruleLabels rule function labels (non-null)
+ */
+static void vsccJitCompileFunction( VsccJitCompiler *self, const VsccRule *rule, const size_t *ruleLabels ) {
+    const size_t fail = vsccJitLabel(self);
+    const size_t exit = vsccJitLabel(self);
+
+    self->abort = vsccJitLabel(self);
+
+    // push rbp; mov rbp, rsp; push rbx; push r12; push r13; sub rsp, frame
+    VSCC_JIT_EMIT(self, 0x55, 0x48, 0x89, 0xE5, 0x53, 0x41, 0x54, 0x41, 0x55, 0x48, 0x81, 0xEC);
+    const size_t frameOffset = vsccArraySize(self->code);
+    vsccJitEmit32(self, 0);
+
+    // deep recursion is aborted before it exhausts stack: cmp rsp, rdx; jb abort
+    VSCC_JIT_EMIT(self, 0x48, 0x39, 0xD4);
+    vsccJitJcc(self, VSCC_JIT_CONDITION_B, self->abort);
+
+    // mov rbx, rdi; mov r12, rsi; mov r13, rdx
+    VSCC_JIT_EMIT(self, 0x48, 0x89, 0xFB, 0x49, 0x89, 0xF4, 0x49, 0x89, 0xD5);
+
+    self->slotCount = 0;
+    vsccJitCompileRule(self, rule, fail, 0, ruleLabels);
+
+    // mov rax, rbx; jmp exit
+    VSCC_JIT_EMIT(self, 0x48, 0x89, 0xD8);
+    vsccJitJmp(self, exit);
+
+    // abort: mov eax, 1; jmp exit
+    vsccJitBind(self, self->abort);
+    VSCC_JIT_EMIT(self, 0xB8, 0x01, 0x00, 0x00, 0x00);
+    vsccJitJmp(self, exit);
+
+    // fail: xor eax, eax
+    vsccJitBind(self, fail);
+    VSCC_JIT_EMIT(self, 0x31, 0xC0);
+
+    // exit: lea rsp, [rbp - 24]; pop r13; pop r12; pop rbx; pop rbp; ret
+    vsccJitBind(self, exit);
+    VSCC_JIT_EMIT(self, 0x48, 0x8D, 0x65, 0xE8, 0x41, 0x5D, 0x41, 0x5C, 0x5B, 0x5D, 0xC3);
+
+    if (self->failed)
+        return;
+
+    // frame keeps stack 16-byte aligned for calls (three registers are pushed after rbp)
+    const uint32_t frameSize = (uint32_t)((self->slotCount * 8 + 8 + 15) / 16 * 16 - 8);
+    uint8_t *code = (uint8_t *)vsccArrayData(self->code);
+
+    for (size_t i = 0; i < 4; i++)
+        code[frameOffset + i] = (uint8_t)(frameSize >> 8 * i);
+} // vsccJitCompileFunction
+
+VsccJit vsccJitCtor( const VsccGrammar *grammar, const VsccAllocator *allocator ) {
+    assert(grammar != NULL);
+    assert(grammar->linked);
+
+    // there is no code to map
+    if (grammar->ruleCount == 0)
+        return NULL;
+
+    VsccJitCompiler compiler = {
+        .grammar   = grammar,
+        .code      = vsccArrayCtor(sizeof(uint8_t), allocator),
+        .labels    = vsccArrayCtor(sizeof(size_t), allocator),
+        .fixups    = vsccArrayCtor(sizeof(VsccJitFixup), allocator),
+        .slotCount = 0,
+        .abort     = 0,
+        .failed    = false,
+    };
+    VsccJit jit = (VsccJit)vsccAllocateZeroed(allocator, 1, sizeof(VsccJitImpl));
+    size_t *ruleLabels = (size_t *)vsccAllocateZeroed(allocator, grammar->ruleCount + 1, sizeof(size_t));
+
+    if (jit != NULL)
+        jit->allocator = allocator;
+
+    compiler.failed = false
+        || compiler.code == NULL
+        || compiler.labels == NULL
+        || compiler.fixups == NULL
+        || jit == NULL
+        || ruleLabels == NULL
+    ;
+
+    if (!compiler.failed) {
+        jit->ruleCount = grammar->ruleCount;
+        jit->ruleOffsets = (size_t *)vsccAllocateZeroed(allocator, grammar->ruleCount + 1, sizeof(size_t));
+        compiler.failed = jit->ruleOffsets == NULL;
+    }
+
+    for (size_t i = 0; !compiler.failed && i < grammar->ruleCount; i++)
+        ruleLabels[i] = vsccJitLabel(&compiler);
+
+    for (size_t i = 0; !compiler.failed && i < grammar->ruleCount; i++) {
+        // align functions to 16 bytes with int3 padding
+        while (vsccArraySize(compiler.code) % 16 != 0 && !compiler.failed)
+            vsccJitEmitByte(&compiler, 0xCC);
+
+        jit->ruleOffsets[i] = vsccArraySize(compiler.code);
+        vsccJitBind(&compiler, ruleLabels[i]);
+        vsccJitCompileFunction(&compiler, grammar->rules[i].rule, ruleLabels);
+    }
+
+    if (!compiler.failed) {
+        uint8_t *code = (uint8_t *)vsccArrayData(compiler.code);
+        const size_t *labels = (const size_t *)vsccArrayData(compiler.labels);
+        const VsccJitFixup *fixups = (const VsccJitFixup *)vsccArrayData(compiler.fixups);
+
+        for (size_t i = 0; i < vsccArraySize(compiler.fixups); i++) {
+            const size_t target = labels[fixups[i].label];
+
+            assert(target != SIZE_MAX);
+
+            const uint32_t rel = (uint32_t)(int32_t)((int64_t)target - (int64_t)(fixups[i].offset + 4));
+            for (size_t j = 0; j < 4; j++)
+                code[fixups[i].offset + j] = (uint8_t)(rel >> 8 * j);
+        }
+
+        // map writable, copy code and then make it executable, so mapping is never writable and executable at once
+        jit->codeSize = vsccArraySize(compiler.code);
+        void *mapping = mmap(NULL, jit->codeSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (mapping == MAP_FAILED) {
+            compiler.failed = true;
+        } else {
+            memcpy(mapping, code, jit->codeSize);
+            jit->code = (uint8_t *)mapping;
+            compiler.failed = mprotect(mapping, jit->codeSize, PROT_READ | PROT_EXEC) != 0;
+        }
+    }
+
+    vsccArrayDtor(compiler.code);
+    vsccArrayDtor(compiler.labels);
+    vsccArrayDtor(compiler.fixups);
+    vsccDeallocate(allocator, ruleLabels);
+
+    if (compiler.failed) {
+        vsccJitDtor(jit);
+        return NULL;
+    }
+
+    return jit;
+} // vsccJitCtor
+
+void vsccJitDtor( VsccJit jit ) {
+    if (jit == NULL)
+        return;
+
+    if (jit->code != NULL)
+        munmap(jit->code, jit->codeSize);
+    vsccDeallocate(jit->allocator, jit->ruleOffsets);
+    vsccDeallocate(jit->allocator, jit);
+} // vsccJitDtor
+
+VsccMatchStatus vsccJitMatch( const VsccJit jit, size_t ruleIndex, const char *strBegin, const char *strEnd, size_t *length ) {
+    assert(jit != NULL);
+    assert(ruleIndex < jit->ruleCount);
+    assert(strBegin != NULL);
+    assert(strBegin <= strEnd);
+    assert(length != NULL);
+
+    // stack grows down, so compiled code may use stack up to VSCC_JIT_STACK_SIZE bytes below current frame
+    const uintptr_t frame = (uintptr_t)__builtin_frame_address(0);
+    const char *stackLimit = (const char *)(frame > VSCC_JIT_STACK_SIZE ? frame - VSCC_JIT_STACK_SIZE : 0);
+
+    const VsccJitFunction function = (VsccJitFunction)(void *)(jit->code + jit->ruleOffsets[ruleIndex]);
+    const char *matchEnd = function(strBegin, strEnd, stackLimit);
+
+    if (matchEnd == NULL)
+        return VSCC_MATCH_FAILED;
+    if (matchEnd == VSCC_JIT_ABORTED)
+        return VSCC_MATCH_TOO_DEEP;
+    *length = matchEnd - strBegin;
+    return VSCC_MATCH_OK;
+} // vsccJitMatch
+
+#else // defined(VSCC_JIT_SUPPORTED)
+
+VsccJit vsccJitCtor( const VsccGrammar *grammar, const VsccAllocator *allocator ) {
+    (void)grammar;
+    (void)allocator;
+    return NULL;
+} // vsccJitCtor
+
+void vsccJitDtor( VsccJit jit ) {
+    assert(jit == NULL);
+} // vsccJitDtor
+
+VsccMatchStatus vsccJitMatch( const VsccJit jit, size_t ruleIndex, const char *strBegin, const char *strEnd, size_t *length ) {
+    (void)jit;
+    (void)ruleIndex;
+    (void)strBegin;
+    (void)strEnd;
+    (void)length;
+    assert(false && "JIT isn't supported on this platform");
+    return VSCC_MATCH_INTERNAL_ERROR;
+} // vsccJitMatch
+
+#endif // defined(VSCC_JIT_SUPPORTED)
+
+// vscc_jit.c
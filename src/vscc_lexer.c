@@ -0,0 +1,100 @@
+/**
+ * @brief token lexer implementation file
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "vscc.h"
+
+/// @brief lexer internal representation
+typedef struct __VsccLexerImpl {
+    const VsccGrammar * grammar; ///< grammar token rules belong to
+    VsccNfa             nfa;     ///< token rules NFA
+    VsccLazyDfa         dfa;     ///< token rules lazy DFA
+    size_t            * kinds;   ///< token rule index by NFA alternative
+
+    const VsccAllocator * allocator; ///< allocator of lexer memory (nullable)
+} VsccLexerImpl;
+
+VsccLexer vsccLexerCtor( const VsccGrammar *grammar, const VsccAllocator *allocator ) {
+    assert(grammar != NULL);
+    assert(grammar->linked);
+
+    VsccLexer lexer = (VsccLexer)vsccAllocateZeroed(allocator, 1, sizeof(VsccLexerImpl));
+
+    if (lexer == NULL)
+        return NULL;
+
+    lexer->allocator = allocator;
+    lexer->grammar = grammar;
+    lexer->nfa = vsccNfaTokenCtor(grammar, allocator);
+    lexer->dfa = lexer->nfa == NULL ? NULL : vsccLazyDfaCtor(lexer->nfa, allocator);
+    lexer->kinds = (size_t *)vsccAllocateZeroed(allocator, grammar->ruleCount + 1, sizeof(size_t));
+
+    if (lexer->nfa == NULL || lexer->dfa == NULL || lexer->kinds == NULL) {
+        vsccLexerDtor(lexer);
+        return NULL;
+    }
+
+    // NFA alternatives are token rules in grammar order
+    size_t alternative = 0;
+
+    for (size_t i = 0; i < grammar->ruleCount; i++)
+        if (grammar->rules[i].token != VSCC_TOKEN_NONE)
+            lexer->kinds[alternative++] = i;
+
+    return lexer;
+} // vsccLexerCtor
+
+void vsccLexerDtor( VsccLexer lexer ) {
+    if (lexer == NULL)
+        return;
+
+    vsccLazyDfaDtor(lexer->dfa);
+    vsccNfaDtor(lexer->nfa);
+    vsccDeallocate(lexer->allocator, lexer->kinds);
+    vsccDeallocate(lexer->allocator, lexer);
+} // vsccLexerDtor
+
+VsccLexStatus vsccLexerRun( VsccLexer lexer, const char *strBegin, const char *strEnd, VsccArray *tokens, size_t *errorOffset ) {
+    assert(lexer != NULL);
+    assert(strBegin != NULL);
+    assert(strBegin <= strEnd);
+    assert(tokens != NULL);
+
+    if ((size_t)(strEnd - strBegin) > UINT32_MAX)
+        return VSCC_LEX_TEXT_TOO_LONG;
+
+    vsccArrayTruncate(*tokens, 0);
+
+    for (const char *str = strBegin; str < strEnd; ) {
+        size_t alternative = 0, length = 0;
+
+        // empty token would never let lexer move on
+        if (!vsccLazyDfaMatch(lexer->dfa, str, strEnd, &alternative, &length) || length == 0) {
+            if (errorOffset != NULL)
+                *errorOffset = str - strBegin;
+            return VSCC_LEX_FAILED;
+        }
+
+        const size_t kind = lexer->kinds[alternative];
+
+        if (lexer->grammar->rules[kind].token == VSCC_TOKEN_EMIT) {
+            const VsccToken token = {
+                .kind   = (uint32_t)kind,
+                .offset = (uint32_t)(str - strBegin),
+                .length = (uint32_t)length,
+            };
+
+            if (!vsccArrayPush(tokens, &token))
+                return VSCC_LEX_INTERNAL_ERROR;
+        }
+
+        str += length;
+    }
+
+    return VSCC_LEX_OK;
+} // vsccLexerRun
+
+// vscc_lexer.c
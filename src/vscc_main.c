@@ -3,37 +3,685 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "vscc.h"
 
+/// @brief files at least this large are mapped instead of being read to batch buffer
+#define VSCC_CHECK_MAP_THRESHOLD ((size_t)1 << 20)
+
+/// @brief batch buffer size (> VSCC_CHECK_MAP_THRESHOLD, so every read file fits to empty batch)
+#define VSCC_CHECK_BATCH_SIZE ((size_t)4 << 20)
+
+/// @brief maximal count of files in single batch
+#define VSCC_CHECK_BATCH_FILES 4096
+
+/// @brief file to check
+typedef struct __VsccCheckFile {
+    const char * path;   ///< file path
+    const char * text;   ///< file text (in batch buffer or file mapping)
+    size_t       size;   ///< file size
+    bool         mapped; ///< true if text is file mapping
+    int          error;  ///< errno value if file can't be read, 0 otherwise
+} VsccCheckFile;
+
+/// @brief batch of files read ahead of checking
+typedef struct __VsccCheckBatch {
+    char      * buffer; ///< texts of read files (VSCC_CHECK_BATCH_SIZE bytes)
+    size_t      size;   ///< count of buffer bytes used
+    VsccArray   files;  ///< batch files (VsccCheckFile)
+    bool        ready;  ///< true if batch is filled by reader and isn't checked yet
+} VsccCheckBatch;
+
+/// @brief read-ahead pipeline
+typedef struct __VsccCheckPipeline {
+    pthread_mutex_t     mutex;      ///< pipeline state mutex
+    pthread_cond_t      changed;    ///< batch state change condition
+    VsccCheckBatch      batches[2]; ///< batches (reader fills one while other is checked)
+    bool                done;       ///< true if reader published all batches
+    bool                stopped;    ///< true if checker doesn't wait for batches anymore
+
+    const char * const * paths;     ///< paths of files to read
+    size_t               pathCount; ///< count of paths
+} VsccCheckPipeline;
+
+/// @brief grammar checking context
+typedef struct __VsccChecker {
+    const VsccGrammar * grammar;   ///< linked grammar
+    size_t              ruleIndex; ///< index of rule files are matched by
+    VsccJit             jit;       ///< compiled grammar (nullable, matcher is used then)
+    VsccMatcher         matcher;   ///< matcher (for files JIT rejects and platforms without JIT)
+    bool                quiet;     ///< true if passed files aren't reported
+
+    size_t              passed;    ///< count of passed files
+    size_t              failed;    ///< count of failed files
+    size_t              bytes;     ///< total size of checked files
+} VsccChecker;
+
 /**
- * @brief main project function
+ * @brief usage printing function
  *
- * @return exit status
+ * @param[in] out  file to print usage to
+ * @param[in] name executable name
  */
-int main( void ) {
-    VsccRuleCharRange ranges[] = {
-        {'a', 'z'},
-        {'A', 'Z'},
-        {'0', '9'},
-        {'_', '_'},
-    };
-    VsccRule *rules[] = {
-        vsccRuleStringTerminal("amogus"),
-        vsccRuleStringTerminal("sus"),
-        vsccRuleCharTerminal(ranges, 4),
-        vsccRuleEnd()
+static void vsccPrintUsage( FILE *out, const char *name ) {
+    fprintf(out,
+        "usage: %s check [options] <grammar.vsg> <path>...\n"
+        "\n"
+        "checks that files match grammar rule completely, directories are checked recursively\n"
+        "\n"
+        "options:\n"
+        "    --rule <name>   rule to match files by (first grammar rule by default)\n"
+        "    --cache <path>  grammar automaton cache file (may be shared by several grammars)\n"
+        "    --prune-cache   drop cache entries this grammar doesn't use\n"
+        "    --quiet         report failed files only\n",
+        name
+    );
+} // vsccPrintUsage
+
+/**
+ * @brief monotonic time getting function
+ *
+ * @return current time in seconds
+ */
+static double vsccGetTime( void ) {
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+} // vsccGetTime
+
+/**
+ * @brief whole file reading function
+ *
+ * @param[in]  path file path (non-null)
+ * @param[out] size file size destination (non-null)
+ *
+ * @return file contents (NULL if failed, must be freed)
+ */
+static char * vsccReadFile( const char *path, size_t *size ) {
+    FILE *file = fopen(path, "rb");
+
+    if (file == NULL)
+        return NULL;
+
+    long length = -1;
+    char *data = NULL;
+
+    if (fseek(file, 0, SEEK_END) == 0)
+        length = ftell(file);
+    if (length >= 0 && fseek(file, 0, SEEK_SET) == 0 && (data = (char *)malloc(length + 1)) != NULL && fread(data, 1, length, file) != (size_t)length) {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+
+    *size = length;
+    return data;
+} // vsccReadFile
+
+/**
+ * @brief .vsg grammar loading function
+ *
+ * @param[in] path  grammar file path (non-null)
+ * @param[in] cache automaton cache (nullable)
+ *
+ * @note errors are reported to stderr
+ *
+ * @return linked grammar (NULL if failed)
+ */
+static VsccGrammar * vsccLoadGrammar( const char *path, VsccCache cache ) {
+    size_t size = 0;
+    char *text = vsccReadFile(path, &size);
+
+    if (text == NULL) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+
+    const VsccGrammarParseResult result = vsccGrammarParse(text, text + size, NULL);
+
+    if (result.status != VSCC_RULE_PARSE_OK) {
+        const char *messages[] = {
+            "ok",
+            "internal error",
+            "unexpected end of grammar",
+            "unexpected character",
+            "rule redefined",
+            "reference to undefined rule",
+        };
+        size_t line = 1, column = 1;
+
+        for (const char *c = text; c < result.error; c++) {
+            if (*c == '\n') {
+                line++;
+                column = 1;
+            } else {
+                column++;
+            }
+        }
+
+        fprintf(stderr, "%s:%zu:%zu: %s\n", path, line, column, messages[result.status]);
+        free(text);
+        return NULL;
+    }
+    free(text);
+
+    VsccGrammar *grammar = result.ok;
+
+    vsccGrammarSetCache(grammar, cache);
+    if (grammar->ruleCount == 0 || !vsccGrammarLink(grammar)) {
+        fprintf(stderr, "%s: %s\n", path, grammar->ruleCount == 0 ? "grammar is empty" : "grammar linking failed");
+        vsccGrammarDtor(grammar);
+        return NULL;
+    }
+    return grammar;
+} // vsccLoadGrammar
+
+/**
+ * @brief path comparator (for qsort)
+ *
+ * @param[in] lhs first path pointer (char **)
+ * @param[in] rhs second path pointer (char **)
+ *
+ * @return comparison result
+ */
+static int vsccPathCompare( const void *lhs, const void *rhs ) {
+    return strcmp(*(char *const *)lhs, *(char *const *)rhs);
+} // vsccPathCompare
+
+/**
+ * @brief path adding function
+ *
+ * @param[in,out] paths path array (VsccArray of char *, non-null)
+ * @param[in]     path  path to add (non-null, recursively added if it is directory)
+ *
+ * @return true if added, false if allocation failed
+ */
+static bool vsccCollectPaths( VsccArray *paths, const char *path ) {
+    struct stat status;
+    DIR *directory = NULL;
+
+    // unreadable paths are passed to reader, so they are reported as failed files
+    if (stat(path, &status) != 0 || !S_ISDIR(status.st_mode) || (directory = opendir(path)) == NULL) {
+        char *copy = strdup(path);
+
+        if (copy != NULL && vsccArrayPush(paths, &copy))
+            return true;
+        free(copy);
+        return false;
+    }
+
+    const size_t pathLength = strlen(path);
+    const size_t first = vsccArraySize(*paths);
+    bool collected = true;
+
+    for (struct dirent *entry; collected && (entry = readdir(directory)) != NULL; ) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+            continue;
+
+        const size_t nameLength = strlen(entry->d_name);
+        char *child = (char *)malloc(pathLength + nameLength + 2);
+
+        if (child == NULL) {
+            collected = false;
+            break;
+        }
+        memcpy(child, path, pathLength);
+        child[pathLength] = '/';
+        memcpy(child + pathLength + 1, entry->d_name, nameLength + 1);
+
+        collected = vsccCollectPaths(paths, child);
+        free(child);
+    }
+    closedir(directory);
+
+    // directory order is file system dependent, so report order is made stable
+    qsort(
+        (char **)vsccArrayData(*paths) + first,
+        vsccArraySize(*paths) - first,
+        sizeof(char *),
+        vsccPathCompare
+    );
+
+    return collected;
+} // vsccCollectPaths
+
+/**
+ * @brief batch acquiring function (called by reader)
+ *
+ * @param[in,out] pipeline pipeline (non-null)
+ * @param[in]     slot     batch slot
+ *
+ * @return true if acquired, false if checker stopped
+ */
+static bool vsccCheckReaderAcquire( VsccCheckPipeline *pipeline, size_t slot ) {
+    VsccCheckBatch *batch = &pipeline->batches[slot];
+
+    pthread_mutex_lock(&pipeline->mutex);
+    while (batch->ready && !pipeline->stopped)
+        pthread_cond_wait(&pipeline->changed, &pipeline->mutex);
+    const bool acquired = !pipeline->stopped;
+    pthread_mutex_unlock(&pipeline->mutex);
+
+    batch->size = 0;
+    vsccArrayTruncate(batch->files, 0);
+    return acquired;
+} // vsccCheckReaderAcquire
+
+/**
+ * @brief batch publishing function (called by reader)
+ *
+ * @param[in,out] pipeline pipeline (non-null)
+ * @param[in]     slot     batch slot
+ * @param[in]     done     true if batch is the last one
+ */
+static void vsccCheckReaderPublish( VsccCheckPipeline *pipeline, size_t slot, bool done ) {
+    pthread_mutex_lock(&pipeline->mutex);
+    pipeline->batches[slot].ready = vsccArraySize(pipeline->batches[slot].files) != 0;
+    pipeline->done = done;
+    pthread_cond_broadcast(&pipeline->changed);
+    pthread_mutex_unlock(&pipeline->mutex);
+} // vsccCheckReaderPublish
+
+/**
+ * @brief single file reading function (called by reader)
+ *
+ * @param[in,out] batch batch to read file to (non-null, must have room for VSCC_CHECK_MAP_THRESHOLD bytes if file is small)
+ * @param[in,out] file  file (non-null, path is set, rest is set by function)
+ * @param[in]     fd    file descriptor
+ * @param[in]     size  file size
+ */
+static void vsccCheckReaderLoad( VsccCheckBatch *batch, VsccCheckFile *file, int fd, size_t size ) {
+    if (size >= VSCC_CHECK_MAP_THRESHOLD) {
+        void *mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (mapping == MAP_FAILED) {
+            file->error = errno;
+            return;
+        }
+
+        // kernel reads ahead of sequential matching, so large files are parsed while they are being read
+        madvise(mapping, size, MADV_SEQUENTIAL);
+        file->text = (const char *)mapping;
+        file->size = size;
+        file->mapped = true;
+        return;
+    }
+
+    char *text = batch->buffer + batch->size;
+    size_t length = 0;
+
+    while (length < size) {
+        const ssize_t count = read(fd, text + length, size - length);
+
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count < 0) {
+            file->error = errno;
+            return;
+        }
+        if (count == 0)
+            break;
+        length += count;
+    }
+
+    file->text = text;
+    file->size = length;
+    batch->size += length;
+} // vsccCheckReaderLoad
+
+/**
+ * @brief reader thread function
+ *
+ * @param[in,out] context pipeline (VsccCheckPipeline *)
+ *
+ * @note small files are read to batch buffers, large ones are mapped. Reader fills one batch while
+ *       checker matches other one, so reading is overlapped with matching.
+ *
+ * @return NULL
+ */
+static void * vsccCheckReader( void *context ) {
+    VsccCheckPipeline *pipeline = (VsccCheckPipeline *)context;
+    size_t slot = 0;
+    bool running = vsccCheckReaderAcquire(pipeline, slot);
+
+    for (size_t i = 0; running && i < pipeline->pathCount; i++) {
+        VsccCheckFile file = {
+            .path   = pipeline->paths[i],
+            .text   = NULL,
+            .size   = 0,
+            .mapped = false,
+            .error  = 0,
+        };
+        struct stat status;
+        const int fd = open(file.path, O_RDONLY);
+
+        if (fd < 0 || fstat(fd, &status) != 0)
+            file.error = errno;
+        else if (S_ISDIR(status.st_mode))
+            file.error = EISDIR;
+
+        const size_t size = file.error == 0 ? (size_t)status.st_size : 0;
+        VsccCheckBatch *batch = &pipeline->batches[slot];
+
+        // small file doesn't fit, so current batch is handed to checker
+        if (size < VSCC_CHECK_MAP_THRESHOLD && batch->size + size > VSCC_CHECK_BATCH_SIZE) {
+            vsccCheckReaderPublish(pipeline, slot, false);
+            slot ^= 1;
+            batch = &pipeline->batches[slot];
+            running = vsccCheckReaderAcquire(pipeline, slot);
+        }
+
+        if (running && file.error == 0)
+            vsccCheckReaderLoad(batch, &file, fd, size);
+        if (fd >= 0)
+            close(fd);
+
+        if (!running || !vsccArrayPush(&batch->files, &file)) {
+            if (file.mapped)
+                munmap((void *)file.text, file.size);
+            break;
+        }
+
+        // mapped file is matched as soon as possible, as its pages are read during matching anyway
+        if (file.mapped || vsccArraySize(batch->files) >= VSCC_CHECK_BATCH_FILES) {
+            vsccCheckReaderPublish(pipeline, slot, false);
+            slot ^= 1;
+            running = vsccCheckReaderAcquire(pipeline, slot);
+        }
+    }
+
+    vsccCheckReaderPublish(pipeline, slot, true);
+    return NULL;
+} // vsccCheckReader
+
+/**
+ * @brief single file checking function
+ *
+ * @param[in,out] checker checker (non-null)
+ * @param[in]     file    file to check (non-null)
+ */
+static void vsccCheckFile( VsccChecker *checker, const VsccCheckFile *file ) {
+    if (file->error != 0) {
+        printf("FAIL %s: %s\n", file->path, strerror(file->error));
+        checker->failed++;
+        return;
+    }
+
+    const char *strEnd = file->text + file->size;
+    size_t length = 0;
+
+    checker->bytes += file->size;
+
+    // JIT only recognizes, so matcher reruns rejected files to locate error
+    const VsccMatchStatus jitStatus = checker->jit != NULL
+        ? vsccJitMatch(checker->jit, checker->ruleIndex, file->text, strEnd, &length)
+        : VSCC_MATCH_FAILED
+    ;
+
+    if (jitStatus == VSCC_MATCH_OK && length == file->size) {
+        if (!checker->quiet)
+            printf("PASS %s\n", file->path);
+        checker->passed++;
+        return;
+    }
+
+    // matcher frames are larger than JIT ones, so input too deep for JIT is too deep for matcher too
+    const VsccMatchStatus status = jitStatus == VSCC_MATCH_TOO_DEEP
+        ? VSCC_MATCH_TOO_DEEP
+        : vsccMatcherRun(checker->matcher, checker->ruleIndex, file->text, strEnd)
+    ;
+
+    if (status == VSCC_MATCH_OK) {
+        if (!checker->quiet)
+            printf("PASS %s\n", file->path);
+        checker->passed++;
+        return;
+    }
+    checker->failed++;
+
+    switch (status) {
+    case VSCC_MATCH_INTERNAL_ERROR:
+        printf("FAIL %s: internal error\n", file->path);
+        break;
+
+    case VSCC_MATCH_TOO_DEEP:
+        printf("FAIL %s: nesting too deep\n", file->path);
+        break;
+
+    // matcher requires whole file to match, so partial matches are failures located at farthest failure
+    case VSCC_MATCH_OK:
+    case VSCC_MATCH_RECOVERED:
+    case VSCC_MATCH_FAILED:
+        printf("FAIL %s: ", file->path);
+        vsccMatcherPrintErrors(stdout, checker->matcher);
+        break;
+    }
+} // vsccCheckFile
+
+/**
+ * @brief files checking function
+ *
+ * @param[in,out] checker   checker (non-null)
+ * @param[in]     paths     paths of files to check
+ * @param[in]     pathCount count of paths
+ *
+ * @return true if all files were processed, false if pipeline allocation failed
+ */
+static bool vsccCheckFiles( VsccChecker *checker, const char * const *paths, size_t pathCount ) {
+    VsccCheckPipeline pipeline;
+    bool checked = false;
+    pthread_t reader;
+
+    pthread_mutex_init(&pipeline.mutex, NULL);
+    pthread_cond_init(&pipeline.changed, NULL);
+    pipeline.done = false;
+    pipeline.stopped = false;
+    pipeline.paths = paths;
+    pipeline.pathCount = pathCount;
+
+    for (size_t i = 0; i < 2; i++) {
+        pipeline.batches[i].buffer = (char *)malloc(VSCC_CHECK_BATCH_SIZE);
+        pipeline.batches[i].size = 0;
+        pipeline.batches[i].files = vsccArrayCtor(sizeof(VsccCheckFile), NULL);
+        pipeline.batches[i].ready = false;
+    }
+
+    if (false
+        || pipeline.batches[0].buffer == NULL
+        || pipeline.batches[1].buffer == NULL
+        || pipeline.batches[0].files == NULL
+        || pipeline.batches[1].files == NULL
+        || pthread_create(&reader, NULL, vsccCheckReader, &pipeline) != 0
+    )
+        goto vsccCheckFiles_end;
+
+    for (size_t slot = 0; ; slot ^= 1) {
+        VsccCheckBatch *batch = &pipeline.batches[slot];
+
+        pthread_mutex_lock(&pipeline.mutex);
+        while (!batch->ready && !pipeline.done)
+            pthread_cond_wait(&pipeline.changed, &pipeline.mutex);
+        const bool ready = batch->ready;
+        pthread_mutex_unlock(&pipeline.mutex);
+
+        if (!ready)
+            break;
+
+        const VsccCheckFile *files = (const VsccCheckFile *)vsccArrayData(batch->files);
+
+        for (size_t i = 0; i < vsccArraySize(batch->files); i++) {
+            vsccCheckFile(checker, &files[i]);
+            if (files[i].mapped)
+                munmap((void *)files[i].text, files[i].size);
+        }
+
+        pthread_mutex_lock(&pipeline.mutex);
+        batch->ready = false;
+        pthread_cond_broadcast(&pipeline.changed);
+        pthread_mutex_unlock(&pipeline.mutex);
+    }
+
+    pthread_mutex_lock(&pipeline.mutex);
+    pipeline.stopped = true;
+    pthread_cond_broadcast(&pipeline.changed);
+    pthread_mutex_unlock(&pipeline.mutex);
+    pthread_join(reader, NULL);
+
+    checked = checker->passed + checker->failed == pathCount;
+
+vsccCheckFiles_end:
+    for (size_t i = 0; i < 2; i++) {
+        free(pipeline.batches[i].buffer);
+        vsccArrayDtor(pipeline.batches[i].files);
+    }
+    pthread_cond_destroy(&pipeline.changed);
+    pthread_mutex_destroy(&pipeline.mutex);
+    return checked;
+} // vsccCheckFiles
+
+/**
+ * @brief 'check' command function
+ *
+ * @param[in] name      executable name
+ * @param[in] argc      count of command arguments
+ * @param[in] argv      command arguments
+ *
+ * @return exit status (0 if all files passed, 1 if some failed, 2 if checking is impossible)
+ */
+static int vsccCheckMain( const char *name, int argc, const char **argv ) {
+    const char *ruleName = NULL;
+    const char *cachePath = NULL;
+    const char *grammarPath = NULL;
+    bool quiet = false;
+    bool pruneCache = false;
+    int argi = 0;
+
+    for (; argi < argc && argv[argi][0] == '-' && argv[argi][1] == '-'; argi++) {
+        if (strcmp(argv[argi], "--quiet") == 0) {
+            quiet = true;
+        } else if (strcmp(argv[argi], "--rule") == 0 && argi + 1 < argc) {
+            ruleName = argv[++argi];
+        } else if (strcmp(argv[argi], "--cache") == 0 && argi + 1 < argc) {
+            cachePath = argv[++argi];
+        } else if (strcmp(argv[argi], "--prune-cache") == 0) {
+            pruneCache = true;
+        } else {
+            vsccPrintUsage(stderr, name);
+            return 2;
+        }
+    }
+
+    if (argc - argi < 2) {
+        vsccPrintUsage(stderr, name);
+        return 2;
+    }
+    grammarPath = argv[argi++];
+
+    int exitStatus = 2;
+    VsccCache cache = cachePath == NULL ? NULL : vsccCacheCtor(cachePath);
+    VsccGrammar *grammar = NULL;
+    VsccArray paths = vsccArrayCtor(sizeof(char *), NULL);
+    VsccChecker checker = {
+        .grammar   = NULL,
+        .ruleIndex = 0,
+        .jit       = NULL,
+        .matcher   = NULL,
+        .quiet     = quiet,
+        .passed    = 0,
+        .failed    = 0,
+        .bytes     = 0,
     };
+    double startTime = 0.0, time = 0.0;
+
+    if ((cachePath != NULL && cache == NULL) || paths == NULL || (grammar = vsccLoadGrammar(grammarPath, cache)) == NULL)
+        goto vsccCheckMain_end;
+    // entries of other grammars sharing cache file are kept unless pruning is asked for
+    if (cache != NULL)
+        vsccCacheSave(cache, pruneCache);
+
+    checker.grammar = grammar;
+    checker.ruleIndex = ruleName == NULL ? 0 : vsccGrammarFindRule(grammar, ruleName);
+    if (checker.ruleIndex == grammar->ruleCount) {
+        fprintf(stderr, "%s: no rule named '%s'\n", grammarPath, ruleName);
+        goto vsccCheckMain_end;
+    }
+
+    checker.jit = vsccJitCtor(grammar, NULL);
+    checker.matcher = vsccMatcherCtor(grammar, NULL);
+    if (checker.matcher == NULL) {
+        fprintf(stderr, "matcher construction failed\n");
+        goto vsccCheckMain_end;
+    }
+    vsccMatcherSetRequireEnd(checker.matcher, true);
+
+    for (; argi < argc; argi++) {
+        if (!vsccCollectPaths(&paths, argv[argi])) {
+            fprintf(stderr, "%s: path collecting failed\n", argv[argi]);
+            goto vsccCheckMain_end;
+        }
+    }
 
-    VsccRule *seq = vsccRuleOptional(vsccRuleSequence(rules, 4));
+    startTime = vsccGetTime();
+    if (!vsccCheckFiles(&checker, (const char * const *)vsccArrayData(paths), vsccArraySize(paths))) {
+        fprintf(stderr, "file checking failed\n");
+        goto vsccCheckMain_end;
+    }
+    time = vsccGetTime() - startTime;
+
+    printf("%zu files, %zu passed, %zu failed, %zu bytes in %.3f s (%.1f MB/s, %.0f files/s)\n",
+        checker.passed + checker.failed,
+        checker.passed,
+        checker.failed,
+        checker.bytes,
+        time,
+        time > 0.0 ? checker.bytes / time * 1e-6 : 0.0,
+        time > 0.0 ? (checker.passed + checker.failed) / time : 0.0
+    );
+    exitStatus = checker.failed == 0 ? 0 : 1;
+
+vsccCheckMain_end:
+    if (paths != NULL)
+        for (size_t i = 0; i < vsccArraySize(paths); i++)
+            free(((char **)vsccArrayData(paths))[i]);
+    vsccArrayDtor(paths);
+    vsccMatcherDtor(checker.matcher);
+    vsccJitDtor(checker.jit);
+    vsccGrammarDtor(grammar);
+    vsccCacheDtor(cache);
+    return exitStatus;
+} // vsccCheckMain
+
+/**
+ * @brief main project function
+ *
+ * @param[in] argc count of command line arguments
+ * @param[in] argv command line arguments
+ *
+ * @return exit status
+ */
+int main( int argc, const char **argv ) {
+    const char *name = argc > 0 ? argv[0] : "vscc";
 
-    printf("seq ::= ");
-    vsccRulePrint(stdout, seq);
-    printf("\n");
+    // per-file lines are written by big blocks if they don't go to terminal
+    if (!isatty(STDOUT_FILENO))
+        setvbuf(stdout, NULL, _IOFBF, (size_t)1 << 16);
 
-    vsccRuleDtor(seq);
+    if (argc >= 2 && strcmp(argv[1], "check") == 0)
+        return vsccCheckMain(name, argc - 2, argv + 2);
 
-    return 0;
+    vsccPrintUsage(argc >= 2 && strcmp(argv[1], "help") == 0 ? stdout : stderr, name);
+    return argc >= 2 && strcmp(argv[1], "help") == 0 ? 0 : 2;
 } // main
 
 // vscc_main.c
@@ -0,0 +1,1559 @@
+/**
+ * @brief grammar matcher implementation file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "vscc.h"
+
+/// @brief matcher error internal representation
+typedef struct __VsccMatcherErrorImpl {
+    size_t offset;        ///< farthest failure offset
+    size_t expectedBegin; ///< index of first expected terminal id in expected id array
+    size_t expectedCount; ///< count of expected terminals
+} VsccMatcherErrorImpl;
+
+/// @brief memo slot of rule that isn't memoized
+#define VSCC_MATCHER_NO_MEMO UINT32_MAX
+
+/// @brief memo entry length of entry without result
+#define VSCC_MATCHER_MEMO_EMPTY UINT32_MAX
+
+/// @brief memo entry length of failed rule
+#define VSCC_MATCHER_MEMO_FAILED (UINT32_MAX - 1)
+
+/// @brief default stack size matching may use
+#define VSCC_MATCHER_STACK_SIZE ((size_t)4 << 20)
+
+/// @brief initial count of memo table rows (power of 2)
+#define VSCC_MATCHER_MEMO_INITIAL_ROWS 64
+
+/// @brief memoized rule result (fields are 32-bit to keep memo rows compact)
+typedef struct __VsccMatcherMemoEntry {
+    uint32_t length;     ///< matched length (VSCC_MATCHER_MEMO_FAILED if rule failed, VSCC_MATCHER_MEMO_EMPTY if there is no result)
+    uint32_t farthest;   ///< farthest failure offset after match relative to entry offset (saturated)
+    uint32_t epoch;      ///< failure state epoch result is recorded in (lowest bit is set if recorded while probing)
+    uint32_t valueBegin; ///< index of first rule value in memo value pool
+    uint32_t valueCount; ///< count of rule values
+} VsccMatcherMemoEntry;
+
+/// @brief stash state index of state that still shares live expected terminal bitset
+#define VSCC_MATCHER_STASH_PENDING SIZE_MAX
+
+/// @brief stash state index of state with empty expected terminal bitset
+#define VSCC_MATCHER_STASH_EMPTY (SIZE_MAX - 1)
+
+/// @brief saved farthest failure state of active recovery rule
+typedef struct __VsccMatcherStash {
+    size_t farthest; ///< farthest failure offset
+    size_t words;    ///< index of expected terminal bitset in stash word pool (or VSCC_MATCHER_STASH_PENDING/VSCC_MATCHER_STASH_EMPTY)
+    bool   stale;    ///< expected terminal bitset staleness
+} VsccMatcherStash;
+
+/// @brief set of input elements rule match may start with (resynchronization probe filter)
+typedef struct __VsccMatcherStartSet {
+    bool       built;    ///< true if set is built
+    bool       any;      ///< true if rule may match empty input, so it may start anywhere
+    uint64_t   bytes[4]; ///< bitset of first text bytes (first token text bytes in token mode)
+    uint64_t * kinds;    ///< bitset of first token kinds (token mode only)
+} VsccMatcherStartSet;
+
+/// @brief matcher internal representation
+typedef struct __VsccMatcherImpl {
+    const VsccGrammar * grammar;           ///< grammar to match by
+    const char        * textBegin;         ///< matched text begin
+    const char        * textEnd;           ///< matched text end
+    bool                tokenMode;         ///< true if token stream is matched (positions are token indices)
+    const VsccToken   * tokens;            ///< matched tokens (token mode)
+    size_t              tokenCount;        ///< count of matched tokens (token mode)
+    size_t              length;            ///< matched prefix length
+
+    size_t              farthest;          ///< farthest failure offset
+    uint64_t          * expected;          ///< bitset of terminals (and token rules after them) expected at farthest failure offset
+    size_t              expectedWordCount; ///< count of words in expected terminal bitset
+    bool                expectedStale;     ///< true if expected terminal bitset is reset logically, but not cleared yet
+    VsccArray           stash;             ///< saved farthest failure states of active recovery rules (VsccMatcherStash)
+    VsccArray           stashWords;        ///< expected terminal bitsets of saved states (uint64_t)
+    size_t              stashPending;      ///< count of saved states on stash top that still share live bitset
+    VsccMatcherStartSet * startSets;       ///< resynchronization probe filters by rule index, token mode ones go second (built on first use)
+
+    bool                probing;           ///< true if matcher probes resynchronization points
+    bool                internalError;     ///< true if internal error occured during matching
+    bool                tooDeep;           ///< true if matching was aborted because input nests too deep
+    bool                requireEnd;        ///< true if run fails unless whole input is matched
+    size_t              stackSize;         ///< stack size matching may use
+    uintptr_t           stackLimit;        ///< lowest stack address matching may reach
+    size_t              errorLimit;        ///< maximal count of errors to report
+    VsccArray           errors;            ///< reported errors (VsccMatcherErrorImpl)
+    VsccArray           expectedIds;       ///< expected terminal ids of reported errors (size_t)
+
+    VsccArray           values;            ///< semantic value stack (void *)
+    VsccLazyDfa       * dfas;              ///< lazy DFAs of grammar terminal alternation automata (built on first use)
+
+    bool                lineIndexBuilt;    ///< true if line index is built for current text
+    VsccArray           lineStarts;        ///< line start offsets (size_t)
+
+    uint32_t          * memoSlots;         ///< memo row slot by rule index (VSCC_MATCHER_NO_MEMO if rule isn't memoized)
+    size_t              memoSlotCount;     ///< count of memoized rules (memo row length)
+    VsccMemoStats     * memoStats;         ///< memoization statistics by rule index
+    VsccMatcherMemoEntry * memoEntries;    ///< memo table (row per offset, rows are reused for offsets before commit point)
+    size_t            * memoOffsets;       ///< offsets memo rows hold (SIZE_MAX if row is empty)
+    size_t              memoRowCount;      ///< count of memo rows (power of 2)
+    VsccArray           memoValues;        ///< values of memoized results (void *)
+    size_t              memoValueLimit;    ///< memo value pool size pool is compacted at
+    size_t              memoPeakSize;      ///< peak memo table size in bytes
+    size_t              commit;            ///< offset of outermost active choice point (SIZE_MAX if none), matcher never backtracks before it
+    uint32_t            epoch;             ///< failure state epoch (incremented by 2 each time failure state is reset)
+
+    const VsccAllocator * allocator;       ///< allocator of matcher memory (nullable)
+} VsccMatcherImpl;
+
+/**
+ * @brief memo table resetting function
+ *
+ * @param[in,out] self matcher (non-null)
+ *
+ * @note memo slots are reassigned by rule memo slots set, table is reallocated with initial size
+ *
+ * @return true if reset, false if allocation failed (memoization is disabled then)
+ */
+static bool vsccMatcherMemoReset( VsccMatcherImpl *self ) {
+    vsccDeallocate(self->allocator, self->memoEntries);
+    vsccDeallocate(self->allocator, self->memoOffsets);
+    self->memoEntries = NULL;
+    self->memoOffsets = NULL;
+    self->memoRowCount = 0;
+    self->memoSlotCount = 0;
+
+    for (size_t i = 0; i < self->grammar->ruleCount; i++)
+        if (self->memoSlots[i] != VSCC_MATCHER_NO_MEMO)
+            self->memoSlots[i] = (uint32_t)self->memoSlotCount++;
+
+    if (self->memoSlotCount == 0)
+        return true;
+
+    self->memoEntries = (VsccMatcherMemoEntry *)vsccAllocateZeroed(self->allocator, VSCC_MATCHER_MEMO_INITIAL_ROWS * self->memoSlotCount, sizeof(VsccMatcherMemoEntry));
+    self->memoOffsets = (size_t *)vsccAllocate(self->allocator, VSCC_MATCHER_MEMO_INITIAL_ROWS * sizeof(size_t));
+
+    if (self->memoEntries == NULL || self->memoOffsets == NULL) {
+        vsccDeallocate(self->allocator, self->memoEntries);
+        vsccDeallocate(self->allocator, self->memoOffsets);
+        self->memoEntries = NULL;
+        self->memoOffsets = NULL;
+        self->memoSlotCount = 0;
+        for (size_t i = 0; i < self->grammar->ruleCount; i++)
+            self->memoSlots[i] = VSCC_MATCHER_NO_MEMO;
+        return false;
+    }
+
+    self->memoRowCount = VSCC_MATCHER_MEMO_INITIAL_ROWS;
+    memset(self->memoOffsets, 0xFF, self->memoRowCount * sizeof(size_t));
+    return true;
+} // vsccMatcherMemoReset
+
+VsccMatcher vsccMatcherCtor( const VsccGrammar *grammar, const VsccAllocator *allocator ) {
+    assert(grammar != NULL);
+    assert(grammar->linked);
+
+    VsccMatcher matcher = (VsccMatcher)vsccAllocateZeroed(allocator, 1, sizeof(VsccMatcherImpl));
+
+    if (matcher == NULL)
+        return NULL;
+
+    matcher->allocator = allocator;
+    matcher->grammar = grammar;
+    matcher->errorLimit = 16;
+    matcher->stackSize = VSCC_MATCHER_STACK_SIZE;
+    matcher->expectedWordCount = (grammar->terminalCount + grammar->ruleCount + 63) / 64 + 1;
+    matcher->expected = (uint64_t *)vsccAllocateZeroed(allocator, matcher->expectedWordCount, sizeof(uint64_t));
+    matcher->stash = vsccArrayCtor(sizeof(VsccMatcherStash), allocator);
+    matcher->stashWords = vsccArrayCtor(sizeof(uint64_t), allocator);
+    matcher->errors = vsccArrayCtor(sizeof(VsccMatcherErrorImpl), allocator);
+    matcher->expectedIds = vsccArrayCtor(sizeof(size_t), allocator);
+    matcher->lineStarts = vsccArrayCtor(sizeof(size_t), allocator);
+    matcher->values = vsccArrayCtor(sizeof(void *), allocator);
+    matcher->dfas = (VsccLazyDfa *)vsccAllocateZeroed(allocator, grammar->automatonCount + 1, sizeof(VsccLazyDfa));
+    matcher->memoSlots = (uint32_t *)vsccAllocateZeroed(allocator, grammar->ruleCount + 1, sizeof(uint32_t));
+    matcher->memoStats = (VsccMemoStats *)vsccAllocateZeroed(allocator, grammar->ruleCount + 1, sizeof(VsccMemoStats));
+    matcher->memoValues = vsccArrayCtor(sizeof(void *), allocator);
+
+    if (false
+        || matcher->expected == NULL
+        || matcher->stash == NULL
+        || matcher->stashWords == NULL
+        || matcher->errors == NULL
+        || matcher->expectedIds == NULL
+        || matcher->lineStarts == NULL
+        || matcher->values == NULL
+        || matcher->dfas == NULL
+        || matcher->memoSlots == NULL
+        || matcher->memoStats == NULL
+        || matcher->memoValues == NULL
+    ) {
+        vsccMatcherDtor(matcher);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < grammar->ruleCount; i++)
+        matcher->memoSlots[i] = grammar->rules[i].memoize && !grammar->rules[i].recover
+            ? 0
+            : VSCC_MATCHER_NO_MEMO
+        ;
+
+    if (!vsccMatcherMemoReset(matcher)) {
+        vsccMatcherDtor(matcher);
+        return NULL;
+    }
+
+    return matcher;
+} // vsccMatcherCtor
+
+void vsccMatcherDtor( VsccMatcher matcher ) {
+    if (matcher == NULL)
+        return;
+
+    vsccDeallocate(matcher->allocator, matcher->expected);
+    vsccArrayDtor(matcher->stash);
+    vsccArrayDtor(matcher->stashWords);
+    if (matcher->startSets != NULL)
+        for (size_t i = 0; i < matcher->grammar->ruleCount * 2; i++)
+            vsccDeallocate(matcher->allocator, matcher->startSets[i].kinds);
+    vsccDeallocate(matcher->allocator, matcher->startSets);
+    vsccArrayDtor(matcher->errors);
+    vsccArrayDtor(matcher->expectedIds);
+    vsccArrayDtor(matcher->lineStarts);
+    vsccArrayDtor(matcher->values);
+    if (matcher->dfas != NULL)
+        for (size_t i = 0; i < matcher->grammar->automatonCount; i++)
+            vsccLazyDfaDtor(matcher->dfas[i]);
+    vsccDeallocate(matcher->allocator, matcher->dfas);
+    vsccDeallocate(matcher->allocator, matcher->memoSlots);
+    vsccDeallocate(matcher->allocator, matcher->memoStats);
+    vsccDeallocate(matcher->allocator, matcher->memoEntries);
+    vsccDeallocate(matcher->allocator, matcher->memoOffsets);
+    vsccArrayDtor(matcher->memoValues);
+    vsccDeallocate(matcher->allocator, matcher);
+} // vsccMatcherDtor
+
+void vsccMatcherSetErrorLimit( VsccMatcher matcher, size_t limit ) {
+    assert(matcher != NULL);
+    assert(limit >= 1);
+
+    matcher->errorLimit = limit;
+} // vsccMatcherSetErrorLimit
+
+void vsccMatcherSetRequireEnd( VsccMatcher matcher, bool requireEnd ) {
+    assert(matcher != NULL);
+
+    matcher->requireEnd = requireEnd;
+} // vsccMatcherSetRequireEnd
+
+void vsccMatcherSetStackSize( VsccMatcher matcher, size_t size ) {
+    assert(matcher != NULL);
+
+    matcher->stackSize = size;
+} // vsccMatcherSetStackSize
+
+bool vsccMatcherSetMemo( VsccMatcher matcher, size_t ruleIndex, bool memoize ) {
+    assert(matcher != NULL);
+    assert(ruleIndex < matcher->grammar->ruleCount);
+
+    matcher->memoSlots[ruleIndex] = memoize && !matcher->grammar->rules[ruleIndex].recover
+        ? 0
+        : VSCC_MATCHER_NO_MEMO
+    ;
+    return vsccMatcherMemoReset(matcher);
+} // vsccMatcherSetMemo
+
+VsccMemoStats vsccMatcherMemoStats( const VsccMatcher matcher, size_t ruleIndex ) {
+    assert(matcher != NULL);
+    assert(ruleIndex < matcher->grammar->ruleCount);
+
+    return matcher->memoStats[ruleIndex];
+} // vsccMatcherMemoStats
+
+bool vsccMatcherApplyMemoProfile( VsccMatcher matcher ) {
+    assert(matcher != NULL);
+
+    for (size_t i = 0; i < matcher->grammar->ruleCount; i++)
+        if (matcher->memoStats[i].hits == 0)
+            matcher->memoSlots[i] = VSCC_MATCHER_NO_MEMO;
+    memset(matcher->memoStats, 0, matcher->grammar->ruleCount * sizeof(VsccMemoStats));
+
+    return vsccMatcherMemoReset(matcher);
+} // vsccMatcherApplyMemoProfile
+
+size_t vsccMatcherMemoSize( const VsccMatcher matcher ) {
+    assert(matcher != NULL);
+
+    return matcher->memoPeakSize;
+} // vsccMatcherMemoSize
+
+/**
+ * @brief memo table size updating function
+ *
+ * @param[in,out] self matcher (non-null)
+ */
+static void vsccMatcherMemoUpdateSize( VsccMatcherImpl *self ) {
+    const size_t size = 0
+        + self->memoRowCount * (self->memoSlotCount * sizeof(VsccMatcherMemoEntry) + sizeof(size_t))
+        + vsccArraySize(self->memoValues) * sizeof(void *)
+    ;
+
+    if (size > self->memoPeakSize)
+        self->memoPeakSize = size;
+} // vsccMatcherMemoUpdateSize
+
+/**
+ * @brief memo table growing function
+ *
+ * @param[in,out] self matcher (non-null)
+ *
+ * @return true if grown, false if allocation failed
+ */
+static bool vsccMatcherMemoGrow( VsccMatcherImpl *self ) {
+    const size_t rowCount = self->memoRowCount * 2;
+    const size_t slotCount = self->memoSlotCount;
+    VsccMatcherMemoEntry *entries = (VsccMatcherMemoEntry *)vsccAllocate(self->allocator, rowCount * slotCount * sizeof(VsccMatcherMemoEntry));
+    size_t *offsets = (size_t *)vsccAllocate(self->allocator, rowCount * sizeof(size_t));
+
+    if (entries == NULL || offsets == NULL) {
+        vsccDeallocate(self->allocator, entries);
+        vsccDeallocate(self->allocator, offsets);
+        return false;
+    }
+    memset(offsets, 0xFF, rowCount * sizeof(size_t));
+
+    // rows of distinct offsets never collide in twice larger table
+    for (size_t i = 0; i < self->memoRowCount; i++) {
+        if (self->memoOffsets[i] == SIZE_MAX)
+            continue;
+
+        const size_t row = self->memoOffsets[i] & (rowCount - 1);
+
+        offsets[row] = self->memoOffsets[i];
+        memcpy(entries + row * slotCount, self->memoEntries + i * slotCount, slotCount * sizeof(VsccMatcherMemoEntry));
+    }
+
+    vsccDeallocate(self->allocator, self->memoEntries);
+    vsccDeallocate(self->allocator, self->memoOffsets);
+    self->memoEntries = entries;
+    self->memoOffsets = offsets;
+    self->memoRowCount = rowCount;
+    vsccMatcherMemoUpdateSize(self);
+
+    return true;
+} // vsccMatcherMemoGrow
+
+/**
+ * @brief memo row getting function
+ *
+ * @param[in,out] self   matcher (non-null)
+ * @param[in]     offset offset to get row of
+ *
+ * @note rows of offsets before both commit point and row offset are reused, as matcher never
+ *       returns to them, table grows only if it is too small to hold all rows that may be read again
+ *
+ * @return memo row (NULL if allocation failed)
+ */
+static VsccMatcherMemoEntry * vsccMatcherMemoRow( VsccMatcherImpl *self, size_t offset ) {
+    const size_t limit = self->commit < offset
+        ? self->commit
+        : offset
+    ;
+
+    for (;;) {
+        const size_t row = offset & (self->memoRowCount - 1);
+        const size_t held = self->memoOffsets[row];
+        VsccMatcherMemoEntry *entries = self->memoEntries + row * self->memoSlotCount;
+
+        if (held == offset)
+            return entries;
+
+        if (held == SIZE_MAX || held < limit) {
+            self->memoOffsets[row] = offset;
+            for (size_t i = 0; i < self->memoSlotCount; i++)
+                entries[i].length = VSCC_MATCHER_MEMO_EMPTY;
+            return entries;
+        }
+
+        if (!vsccMatcherMemoGrow(self))
+            return NULL;
+    }
+} // vsccMatcherMemoRow
+
+/**
+ * @brief memo value pool compacting function
+ *
+ * @param[in,out] self   matcher (non-null)
+ * @param[in]     offset current text offset
+ *
+ * @note rows of offsets before both commit point and current offset are never read again (see vsccMatcherMemoRow),
+ *       so they are emptied and their values are dropped, values of other rows are moved to a new pool.
+ *       Pool is compacted once it doubles since previous compaction, so compaction cost is amortized by pushes.
+ */
+static void vsccMatcherMemoCompact( VsccMatcherImpl *self, size_t offset ) {
+    const size_t limit = self->commit < offset
+        ? self->commit
+        : offset
+    ;
+    const size_t entryCount = self->memoRowCount * self->memoSlotCount;
+    const void **pool = (const void **)vsccArrayData(self->memoValues);
+    VsccArray values = vsccArrayCtor(sizeof(void *), self->allocator);
+    bool compacted = values != NULL;
+
+    // copy values first, so entries are kept intact if allocation fails
+    for (size_t row = 0; compacted && row < self->memoRowCount; row++) {
+        if (self->memoOffsets[row] == SIZE_MAX || self->memoOffsets[row] < limit)
+            continue;
+
+        const VsccMatcherMemoEntry *entries = self->memoEntries + row * self->memoSlotCount;
+
+        for (size_t slot = 0; compacted && slot < self->memoSlotCount; slot++)
+            for (size_t i = 0; compacted && entries[slot].length != VSCC_MATCHER_MEMO_EMPTY && i < entries[slot].valueCount; i++)
+                compacted = vsccArrayPush(&values, pool + entries[slot].valueBegin + i);
+    }
+
+    if (!compacted) {
+        vsccArrayDtor(values);
+        self->memoValueLimit = vsccArraySize(self->memoValues) * 2 + entryCount;
+        return;
+    }
+
+    // values are copied in the same order, so new value indices are assigned by the same traversal
+    uint32_t valueBegin = 0;
+
+    for (size_t row = 0; row < self->memoRowCount; row++) {
+        if (self->memoOffsets[row] == SIZE_MAX)
+            continue;
+
+        if (self->memoOffsets[row] < limit) {
+            self->memoOffsets[row] = SIZE_MAX;
+            continue;
+        }
+
+        VsccMatcherMemoEntry *entries = self->memoEntries + row * self->memoSlotCount;
+
+        for (size_t slot = 0; slot < self->memoSlotCount; slot++) {
+            if (entries[slot].length == VSCC_MATCHER_MEMO_EMPTY)
+                continue;
+            entries[slot].valueBegin = valueBegin;
+            valueBegin += entries[slot].valueCount;
+        }
+    }
+
+    vsccArrayDtor(self->memoValues);
+    self->memoValues = values;
+    self->memoValueLimit = vsccArraySize(values) * 2 + entryCount;
+} // vsccMatcherMemoCompact
+
+/**
+ * @brief input length getting function
+ *
+ * @param[in] self matcher (non-null)
+ *
+ * @return count of characters (or tokens in token mode) in input
+ */
+static inline size_t vsccMatcherInputLength( const VsccMatcherImpl *self ) {
+    return self->tokenMode
+        ? self->tokenCount
+        : (size_t)(self->textEnd - self->textBegin)
+    ;
+} // vsccMatcherInputLength
+
+/**
+ * @brief input position to text offset converting function
+ *
+ * @param[in] self     matcher (non-null)
+ * @param[in] position input position
+ *
+ * @return text offset position starts at
+ */
+static inline size_t vsccMatcherTextOffset( const VsccMatcherImpl *self, size_t position ) {
+    if (!self->tokenMode)
+        return position;
+    return position < self->tokenCount
+        ? self->tokens[position].offset
+        : (size_t)(self->textEnd - self->textBegin)
+    ;
+} // vsccMatcherTextOffset
+
+/**
+ * @brief pending saved failure states materializing function
+ *
+ * @param[in,out] self matcher (non-null)
+ *
+ * @note pending states share live expected terminal bitset, so it's copied once for all of them
+ *
+ * @return true if materialized, false if allocation failed
+ */
+static bool vsccMatcherStashMaterialize( VsccMatcherImpl *self ) {
+    const size_t stashSize = vsccArraySize(self->stash);
+    size_t words = VSCC_MATCHER_STASH_EMPTY;
+
+    for (size_t i = stashSize - self->stashPending; i < stashSize; i++) {
+        VsccMatcherStash *state = (VsccMatcherStash *)vsccGetArrayElement(self->stash, i);
+
+        if (state->stale) {
+            state->words = VSCC_MATCHER_STASH_EMPTY;
+            continue;
+        }
+
+        if (words == VSCC_MATCHER_STASH_EMPTY) {
+            words = vsccArraySize(self->stashWords);
+            for (size_t j = 0; j < self->expectedWordCount; j++)
+                if (!vsccArrayPush(&self->stashWords, &self->expected[j]))
+                    return false;
+        }
+        state->words = words;
+    }
+
+    self->stashPending = 0;
+    return true;
+} // vsccMatcherStashMaterialize
+
+/**
+ * @brief terminal failure registering function
+ *
+ * @param[in,out] self       matcher (non-null)
+ * @param[in]     offset     failure offset
+ * @param[in]     terminalId id of terminal failed
+ */
+static inline void vsccMatcherFail( VsccMatcherImpl *self, size_t offset, size_t terminalId ) {
+    if (offset < self->farthest)
+        return;
+
+    if (offset > self->farthest || self->expectedStale) {
+        // saved states are copied only when live bitset is actually overwritten
+        if (self->stashPending != 0 && !vsccMatcherStashMaterialize(self)) {
+            self->internalError = true;
+            return;
+        }
+        memset(self->expected, 0, self->expectedWordCount * sizeof(uint64_t));
+        self->expectedStale = false;
+        self->farthest = offset;
+    }
+    self->expected[terminalId / 64] |= (uint64_t)1 << terminalId % 64;
+} // vsccMatcherFail
+
+/**
+ * @brief farthest failure state saving function
+ *
+ * @param[in,out] self matcher (non-null)
+ *
+ * @note bitset isn't copied here, state shares live bitset until the first failure overwriting it
+ *
+ * @return true if saved, false if allocation failed
+ */
+static bool vsccMatcherSaveFarthest( VsccMatcherImpl *self ) {
+    const VsccMatcherStash state = {
+        .farthest = self->farthest,
+        .words    = VSCC_MATCHER_STASH_PENDING,
+        .stale    = self->expectedStale,
+    };
+
+    if (!vsccArrayPush(&self->stash, &state))
+        return false;
+    self->stashPending++;
+    return true;
+} // vsccMatcherSaveFarthest
+
+/**
+ * @brief farthest failure state restoring function
+ *
+ * @param[in,out] self matcher (non-null)
+ *
+ * @note saved state is merged with the current one, so farther failure wins
+ */
+static void vsccMatcherRestoreFarthest( VsccMatcherImpl *self ) {
+    VsccMatcherStash saved;
+
+    vsccArrayPop(&self->stash, &saved);
+
+    // pending state means that no failure was registered since state was saved
+    if (saved.words == VSCC_MATCHER_STASH_PENDING) {
+        self->stashPending--;
+        self->farthest = saved.farthest;
+        self->expectedStale = saved.stale;
+        return;
+    }
+
+    const uint64_t *savedWords = saved.words != VSCC_MATCHER_STASH_EMPTY
+        ? (const uint64_t *)vsccArrayData(self->stashWords) + saved.words
+        : NULL
+    ;
+
+    if (saved.farthest > self->farthest || (saved.farthest == self->farthest && self->expectedStale)) {
+        if (savedWords != NULL)
+            memcpy(self->expected, savedWords, self->expectedWordCount * sizeof(uint64_t));
+        self->expectedStale = savedWords == NULL;
+        self->farthest = saved.farthest;
+    } else if (saved.farthest == self->farthest && savedWords != NULL) {
+        for (size_t i = 0; i < self->expectedWordCount; i++)
+            self->expected[i] |= savedWords[i];
+    }
+
+    // saved bitset may be shared with states below
+    const size_t stashSize = vsccArraySize(self->stash);
+
+    if (savedWords != NULL && (stashSize == 0 || ((const VsccMatcherStash *)vsccArrayData(self->stash))[stashSize - 1].words != saved.words))
+        vsccArrayTruncate(self->stashWords, saved.words);
+} // vsccMatcherRestoreFarthest
+
+/**
+ * @brief farthest failure reporting function
+ *
+ * @param[in,out] self matcher (non-null)
+ *
+ * @return true if reported, false if allocation failed
+ */
+static bool vsccMatcherReport( VsccMatcherImpl *self ) {
+    VsccMatcherErrorImpl error = {
+        .offset        = vsccMatcherTextOffset(self, self->farthest),
+        .expectedBegin = vsccArraySize(self->expectedIds),
+        .expectedCount = 0,
+    };
+
+    for (size_t i = 0; !self->expectedStale && i < self->expectedWordCount; i++)
+        for (uint64_t word = self->expected[i]; word != 0; word &= word - 1) {
+            const size_t id = i * 64 + __builtin_ctzll(word);
+
+            if (!vsccArrayPush(&self->expectedIds, &id))
+                return false;
+            error.expectedCount++;
+        }
+
+    return vsccArrayPush(&self->errors, &error);
+} // vsccMatcherReport
+
+/**
+ * @brief rule empty input matching possibility checking function
+ *
+ * @param[in] self     matcher (non-null)
+ * @param[in] rule     rule to check (non-null)
+ * @param[in] nullable empty input matching possibility by rule index (non-null)
+ *
+ * @return true if rule may match empty input, false otherwise
+ */
+static bool vsccMatcherRuleNullable( const VsccMatcherImpl *self, const VsccRule *rule, const bool *nullable ) {
+    switch (rule->type) {
+    case VSCC_RULE_SEQUENCE:
+        for (size_t i = 0; i < rule->sequence.count; i++)
+            if (!vsccMatcherRuleNullable(self, rule->sequence.rules[i], nullable))
+                return false;
+        return true;
+
+    case VSCC_RULE_VARIANT:
+        for (size_t i = 0; i < rule->variant.count; i++)
+            if (vsccMatcherRuleNullable(self, rule->variant.rules[i], nullable))
+                return true;
+        return false;
+
+    case VSCC_RULE_OPTIONAL:
+        return true;
+
+    case VSCC_RULE_REPEAT:
+        return !rule->repeat.atLeastOnce || vsccMatcherRuleNullable(self, rule->repeat.rule, nullable);
+
+    case VSCC_RULE_STRING_TERMINAL:
+        return rule->stringTerminal.length == 0;
+
+    case VSCC_RULE_REFERENCE:
+        // token rule reference consumes a token in token mode
+        return true
+            && !(self->tokenMode && self->grammar->rules[rule->reference.index].token != VSCC_TOKEN_NONE)
+            && nullable[rule->reference.index]
+        ;
+
+    // end matches at input end only, so nothing can follow it at offsets probes are done at
+    case VSCC_RULE_CHAR_TERMINAL:
+    case VSCC_RULE_END:
+        return false;
+
+    case VSCC_RULE_EMPTY:
+        return true;
+    }
+
+    assert(false && "Unreachable case reached.");
+    return true;
+} // vsccMatcherRuleNullable
+
+/**
+ * @brief UTF-8 leading byte getting function
+ *
+ * @param[in] codePoint code point (<= VSCC_CODE_POINT_MAX)
+ *
+ * @return first byte of code point UTF-8 encoding
+ */
+static uint8_t vsccMatcherLeadByte( uint32_t codePoint ) {
+    if (codePoint < 0x80)
+        return (uint8_t)codePoint;
+    if (codePoint < 0x800)
+        return (uint8_t)(0xC0 | codePoint >> 6);
+    if (codePoint < 0x10000)
+        return (uint8_t)(0xE0 | codePoint >> 12);
+    return (uint8_t)(0xF0 | codePoint >> 18);
+} // vsccMatcherLeadByte
+
+/**
+ * @brief rule start set collecting function
+ *
+ * @param[in]     self     matcher (non-null)
+ * @param[in]     rule     rule to collect first input elements of (non-null)
+ * @param[in]     nullable empty input matching possibility by rule index (non-null)
+ * @param[in,out] visited  rule visit flags by rule index (non-null)
+ * @param[in,out] set      set to add first input elements to (non-null)
+ */
+static void vsccMatcherCollectStart( const VsccMatcherImpl *self, const VsccRule *rule, const bool *nullable, bool *visited, VsccMatcherStartSet *set ) {
+    switch (rule->type) {
+    case VSCC_RULE_SEQUENCE:
+        for (size_t i = 0; i < rule->sequence.count; i++) {
+            vsccMatcherCollectStart(self, rule->sequence.rules[i], nullable, visited, set);
+            if (!vsccMatcherRuleNullable(self, rule->sequence.rules[i], nullable))
+                break;
+        }
+        break;
+
+    case VSCC_RULE_VARIANT:
+        for (size_t i = 0; i < rule->variant.count; i++)
+            vsccMatcherCollectStart(self, rule->variant.rules[i], nullable, visited, set);
+        break;
+
+    case VSCC_RULE_OPTIONAL:
+        vsccMatcherCollectStart(self, rule->optional, nullable, visited, set);
+        break;
+
+    case VSCC_RULE_REPEAT:
+        vsccMatcherCollectStart(self, rule->repeat.rule, nullable, visited, set);
+        break;
+
+    case VSCC_RULE_STRING_TERMINAL:
+        if (rule->stringTerminal.length != 0) {
+            const uint8_t c = (uint8_t)rule->stringTerminal.string[0];
+
+            set->bytes[c / 64] |= (uint64_t)1 << c % 64;
+        }
+        break;
+
+    case VSCC_RULE_CHAR_TERMINAL:
+        set->bytes[0] |= rule->charTerminal.ascii[0];
+        set->bytes[1] |= rule->charTerminal.ascii[1];
+
+        // leading byte is monotonic in code point, so range of code points maps to range of bytes
+        for (size_t i = 0; i < rule->charTerminal.tableCount; i++) {
+            const uint8_t last = vsccMatcherLeadByte(rule->charTerminal.table[i].last);
+
+            for (uint32_t c = vsccMatcherLeadByte(rule->charTerminal.table[i].first); c <= last; c++)
+                set->bytes[c / 64] |= (uint64_t)1 << c % 64;
+        }
+        break;
+
+    case VSCC_RULE_REFERENCE: {
+        const size_t index = rule->reference.index;
+
+        if (self->tokenMode && self->grammar->rules[index].token != VSCC_TOKEN_NONE) {
+            set->kinds[index / 64] |= (uint64_t)1 << index % 64;
+            break;
+        }
+        if (!visited[index]) {
+            visited[index] = true;
+            vsccMatcherCollectStart(self, self->grammar->rules[index].rule, nullable, visited, set);
+        }
+        break;
+    }
+
+    case VSCC_RULE_END:
+    case VSCC_RULE_EMPTY:
+        break;
+    }
+} // vsccMatcherCollectStart
+
+/**
+ * @brief rule start set getting function
+ *
+ * @param[in,out] self  matcher (non-null)
+ * @param[in]     index rule index
+ *
+ * @note set is built on first request for each input mode
+ *
+ * @return start set (NULL if it couldn't be built, so any offset should be probed)
+ */
+static const VsccMatcherStartSet * vsccMatcherStartSet( VsccMatcherImpl *self, size_t index ) {
+    const size_t ruleCount = self->grammar->ruleCount;
+
+    if (self->startSets == NULL && (self->startSets = (VsccMatcherStartSet *)vsccAllocateZeroed(self->allocator, ruleCount * 2, sizeof(VsccMatcherStartSet))) == NULL)
+        return NULL;
+
+    VsccMatcherStartSet *set = &self->startSets[index + (self->tokenMode ? ruleCount : 0)];
+
+    if (set->built)
+        return set;
+
+    bool *nullable = (bool *)vsccAllocateZeroed(self->allocator, ruleCount, sizeof(bool));
+    bool *visited = (bool *)vsccAllocateZeroed(self->allocator, ruleCount, sizeof(bool));
+
+    if (self->tokenMode && set->kinds == NULL)
+        set->kinds = (uint64_t *)vsccAllocateZeroed(self->allocator, (ruleCount + 63) / 64, sizeof(uint64_t));
+
+    if (nullable == NULL || visited == NULL || (self->tokenMode && set->kinds == NULL)) {
+        vsccDeallocate(self->allocator, nullable);
+        vsccDeallocate(self->allocator, visited);
+        return NULL;
+    }
+
+    // rules are nullable by least fixed point
+    for (bool changed = true; changed; ) {
+        changed = false;
+        for (size_t i = 0; i < ruleCount; i++)
+            if (!nullable[i] && vsccMatcherRuleNullable(self, self->grammar->rules[i].rule, nullable))
+                nullable[i] = changed = true;
+    }
+
+    visited[index] = true;
+    vsccMatcherCollectStart(self, self->grammar->rules[index].rule, nullable, visited, set);
+    set->any = nullable[index];
+    set->built = true;
+
+    vsccDeallocate(self->allocator, nullable);
+    vsccDeallocate(self->allocator, visited);
+    return set;
+} // vsccMatcherStartSet
+
+/**
+ * @brief rule match start possibility checking function
+ *
+ * @param[in] self     matcher (non-null)
+ * @param[in] set      rule start set (nullable, any position is possible then)
+ * @param[in] position input position (< input length)
+ *
+ * @return true if rule match may start at position, false if it can't
+ */
+static inline bool vsccMatcherMayStart( const VsccMatcherImpl *self, const VsccMatcherStartSet *set, size_t position ) {
+    if (set == NULL || set->any)
+        return true;
+
+    if (!self->tokenMode) {
+        const uint8_t c = (uint8_t)self->textBegin[position];
+
+        return (set->bytes[c / 64] >> c % 64) & 1;
+    }
+
+    const VsccToken token = self->tokens[position];
+    const uint8_t c = token.length != 0
+        ? (uint8_t)self->textBegin[token.offset]
+        : 0
+    ;
+
+    return false
+        || (token.kind < self->grammar->ruleCount && ((set->kinds[token.kind / 64] >> token.kind % 64) & 1))
+        || (token.length != 0 && ((set->bytes[c / 64] >> c % 64) & 1))
+    ;
+} // vsccMatcherMayStart
+
+static bool vsccMatcherMatch( VsccMatcherImpl *self, const VsccRule *rule, size_t *offset );
+
+/**
+ * @brief named rule matching function
+ *
+ * @param[in,out] self   matcher (non-null)
+ * @param[in]     pair   rule to match (non-null)
+ * @param[in,out] offset current text offset (non-null)
+ *
+ * @note in case if rule has action, children values are replaced by action result on success
+ *
+ * @return true if matched, false otherwise
+ */
+static inline bool vsccMatcherMatchPair( VsccMatcherImpl *self, const VsccGrammarPair *pair, size_t *offset ) {
+    // actions are not invoked for resynchronization probes
+    if (pair->action == NULL || self->probing)
+        return vsccMatcherMatch(self, pair->rule, offset);
+
+    const size_t start = *offset;
+    const size_t base = vsccArraySize(self->values);
+
+    if (!vsccMatcherMatch(self, pair->rule, offset))
+        return false;
+
+    void *result = NULL;
+
+    // in token mode slice ends at the end of last matched token
+    const size_t textStart = vsccMatcherTextOffset(self, start);
+    const size_t textEnd = self->tokenMode && *offset > start
+        ? self->tokens[*offset - 1].offset + self->tokens[*offset - 1].length
+        : vsccMatcherTextOffset(self, *offset)
+    ;
+
+    if (!pair->action(
+        pair->actionContext,
+        self->textBegin + textStart,
+        self->textBegin + textEnd,
+        (void **)vsccArrayData(self->values) + base,
+        vsccArraySize(self->values) - base,
+        &result
+    )) {
+        self->internalError = true;
+        return false;
+    }
+
+    vsccArrayTruncate(self->values, base);
+    if (!vsccArrayPush(&self->values, &result)) {
+        self->internalError = true;
+        return false;
+    }
+    return true;
+} // vsccMatcherMatchPair
+
+/**
+ * @brief memoized rule matching function
+ *
+ * @param[in,out] self   matcher (non-null)
+ * @param[in]     index  index of rule to match (rule is memoized)
+ * @param[in,out] offset current text offset (non-null)
+ *
+ * @note memoized result is reused only if failures it registered are still present in failure state
+ *       and matches of rules with recovery errors are not memoized at all, so memoization never
+ *       changes matching results, including errors
+ *
+ * @return true if matched, false otherwise
+ */
+static bool vsccMatcherMatchMemo( VsccMatcherImpl *self, size_t index, size_t *offset ) {
+    const size_t start = *offset;
+    const uint32_t slot = self->memoSlots[index];
+    const uint32_t epoch = self->epoch;
+    const uint32_t tag = epoch | (uint32_t)self->probing;
+    const size_t row = start & (self->memoRowCount - 1);
+
+    self->memoStats[index].lookups++;
+
+    if (self->memoOffsets[row] == start) {
+        const VsccMatcherMemoEntry entry = self->memoEntries[row * self->memoSlotCount + slot];
+
+        // failures of entry are still present if failure state wasn't reset or if they're behind farthest failure
+        if (true
+            && entry.length != VSCC_MATCHER_MEMO_EMPTY
+            && (entry.epoch & 1) == (tag & 1)
+            && (entry.epoch == tag || start + entry.farthest < self->farthest)
+        ) {
+            self->memoStats[index].hits++;
+
+            if (entry.length == VSCC_MATCHER_MEMO_FAILED)
+                return false;
+
+            for (size_t i = 0; i < entry.valueCount; i++)
+                if (!vsccArrayPush(&self->values, (void **)vsccArrayData(self->memoValues) + entry.valueBegin + i)) {
+                    self->internalError = true;
+                    return false;
+                }
+            *offset = start + entry.length;
+            return true;
+        }
+    }
+
+    const size_t base = vsccArraySize(self->values);
+    const size_t errorCount = vsccArraySize(self->errors);
+    const bool matched = vsccMatcherMatchPair(self, &self->grammar->rules[index], offset);
+
+    // result depends on recovery, so it can't be reused
+    if (self->internalError || self->tooDeep || self->epoch != epoch || vsccArraySize(self->errors) != errorCount)
+        return matched;
+
+    // values of evicted rows are dropped from pool, so pool size follows memo window instead of input length
+    if (vsccArraySize(self->memoValues) >= self->memoValueLimit)
+        vsccMatcherMemoCompact(self, start);
+
+    const size_t length = *offset - start;
+    const size_t valueBegin = vsccArraySize(self->memoValues);
+    const size_t valueCount = matched
+        ? vsccArraySize(self->values) - base
+        : 0
+    ;
+    const size_t farthest = self->farthest > start
+        ? self->farthest - start
+        : 0
+    ;
+
+    // memo is optimization only, so results that don't fit into it are not memoized
+    if (length >= VSCC_MATCHER_MEMO_FAILED || valueBegin + valueCount > UINT32_MAX)
+        return matched;
+
+    VsccMatcherMemoEntry *entries = vsccMatcherMemoRow(self, start);
+
+    if (entries == NULL)
+        return matched;
+
+    for (size_t i = 0; i < valueCount; i++)
+        if (!vsccArrayPush(&self->memoValues, (void **)vsccArrayData(self->values) + base + i)) {
+            vsccArrayTruncate(self->memoValues, valueBegin);
+            return matched;
+        }
+
+    entries[slot] = (VsccMatcherMemoEntry) {
+        .length     = matched ? (uint32_t)length : VSCC_MATCHER_MEMO_FAILED,
+        .farthest   = farthest < UINT32_MAX ? (uint32_t)farthest : UINT32_MAX,
+        .epoch      = tag,
+        .valueBegin = (uint32_t)valueBegin,
+        .valueCount = (uint32_t)valueCount,
+    };
+    if (valueCount != 0)
+        vsccMatcherMemoUpdateSize(self);
+
+    return matched;
+} // vsccMatcherMatchMemo
+
+/**
+ * @brief recovering rule matching function
+ *
+ * @param[in,out] self   matcher (non-null)
+ * @param[in]     pair   rule to match (non-null, recover == true)
+ * @param[in,out] offset current text offset (non-null)
+ *
+ * @note in case if rule fails after consuming some input, error is reported and
+ *       input is skipped until the next offset rule matches at (or text end).
+ *
+ * @return true if matched or recovered, false otherwise
+ */
+static bool vsccMatcherMatchRecover( VsccMatcherImpl *self, const VsccGrammarPair *pair, size_t *offset ) {
+    const size_t start = *offset;
+    const size_t base = vsccArraySize(self->values);
+
+    // failures beyond start don't belong to this rule, so hide them while rule is matched
+    const bool stashed = self->farthest > start;
+
+    if (stashed) {
+        if (!vsccMatcherSaveFarthest(self)) {
+            self->internalError = true;
+            return false;
+        }
+        self->expectedStale = true;
+        self->farthest = start;
+        self->epoch += 2;
+    }
+
+    if (vsccMatcherMatchPair(self, pair, offset)) {
+        if (stashed)
+            vsccMatcherRestoreFarthest(self);
+        return true;
+    }
+
+    const size_t textLength = vsccMatcherInputLength(self);
+
+    if (false
+        || self->farthest <= start
+        || self->probing
+        || vsccArraySize(self->errors) >= self->errorLimit
+        || self->internalError
+        || self->tooDeep
+    ) {
+        if (stashed)
+            vsccMatcherRestoreFarthest(self);
+        return false;
+    }
+
+    if (!vsccMatcherReport(self)) {
+        self->internalError = true;
+        return false;
+    }
+
+    // find resynchronization point, offsets rule can't start at are skipped without probing
+    const VsccMatcherStartSet *startSet = vsccMatcherStartSet(self, pair - self->grammar->rules);
+    size_t resync = self->farthest + 1;
+    const size_t commit = self->commit;
+
+    self->probing = true;
+    for (; resync < textLength; resync++) {
+        if (!vsccMatcherMayStart(self, startSet, resync))
+            continue;
+
+        size_t probe = resync;
+
+        // probes never return to offsets before their own one
+        if (commit == SIZE_MAX)
+            self->commit = resync;
+
+        const bool matched = vsccMatcherMatch(self, pair->rule, &probe);
+
+        vsccArrayTruncate(self->values, base);
+        if (matched)
+            break;
+    }
+    self->probing = false;
+    self->commit = commit;
+
+    if (resync > textLength)
+        resync = textLength;
+
+    // reported failures are not interesting anymore
+    self->expectedStale = true;
+    self->farthest = resync;
+    self->epoch += 2;
+    if (stashed)
+        vsccMatcherRestoreFarthest(self);
+
+    // recovered rule with action produces NULL value
+    vsccArrayTruncate(self->values, base);
+    if (pair->action != NULL) {
+        void *value = NULL;
+
+        if (!vsccArrayPush(&self->values, &value)) {
+            self->internalError = true;
+            return false;
+        }
+    }
+
+    *offset = resync;
+    return true;
+} // vsccMatcherMatchRecover
+
+/**
+ * @brief terminal alternation matching by automaton function
+ *
+ * @param[in,out] self   matcher (non-null)
+ * @param[in]     rule   variant rule with automaton (non-null)
+ * @param[in,out] offset current text offset (non-null)
+ * @param[out]    result matching result destination (non-null)
+ *
+ * @return true if automaton is available, false if it couldn't be built
+ */
+static bool vsccMatcherMatchAutomaton( VsccMatcherImpl *self, const VsccRule *rule, size_t *offset, bool *result ) {
+    VsccLazyDfa *dfa = &self->dfas[rule->variant.automaton];
+
+    if (*dfa == NULL && (*dfa = vsccLazyDfaCtor(self->grammar->automata[rule->variant.automaton], self->allocator)) == NULL)
+        return false;
+
+    const VsccNfa nfa = self->grammar->automata[rule->variant.automaton];
+    size_t alternative = 0, length = 0;
+    const bool matched = vsccLazyDfaMatch(*dfa, self->textBegin + *offset, self->textEnd, &alternative, &length);
+
+    // all alternatives before matched one failed at offset
+    if (*offset >= self->farthest) {
+        const size_t failedCount = matched
+            ? alternative
+            : vsccNfaAlternativeCount(nfa)
+        ;
+
+        for (size_t i = 0; i < failedCount; i++)
+            vsccMatcherFail(self, *offset, vsccNfaAlternative(nfa, i)->id);
+    }
+
+    if (matched)
+        *offset += length;
+    *result = matched;
+    return true;
+} // vsccMatcherMatchAutomaton
+
+/**
+ * @brief token rule reference matching function (token mode)
+ *
+ * @param[in,out] self   matcher (non-null)
+ * @param[in]     index  token rule index
+ * @param[in,out] offset current token index (non-null)
+ *
+ * @return true if matched, false otherwise
+ */
+static bool vsccMatcherMatchToken( VsccMatcherImpl *self, size_t index, size_t *offset ) {
+    const VsccGrammarPair *pair = &self->grammar->rules[index];
+
+    if (*offset >= self->tokenCount || self->tokens[*offset].kind != index) {
+        vsccMatcherFail(self, *offset, self->grammar->terminalCount + index);
+        return false;
+    }
+
+    const VsccToken token = self->tokens[(*offset)++];
+
+    if (pair->action == NULL || self->probing)
+        return true;
+
+    void *result = NULL;
+
+    if (!pair->action(
+        pair->actionContext,
+        self->textBegin + token.offset,
+        self->textBegin + token.offset + token.length,
+        NULL,
+        0,
+        &result
+    ) || !vsccArrayPush(&self->values, &result)) {
+        self->internalError = true;
+        return false;
+    }
+    return true;
+} // vsccMatcherMatchToken
+
+/**
+ * @brief rule matching function
+ *
+ * @param[in,out] self   matcher (non-null)
+ * @param[in]     rule   rule to match (non-null)
+ * @param[in,out] offset current text offset (non-null, unchanged if rule isn't matched)
+ *
+ * @return true if matched, false otherwise
+ */
+static bool vsccMatcherMatch( VsccMatcherImpl *self, const VsccRule *rule, size_t *offset ) {
+    switch (rule->type) {
+    case VSCC_RULE_SEQUENCE: {
+        size_t current = *offset;
+
+        for (size_t i = 0; i < rule->sequence.count; i++)
+            if (!vsccMatcherMatch(self, rule->sequence.rules[i], &current))
+                return false;
+        *offset = current;
+        return true;
+    }
+
+    // failed attempts are backtracked by value stack truncation
+
+    case VSCC_RULE_VARIANT: {
+        bool matched;
+
+        // automata match characters, so they're useless in token mode
+        if (rule->variant.automaton != SIZE_MAX && !self->tokenMode && vsccMatcherMatchAutomaton(self, rule, offset, &matched))
+            return matched;
+
+        const size_t base = vsccArraySize(self->values);
+        const size_t commit = self->commit;
+
+        // outermost choice point is the commit point
+        if (commit == SIZE_MAX)
+            self->commit = *offset;
+
+        matched = false;
+        for (size_t i = 0; !matched && i < rule->variant.count; i++)
+            if (!(matched = vsccMatcherMatch(self, rule->variant.rules[i], offset)))
+                vsccArrayTruncate(self->values, base);
+
+        self->commit = commit;
+        return matched;
+    }
+
+    case VSCC_RULE_OPTIONAL: {
+        const size_t base = vsccArraySize(self->values);
+        const size_t commit = self->commit;
+
+        if (commit == SIZE_MAX)
+            self->commit = *offset;
+        if (!vsccMatcherMatch(self, rule->optional, offset))
+            vsccArrayTruncate(self->values, base);
+
+        self->commit = commit;
+        return true;
+    }
+
+    case VSCC_RULE_REPEAT: {
+        size_t current = *offset;
+
+        if (rule->repeat.atLeastOnce && !vsccMatcherMatch(self, rule->repeat.rule, &current))
+            return false;
+
+        const size_t commit = self->commit;
+
+        // stop on empty iteration to guarantee termination
+        for (size_t last = SIZE_MAX; last != current; ) {
+            const size_t base = vsccArraySize(self->values);
+
+            last = current;
+            if (commit == SIZE_MAX)
+                self->commit = current;
+            if (!vsccMatcherMatch(self, rule->repeat.rule, &current)) {
+                vsccArrayTruncate(self->values, base);
+                break;
+            }
+        }
+        self->commit = commit;
+        *offset = current;
+        return true;
+    }
+
+    case VSCC_RULE_STRING_TERMINAL:
+        if (self->tokenMode) {
+            // string terminal matches token of exactly same text
+            if (true
+                && *offset < self->tokenCount
+                && self->tokens[*offset].length == rule->stringTerminal.length
+                && memcmp(self->textBegin + self->tokens[*offset].offset, rule->stringTerminal.string, rule->stringTerminal.length) == 0
+            ) {
+                *offset += 1;
+                return true;
+            }
+        } else if (vsccRuleStringTerminalMatch(rule, self->textBegin + *offset, self->textEnd)) {
+            *offset += rule->stringTerminal.length;
+            return true;
+        }
+        vsccMatcherFail(self, *offset, rule->id);
+        return false;
+
+    case VSCC_RULE_CHAR_TERMINAL: {
+        if (self->tokenMode) {
+            // character terminal matches token of single matching character
+            if (*offset < self->tokenCount) {
+                const VsccToken token = self->tokens[*offset];
+                const char *tokenText = self->textBegin + token.offset;
+
+                if (token.length != 0 && vsccRuleCharTerminalMatch(rule, tokenText, tokenText + token.length) == token.length) {
+                    *offset += 1;
+                    return true;
+                }
+            }
+            vsccMatcherFail(self, *offset, rule->id);
+            return false;
+        }
+
+        const char *current = self->textBegin + *offset;
+
+        // keep ASCII check inline, so pure ASCII input never leaves matcher loop
+        if (current < self->textEnd && (uint8_t)*current < 0x80) {
+            const uint8_t c = (uint8_t)*current;
+
+            if ((rule->charTerminal.ascii[c / 64] >> c % 64) & 1) {
+                *offset += 1;
+                return true;
+            }
+        } else {
+            const size_t length = vsccRuleCharTerminalMatch(rule, current, self->textEnd);
+
+            if (length != 0) {
+                *offset += length;
+                return true;
+            }
+        }
+        vsccMatcherFail(self, *offset, rule->id);
+        return false;
+    }
+
+    case VSCC_RULE_REFERENCE: {
+        const VsccGrammarPair *pair = &self->grammar->rules[rule->reference.index];
+
+        // stack grows down, so nesting is limited by current frame address
+        if (self->tooDeep || (uintptr_t)__builtin_frame_address(0) < self->stackLimit) {
+            self->tooDeep = true;
+            return false;
+        }
+
+        if (self->tokenMode && pair->token != VSCC_TOKEN_NONE)
+            return vsccMatcherMatchToken(self, rule->reference.index, offset);
+
+        if (pair->recover)
+            return vsccMatcherMatchRecover(self, pair, offset);
+        return self->memoSlots[rule->reference.index] != VSCC_MATCHER_NO_MEMO
+            ? vsccMatcherMatchMemo(self, rule->reference.index, offset)
+            : vsccMatcherMatchPair(self, pair, offset)
+        ;
+    }
+
+    case VSCC_RULE_END:
+        if (*offset == vsccMatcherInputLength(self))
+            return true;
+        vsccMatcherFail(self, *offset, rule->id);
+        return false;
+
+    case VSCC_RULE_EMPTY:
+        return true;
+    }
+
+    assert(false && "Unreachable case reached.");
+    return false;
+} // vsccMatcherMatch
+
+/**
+ * @brief input matching function
+ *
+ * @param[in,out] matcher    matcher (non-null)
+ * @param[in]     ruleIndex  index of rule to match
+ * @param[in]     strBegin   text begin (non-null)
+ * @param[in]     strEnd     text end (non-null)
+ * @param[in]     tokenMode  true if token stream should be matched instead of text
+ * @param[in]     tokens     tokens (token mode)
+ * @param[in]     tokenCount count of tokens (token mode)
+ *
+ * @return matching status
+ */
+static VsccMatchStatus vsccMatcherRunImpl( VsccMatcher matcher, size_t ruleIndex, const char *strBegin, const char *strEnd, bool tokenMode, const VsccToken *tokens, size_t tokenCount ) {
+    assert(matcher != NULL);
+    assert(ruleIndex < matcher->grammar->ruleCount);
+    assert(strBegin <= strEnd);
+
+    matcher->textBegin = strBegin;
+    matcher->textEnd = strEnd;
+    matcher->tokenMode = tokenMode;
+    matcher->tokens = tokens;
+    matcher->tokenCount = tokenCount;
+    matcher->length = 0;
+    matcher->farthest = 0;
+    matcher->probing = false;
+    matcher->internalError = false;
+    matcher->tooDeep = false;
+    matcher->lineIndexBuilt = false;
+    memset(matcher->expected, 0, matcher->expectedWordCount * sizeof(uint64_t));
+    matcher->expectedStale = false;
+    vsccArrayTruncate(matcher->stash, 0);
+    vsccArrayTruncate(matcher->stashWords, 0);
+    matcher->stashPending = 0;
+    vsccArrayTruncate(matcher->errors, 0);
+    vsccArrayTruncate(matcher->expectedIds, 0);
+    vsccArrayTruncate(matcher->values, 0);
+    vsccArrayTruncate(matcher->memoValues, 0);
+    matcher->memoValueLimit = matcher->memoRowCount * matcher->memoSlotCount;
+    matcher->commit = SIZE_MAX;
+    matcher->epoch = 0;
+    if (matcher->memoOffsets != NULL)
+        memset(matcher->memoOffsets, 0xFF, matcher->memoRowCount * sizeof(size_t));
+
+    const uintptr_t frame = (uintptr_t)__builtin_frame_address(0);
+
+    matcher->stackLimit = frame > matcher->stackSize
+        ? frame - matcher->stackSize
+        : 0
+    ;
+
+    size_t offset = 0;
+    const bool matched = vsccMatcherMatchPair(matcher, &matcher->grammar->rules[ruleIndex], &offset);
+
+    vsccMatcherMemoUpdateSize(matcher);
+
+    if (matcher->tooDeep)
+        return VSCC_MATCH_TOO_DEEP;
+    if (matcher->internalError)
+        return VSCC_MATCH_INTERNAL_ERROR;
+
+    // unmatched rest of input is an error at farthest failure, as if rule was followed by end
+    if (matched && matcher->requireEnd && offset < vsccMatcherInputLength(matcher) && matcher->farthest < offset) {
+        matcher->expectedStale = true;
+        matcher->farthest = offset;
+    }
+
+    if (!matched || (matcher->requireEnd && offset < vsccMatcherInputLength(matcher)))
+        return vsccMatcherReport(matcher)
+            ? VSCC_MATCH_FAILED
+            : VSCC_MATCH_INTERNAL_ERROR
+        ;
+
+    matcher->length = offset;
+    return vsccArraySize(matcher->errors) == 0
+        ? VSCC_MATCH_OK
+        : VSCC_MATCH_RECOVERED
+    ;
+} // vsccMatcherRunImpl
+
+VsccMatchStatus vsccMatcherRun( VsccMatcher matcher, size_t ruleIndex, const char *strBegin, const char *strEnd ) {
+    return vsccMatcherRunImpl(matcher, ruleIndex, strBegin, strEnd, false, NULL, 0);
+} // vsccMatcherRun
+
+VsccMatchStatus vsccMatcherRunTokens( VsccMatcher matcher, size_t ruleIndex, const char *strBegin, const char *strEnd, const VsccToken *tokens, size_t tokenCount ) {
+    assert(tokens != NULL || tokenCount == 0);
+
+    return vsccMatcherRunImpl(matcher, ruleIndex, strBegin, strEnd, true, tokens, tokenCount);
+} // vsccMatcherRunTokens
+
+size_t vsccMatcherLength( const VsccMatcher matcher ) {
+    assert(matcher != NULL);
+    return matcher->length;
+} // vsccMatcherLength
+
+size_t vsccMatcherValueCount( const VsccMatcher matcher ) {
+    assert(matcher != NULL);
+    return vsccArraySize(matcher->values);
+} // vsccMatcherValueCount
+
+void * vsccMatcherValue( const VsccMatcher matcher, size_t index ) {
+    assert(matcher != NULL);
+    return *(void **)vsccGetArrayElement(matcher->values, index);
+} // vsccMatcherValue
+
+size_t vsccMatcherErrorCount( const VsccMatcher matcher ) {
+    assert(matcher != NULL);
+    return vsccArraySize(matcher->errors);
+} // vsccMatcherErrorCount
+
+VsccMatchError vsccMatcherError( const VsccMatcher matcher, size_t index ) {
+    assert(matcher != NULL);
+
+    const VsccMatcherErrorImpl *error = (const VsccMatcherErrorImpl *)vsccGetArrayElement(matcher->errors, index);
+
+    return (VsccMatchError) {
+        .offset        = error->offset,
+        .expected      = (const size_t *)vsccArrayData(matcher->expectedIds) + error->expectedBegin,
+        .expectedCount = error->expectedCount,
+    };
+} // vsccMatcherError
+
+bool vsccMatcherLocation( VsccMatcher matcher, size_t offset, size_t *line, size_t *column ) {
+    assert(matcher != NULL);
+    assert(line != NULL);
+    assert(column != NULL);
+    assert(matcher->textBegin + offset <= matcher->textEnd);
+
+    if (!matcher->lineIndexBuilt) {
+        vsccArrayTruncate(matcher->lineStarts, 0);
+
+        size_t lineStart = 0;
+        if (!vsccArrayPush(&matcher->lineStarts, &lineStart))
+            return false;
+
+        for (const char *ch = matcher->textBegin; ch < matcher->textEnd; ch++) {
+            if (*ch != '\n')
+                continue;
+            lineStart = ch - matcher->textBegin + 1;
+            if (!vsccArrayPush(&matcher->lineStarts, &lineStart))
+                return false;
+        }
+        matcher->lineIndexBuilt = true;
+    }
+
+    // find last line that starts before or at offset
+    const size_t *lineStarts = (const size_t *)vsccArrayData(matcher->lineStarts);
+    size_t lo = 0, hi = vsccArraySize(matcher->lineStarts);
+
+    while (hi - lo > 1) {
+        const size_t mid = lo + (hi - lo) / 2;
+
+        if (lineStarts[mid] <= offset)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    *line = lo + 1;
+    *column = offset - lineStarts[lo] + 1;
+    return true;
+} // vsccMatcherLocation
+
+void vsccMatcherPrintErrors( FILE *out, VsccMatcher matcher ) {
+    assert(out != NULL);
+    assert(matcher != NULL);
+
+    const size_t errorCount = vsccMatcherErrorCount(matcher);
+
+    for (size_t i = 0; i < errorCount; i++) {
+        const VsccMatchError error = vsccMatcherError(matcher, i);
+        size_t line = 0, column = 0;
+
+        if (vsccMatcherLocation(matcher, error.offset, &line, &column))
+            fprintf(out, "error at line %zu column %zu: ", line, column);
+        else
+            fprintf(out, "error at offset %zu: ", error.offset);
+
+        fprintf(out, error.expectedCount == 0 ? "unexpected input" : "expected ");
+
+        for (size_t j = 0; j < error.expectedCount; j++) {
+            if (j != 0)
+                fprintf(out, j + 1 == error.expectedCount ? " or " : ", ");
+
+            // ids after terminal ones belong to token rules
+            if (error.expected[j] >= matcher->grammar->terminalCount) {
+                fprintf(out, "%s", matcher->grammar->rules[error.expected[j] - matcher->grammar->terminalCount].name);
+                continue;
+            }
+
+            const VsccRule *terminal = matcher->grammar->terminals[error.expected[j]];
+
+            if (terminal->type == VSCC_RULE_END)
+                fprintf(out, "end of text");
+            else
+                vsccRulePrint(out, terminal);
+        }
+        fprintf(out, "\n");
+    }
+} // vsccMatcherPrintErrors
+
+// vscc_match.c
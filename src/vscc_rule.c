@@ -7,22 +7,27 @@
 #include <string.h>
 #include <assert.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "vscc.h"
 
 /**
  * @brief rule allocation function
  * 
  * @param[in]  additionalDataSize size of additional space required for rule
+ * @param[in]  allocator          allocator to allocate rule by (nullable)
  * @param[out] ruleDst            rule allocation destination (non-null)
  * @param[out] additionalDataDst  additional data destination (nullable if additionalDataSize == 0)
  * 
- * @note resulting rule and additional data are safe to free by applying free() to ruleDst
+ * @note resulting rule and additional data are safe to free by applying vsccDeallocate() to ruleDst
  * @note resulting rule and additional data are zeroed
  * @note this function **is not** setting defasult values to ruleDst or additionalDataDst in case if function fails.
  * 
  * @return true if allocated successfully, false if allocation failed.
  */
-static bool vsccRuleAlloc( size_t additionalDataSize, VsccRule **ruleDst, void **additionalDataDst ) {
+static bool vsccRuleAlloc( const VsccAllocator *allocator, size_t additionalDataSize, VsccRule **ruleDst, void **additionalDataDst ) {
     assert(false
         || additionalDataSize != 0 && additionalDataDst != NULL
         || additionalDataSize == 0
@@ -32,25 +37,113 @@ static bool vsccRuleAlloc( size_t additionalDataSize, VsccRule **ruleDst, void *
         + sizeof(VsccRule) / sizeof(size_t) * sizeof(size_t)
         + (sizeof(VsccRule) % sizeof(size_t) != 0)
     ;
-    void *data = calloc(alignedRuleSize + additionalDataSize, 1);
+    void *data = vsccAllocateZeroed(allocator, alignedRuleSize + additionalDataSize, 1);
 
     if (data == NULL)
         return false;
 
     *ruleDst = (VsccRule *)data;
+    (*ruleDst)->allocator = allocator;
     if (additionalDataSize != 0)
         *additionalDataDst = (uint8_t *)data + alignedRuleSize;
 
     return true;
 } // vsccRuleAlloc
 
+uint64_t vsccHashBytes( uint64_t hash, const void *data, size_t size ) {
+    const uint8_t *bytes = (const uint8_t *)data;
+
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ bytes[i]) * 0x100000001B3;
+    return hash;
+} // vsccHashBytes
+
+/**
+ * @brief rule structural hash computing function
+ * 
+ * @param[in] rule rule to compute hash of (non-null, children hashes must be computed)
+ * 
+ * @note hash covers everything but link results, so it costs O(direct children + terminal size)
+ * 
+ * @return rule hash
+ */
+static uint64_t vsccRuleComputeHash( const VsccRule *rule ) {
+    const uint32_t type = rule->type;
+    uint64_t hash = vsccHashBytes(VSCC_HASH_INITIAL, &type, sizeof(type));
+
+    switch (rule->type) {
+    case VSCC_RULE_SEQUENCE:
+    case VSCC_RULE_VARIANT: {
+        // sequence and variant layouts share rules/count fields
+        hash = vsccHashBytes(hash, &rule->sequence.count, sizeof(rule->sequence.count));
+        for (size_t i = 0; i < rule->sequence.count; i++)
+            hash = vsccHashBytes(hash, &rule->sequence.rules[i]->hash, sizeof(uint64_t));
+        break;
+    }
+
+    case VSCC_RULE_OPTIONAL:
+        hash = vsccHashBytes(hash, &rule->optional->hash, sizeof(uint64_t));
+        break;
+
+    case VSCC_RULE_REPEAT:
+        hash = vsccHashBytes(hash, &rule->repeat.atLeastOnce, sizeof(rule->repeat.atLeastOnce));
+        hash = vsccHashBytes(hash, &rule->repeat.rule->hash, sizeof(uint64_t));
+        break;
+
+    case VSCC_RULE_STRING_TERMINAL:
+        hash = vsccHashBytes(hash, &rule->stringTerminal.length, sizeof(rule->stringTerminal.length));
+        hash = vsccHashBytes(hash, rule->stringTerminal.string, rule->stringTerminal.length);
+        break;
+
+    case VSCC_RULE_CHAR_TERMINAL:
+        hash = vsccHashBytes(hash, &rule->charTerminal.count, sizeof(rule->charTerminal.count));
+        hash = vsccHashBytes(hash, rule->charTerminal.ranges, rule->charTerminal.count * sizeof(VsccRuleCharRange));
+        break;
+
+    case VSCC_RULE_REFERENCE:
+        hash = vsccHashBytes(hash, rule->reference.name, strlen(rule->reference.name));
+        break;
+
+    case VSCC_RULE_END:
+    case VSCC_RULE_EMPTY:
+        break;
+    }
+
+    return hash;
+} // vsccRuleComputeHash
+
+/**
+ * @brief composite rule elements checking function
+ *
+ * @param[in] rules elements (non-null)
+ * @param[in] count count of elements
+ *
+ * @note if some element is NULL, all elements are destroyed
+ *
+ * @return true if all elements are constructed, false otherwise
+ */
+static bool vsccRuleCheckElements( VsccRule **rules, size_t count ) {
+    for (size_t i = 0; i < count; i++) {
+        if (rules[i] != NULL)
+            continue;
+
+        for (size_t j = 0; j < count; j++)
+            vsccRuleDtor(rules[j]);
+        return false;
+    }
+    return true;
+} // vsccRuleCheckElements
+
 VsccRule * vsccRuleSequence( VsccRule **rules, size_t count ) {
     assert(count > 0);
 
     VsccRule **array = NULL;
     VsccRule *result = NULL;
 
-    if (!vsccRuleAlloc(count * sizeof(VsccRule *), &result, (void **)&array)) {
+    if (!vsccRuleCheckElements(rules, count))
+        return NULL;
+
+    if (!vsccRuleAlloc(rules[0]->allocator, count * sizeof(VsccRule *), &result, (void **)&array)) {
         for (size_t i = 0; i < count; i++)
             vsccRuleDtor(rules[i]);
         return NULL;
@@ -61,6 +154,8 @@ VsccRule * vsccRuleSequence( VsccRule **rules, size_t count ) {
     result->sequence.count = count;
     result->sequence.rules = array;
 
+    result->hash = vsccRuleComputeHash(result);
+
     return result;
 } // vsccRuleSequence
 
@@ -70,7 +165,10 @@ VsccRule * vsccRuleVariant( VsccRule **rules, size_t count ) {
     VsccRule **array = NULL;
     VsccRule *result = NULL;
 
-    if (!vsccRuleAlloc(count * sizeof(VsccRule *), &result, (void **)&array)) {
+    if (!vsccRuleCheckElements(rules, count))
+        return NULL;
+
+    if (!vsccRuleAlloc(rules[0]->allocator, count * sizeof(VsccRule *), &result, (void **)&array)) {
         for (size_t i = 0; i < count; i++)
             vsccRuleDtor(rules[i]);
         return NULL;
@@ -81,13 +179,15 @@ VsccRule * vsccRuleVariant( VsccRule **rules, size_t count ) {
     result->variant.count = count;
     result->variant.rules = array;
 
+    result->hash = vsccRuleComputeHash(result);
+
     return result;
 } // vsccRuleVariant
 
 VsccRule * vsccRuleOptional( VsccRule *rule ) {
     VsccRule *result = NULL;
 
-    if (!vsccRuleAlloc(0, &result, NULL)) {
+    if (rule == NULL || !vsccRuleAlloc(rule->allocator, 0, &result, NULL)) {
         vsccRuleDtor(rule);
         return NULL;
     }
@@ -95,13 +195,15 @@ VsccRule * vsccRuleOptional( VsccRule *rule ) {
     result->type = VSCC_RULE_OPTIONAL;
     result->optional = rule;
 
+    result->hash = vsccRuleComputeHash(result);
+
     return result;
 } // vsccRuleOptional
 
 VsccRule * vsccRuleRepeat( VsccRule *rule, bool atLeastOnce ) {
     VsccRule *result = NULL;
 
-    if (!vsccRuleAlloc(0, &result, NULL)) {
+    if (rule == NULL || !vsccRuleAlloc(rule->allocator, 0, &result, NULL)) {
         vsccRuleDtor(rule);
         return NULL;
     }
@@ -110,84 +212,332 @@ VsccRule * vsccRuleRepeat( VsccRule *rule, bool atLeastOnce ) {
     result->repeat.rule = rule;
     result->repeat.atLeastOnce = atLeastOnce;
 
+    result->hash = vsccRuleComputeHash(result);
+
     return result;
 } // vsccRuleRepeat
 
-VsccRule * vsccRuleStringTerminalFromSlice( const char *terminalBegin, const char *terminalEnd ) {
+VsccRule * vsccRuleStringTerminalFromSlice( const char *terminalBegin, const char *terminalEnd, const VsccAllocator *allocator ) {
     const size_t length = terminalEnd - terminalBegin;
     char *resultTerminal = NULL;
     VsccRule *result = NULL;
 
-    if (!vsccRuleAlloc(length + 1, &result, (void **)&resultTerminal))
+    if (!vsccRuleAlloc(allocator, length + 1, &result, (void **)&resultTerminal))
         return NULL;
 
     // vsccRuleAlloc result is zeroed
     memcpy(resultTerminal, terminalBegin, length);
 
     result->type = VSCC_RULE_STRING_TERMINAL;
-    result->stringTerminal = resultTerminal;
+    result->stringTerminal.string = resultTerminal;
+    result->stringTerminal.length = length;
+    memcpy(&result->stringTerminal.prefix, resultTerminal, length < 8 ? length : 8);
+
+    result->hash = vsccRuleComputeHash(result);
 
     return result;
 } // vsccRuleStringTerminalFromSlice
 
-VsccRule * vsccRuleStringTerminal( const char *terminal ) {
-    return vsccRuleStringTerminalFromSlice(terminal, terminal + strlen(terminal));
+VsccRule * vsccRuleStringTerminal( const char *terminal, const VsccAllocator *allocator ) {
+    return vsccRuleStringTerminalFromSlice(terminal, terminal + strlen(terminal), allocator);
 } // vsccRuleStringTerminal
 
-VsccRule * vsccRuleCharTerminal( const VsccRuleCharRange *ranges, size_t count ) {
+/**
+ * @brief first 'length' bytes of 64-bit word mask getting function
+ * 
+ * @param[in] length count of bytes to keep (< 8)
+ * 
+ * @return mask that keeps first 'length' bytes (in memory order) of word
+ */
+static inline uint64_t vsccRulePrefixMask( size_t length ) {
+    assert(length < 8);
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return length == 0 ? 0 : ~(~(uint64_t)0 >> (length * 8));
+#else
+    return ((uint64_t)1 << (length * 8)) - 1;
+#endif
+} // vsccRulePrefixMask
+
+bool vsccRuleStringTerminalMatch( const VsccRule *rule, const char *strBegin, const char *strEnd ) {
+    assert(rule != NULL);
+    assert(rule->type == VSCC_RULE_STRING_TERMINAL);
+    assert(strBegin <= strEnd);
+
+    const size_t length = rule->stringTerminal.length;
+    const size_t available = strEnd - strBegin;
+
+    if (length > available)
+        return false;
+
+    // short terminal, compare single word
+    if (length < 8) {
+        uint64_t word = 0;
+
+        // 8 input bytes are readable, so load them at once and cut the tail
+        if (available >= 8) {
+            memcpy(&word, strBegin, 8);
+            word &= vsccRulePrefixMask(length);
+        } else {
+            for (size_t i = 0; i < length; i++)
+                ((uint8_t *)&word)[i] = (uint8_t)strBegin[i];
+        }
+
+        return word == rule->stringTerminal.prefix;
+    }
+
+    uint64_t word;
+    memcpy(&word, strBegin, 8);
+    if (word != rule->stringTerminal.prefix)
+        return false;
+
+    // both terminal and input have at least 'length' bytes readable, so all loads below stay in the bounds
+    const char *terminal = rule->stringTerminal.string;
+    size_t offset = 8;
+
+#if defined(__SSE2__)
+    for (; offset + 16 <= length; offset += 16) {
+        const __m128i lhs = _mm_loadu_si128((const __m128i *)(strBegin + offset));
+        const __m128i rhs = _mm_loadu_si128((const __m128i *)(terminal + offset));
+
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(lhs, rhs)) != 0xFFFF)
+            return false;
+    }
+
+    if (offset == length)
+        return true;
+
+    // compare (overlapping) tail
+    if (length >= 16) {
+        const __m128i lhs = _mm_loadu_si128((const __m128i *)(strBegin + length - 16));
+        const __m128i rhs = _mm_loadu_si128((const __m128i *)(terminal + length - 16));
+
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(lhs, rhs)) == 0xFFFF;
+    }
+#else
+    for (; offset + 8 <= length; offset += 8) {
+        uint64_t lhs, rhs;
+
+        memcpy(&lhs, strBegin + offset, 8);
+        memcpy(&rhs, terminal + offset, 8);
+        if (lhs != rhs)
+            return false;
+    }
+
+    if (offset == length)
+        return true;
+#endif
+
+    // compare overlapping 8-byte tail
+    uint64_t lhs, rhs;
+
+    memcpy(&lhs, strBegin + length - 8, 8);
+    memcpy(&rhs, terminal + length - 8, 8);
+
+    return lhs == rhs;
+} // vsccRuleStringTerminalMatch
+
+/**
+ * @brief character range by first code point comparator (for qsort)
+ *
+ * @param[in] lhs first range pointer
+ * @param[in] rhs second range pointer
+ *
+ * @return comparison result
+ */
+static int vsccRuleCharRangeCompare( const void *lhs, const void *rhs ) {
+    const uint32_t lhsFirst = ((const VsccRuleCharRange *)lhs)->first;
+    const uint32_t rhsFirst = ((const VsccRuleCharRange *)rhs)->first;
+
+    return (lhsFirst > rhsFirst) - (lhsFirst < rhsFirst);
+} // vsccRuleCharRangeCompare
+
+VsccRule * vsccRuleCharTerminal( const VsccRuleCharRange *ranges, size_t count, const VsccAllocator *allocator ) {
     VsccRuleCharRange *resultRanges = NULL;
     VsccRule *result = NULL;
 
-    if (!vsccRuleAlloc(count * sizeof(VsccRuleCharRange), &result, (void **)&resultRanges))
+    // ranges are followed by non-ASCII range table
+    if (!vsccRuleAlloc(allocator, 2 * count * sizeof(VsccRuleCharRange), &result, (void **)&resultRanges))
         return NULL;
     memcpy(resultRanges, ranges, sizeof(VsccRuleCharRange) * count);
 
+    VsccRuleCharRange *table = resultRanges + count;
+    size_t tableCount = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        const VsccRuleCharRange range = ranges[i];
+
+        assert(range.first <= range.last);
+        assert(range.last <= VSCC_CODE_POINT_MAX);
+
+        for (uint32_t c = range.first; c <= range.last && c < 0x80; c++)
+            result->charTerminal.ascii[c / 64] |= (uint64_t)1 << c % 64;
+
+        if (range.last >= 0x80)
+            table[tableCount++] = (VsccRuleCharRange) {
+                .first = range.first < 0x80 ? 0x80 : range.first,
+                .last  = range.last,
+            };
+    }
+
+    // sort and merge overlapping/adjacent ranges to make table binary-searchable
+    qsort(table, tableCount, sizeof(VsccRuleCharRange), vsccRuleCharRangeCompare);
+
+    size_t mergedCount = 0;
+    for (size_t i = 0; i < tableCount; i++) {
+        if (mergedCount != 0 && table[i].first <= table[mergedCount - 1].last + 1) {
+            if (table[i].last > table[mergedCount - 1].last)
+                table[mergedCount - 1].last = table[i].last;
+        } else {
+            table[mergedCount++] = table[i];
+        }
+    }
+
     result->type = VSCC_RULE_CHAR_TERMINAL;
     result->charTerminal.count = count;
     result->charTerminal.ranges = resultRanges;
+    result->charTerminal.table = table;
+    result->charTerminal.tableCount = mergedCount;
+
+    result->hash = vsccRuleComputeHash(result);
 
     return result;
 } // vsccRuleCharTerminal
 
-VsccRule * vsccRuleReferernceFromSlice( const char *refBegin, const char *refEnd ) {
+size_t vsccDecodeUtf8( const char *strBegin, const char *strEnd, uint32_t *codePoint ) {
+    assert(strBegin <= strEnd);
+    assert(codePoint != NULL);
+
+    const uint8_t *str = (const uint8_t *)strBegin;
+    const size_t available = strEnd - strBegin;
+
+    if (available == 0)
+        return 0;
+
+    if (str[0] < 0x80) {
+        *codePoint = str[0];
+        return 1;
+    }
+
+    size_t length;
+    uint32_t result;
+    uint32_t minimum;
+
+    if ((str[0] & 0xE0) == 0xC0) {
+        length = 2;
+        result = str[0] & 0x1F;
+        minimum = 0x80;
+    } else if ((str[0] & 0xF0) == 0xE0) {
+        length = 3;
+        result = str[0] & 0x0F;
+        minimum = 0x800;
+    } else if ((str[0] & 0xF8) == 0xF0) {
+        length = 4;
+        result = str[0] & 0x07;
+        minimum = 0x10000;
+    } else {
+        return 0;
+    }
+
+    if (length > available)
+        return 0;
+
+    for (size_t i = 1; i < length; i++) {
+        if ((str[i] & 0xC0) != 0x80)
+            return 0;
+        result = result << 6 | (str[i] & 0x3F);
+    }
+
+    if (result < minimum || result > VSCC_CODE_POINT_MAX || (result >= 0xD800 && result <= 0xDFFF))
+        return 0;
+
+    *codePoint = result;
+    return length;
+} // vsccDecodeUtf8
+
+size_t vsccRuleCharTerminalMatch( const VsccRule *rule, const char *strBegin, const char *strEnd ) {
+    assert(rule != NULL);
+    assert(rule->type == VSCC_RULE_CHAR_TERMINAL);
+    assert(strBegin <= strEnd);
+
+    if (strBegin == strEnd)
+        return 0;
+
+    // ASCII fast path
+    const uint8_t first = (uint8_t)*strBegin;
+    if (first < 0x80)
+        return (rule->charTerminal.ascii[first / 64] >> first % 64) & 1;
+
+    uint32_t codePoint;
+    const size_t length = vsccDecodeUtf8(strBegin, strEnd, &codePoint);
+
+    if (length == 0)
+        return 0;
+
+    // find last range that starts before or at code point
+    const VsccRuleCharRange *table = rule->charTerminal.table;
+    size_t lo = 0, hi = rule->charTerminal.tableCount;
+
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+
+        if (table[mid].first <= codePoint)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo != 0 && codePoint <= table[lo - 1].last
+        ? length
+        : 0
+    ;
+} // vsccRuleCharTerminalMatch
+
+VsccRule * vsccRuleReferernceFromSlice( const char *refBegin, const char *refEnd, const VsccAllocator *allocator ) {
     const size_t length = refEnd - refBegin;
     char *resultReference = NULL;
     VsccRule *result = NULL;
 
-    if (!vsccRuleAlloc(length + 1, &result, (void **)&resultReference))
+    if (!vsccRuleAlloc(allocator, length + 1, &result, (void **)&resultReference))
         return NULL;
 
     memcpy(resultReference, refBegin, length);
 
     result->type = VSCC_RULE_REFERENCE;
-    result->reference = resultReference;
+    result->reference.name = resultReference;
+
+    result->hash = vsccRuleComputeHash(result);
 
     return result;
 } // vsccRuleReferernceFromSlice
 
-VsccRule * vsccRuleReference( const char *reference ) {
-    return vsccRuleReferernceFromSlice(reference, reference + strlen(reference));
+VsccRule * vsccRuleReference( const char *reference, const VsccAllocator *allocator ) {
+    return vsccRuleReferernceFromSlice(reference, reference + strlen(reference), allocator);
 } // vsccRuleReference
 
-VsccRule * vsccRuleEnd( void ) {
+VsccRule * vsccRuleEnd( const VsccAllocator *allocator ) {
     VsccRule *result = NULL;
 
-    if (!vsccRuleAlloc(0, &result, NULL))
+    if (!vsccRuleAlloc(allocator, 0, &result, NULL))
         return NULL;
 
     result->type = VSCC_RULE_END;
 
+    result->hash = vsccRuleComputeHash(result);
+
     return result;
 } // vsccRuleEnd
 
-VsccRule * vsccRuleEmpty( void ) {
+VsccRule * vsccRuleEmpty( const VsccAllocator *allocator ) {
     VsccRule *result = NULL;
 
-    if (!vsccRuleAlloc(0, &result, NULL))
+    if (!vsccRuleAlloc(allocator, 0, &result, NULL))
         return NULL;
 
     result->type = VSCC_RULE_EMPTY;
 
+    result->hash = vsccRuleComputeHash(result);
+
     return result;
 } // vsccRuleEmpty
 
@@ -195,55 +545,78 @@ VsccRule * vsccRuleClone( const VsccRule *rule ) {
     switch (rule->type) {
     case VSCC_RULE_SEQUENCE : {
         // allocate temporary array
-        VsccRule **tmp = (VsccRule **)calloc(rule->sequence.count, sizeof(VsccRule *));
+        VsccRule **tmp = (VsccRule **)vsccAllocateZeroed(rule->allocator, rule->sequence.count, sizeof(VsccRule *));
 
         if (tmp == NULL)
             return NULL;
 
-        for (size_t i = 0; i < rule->sequence.count; i++)
+        for (size_t i = 0; i < rule->sequence.count; i++) {
             tmp[i] = vsccRuleClone(rule->sequence.rules[i]);
 
+            // destroy already cloned elements if clone failed
+            if (tmp[i] == NULL) {
+                for (size_t j = 0; j < i; j++)
+                    vsccRuleDtor(tmp[j]);
+                vsccDeallocate(rule->allocator, tmp);
+                return NULL;
+            }
+        }
+
         VsccRule *result = vsccRuleSequence(tmp, rule->sequence.count);
-        free(tmp);
+        vsccDeallocate(rule->allocator, tmp);
         return result;
     }
 
     case VSCC_RULE_VARIANT  : {
         // allocate temporary array
-        VsccRule **tmp = (VsccRule **)calloc(rule->variant.count, sizeof(VsccRule *));
+        VsccRule **tmp = (VsccRule **)vsccAllocateZeroed(rule->allocator, rule->variant.count, sizeof(VsccRule *));
 
         if (tmp == NULL)
             return NULL;
 
-        for (size_t i = 0; i < rule->variant.count; i++)
+        for (size_t i = 0; i < rule->variant.count; i++) {
             tmp[i] = vsccRuleClone(rule->variant.rules[i]);
 
+            // destroy already cloned elements if clone failed
+            if (tmp[i] == NULL) {
+                for (size_t j = 0; j < i; j++)
+                    vsccRuleDtor(tmp[j]);
+                vsccDeallocate(rule->allocator, tmp);
+                return NULL;
+            }
+        }
+
         VsccRule *result = vsccRuleVariant(tmp, rule->variant.count);
-        free(tmp);
+        vsccDeallocate(rule->allocator, tmp);
         return result;
 
     }
 
     case VSCC_RULE_OPTIONAL:
+        // vsccRuleOptional and vsccRuleRepeat return NULL for NULL child
         return vsccRuleOptional(vsccRuleClone(rule->optional));
 
     case VSCC_RULE_REPEAT:
         return vsccRuleRepeat(vsccRuleClone(rule->repeat.rule), rule->repeat.atLeastOnce);
 
     case VSCC_RULE_STRING_TERMINAL:
-        return vsccRuleStringTerminal(rule->stringTerminal);
+        return vsccRuleStringTerminalFromSlice(
+            rule->stringTerminal.string,
+            rule->stringTerminal.string + rule->stringTerminal.length,
+            rule->allocator
+        );
 
     case VSCC_RULE_CHAR_TERMINAL:
-        return vsccRuleCharTerminal(rule->charTerminal.ranges, rule->charTerminal.count);
+        return vsccRuleCharTerminal(rule->charTerminal.ranges, rule->charTerminal.count, rule->allocator);
 
     case VSCC_RULE_REFERENCE:
-        return vsccRuleReference(rule->reference);
+        return vsccRuleReference(rule->reference.name, rule->allocator);
 
     case VSCC_RULE_END      :
-        return vsccRuleEnd();
+        return vsccRuleEnd(rule->allocator);
 
     case VSCC_RULE_EMPTY    :
-        return vsccRuleEmpty();
+        return vsccRuleEmpty(rule->allocator);
     }
 
     assert(false && "Unreachable case reached.");
@@ -251,6 +624,9 @@ VsccRule * vsccRuleClone( const VsccRule *rule ) {
 } // vsccRuleClone
 
 void vsccRuleDtor( VsccRule *rule ) {
+    if (rule == NULL)
+        return;
+
     switch (rule->type) {
     case VSCC_RULE_SEQUENCE:
         for (size_t i = 0; i < rule->sequence.count; i++)
@@ -278,9 +654,42 @@ void vsccRuleDtor( VsccRule *rule ) {
         break;
     }
 
-    free(rule);
+    vsccDeallocate(rule->allocator, rule);
 } // vsccRuleDtor
 
+/**
+ * @brief character range bound display function
+ *
+ * @param[in] out       text file to write code point to
+ * @param[in] codePoint code point to display
+ */
+static void vsccRulePrintCodePoint( FILE *out, uint32_t codePoint ) {
+    if (codePoint == '-' || codePoint == ']' || codePoint == '\\')
+        fprintf(out, "\\%c", (char)codePoint);
+    else if (codePoint < 0x20 || codePoint == 0x7F)
+        fprintf(out, "\\x%02X", (unsigned)codePoint);
+    else if (codePoint < 0x80)
+        fprintf(out, "%c", (char)codePoint);
+    else if (codePoint < 0x800)
+        fprintf(out, "%c%c",
+            (char)(0xC0 | codePoint >> 6),
+            (char)(0x80 | (codePoint & 0x3F))
+        );
+    else if (codePoint < 0x10000)
+        fprintf(out, "%c%c%c",
+            (char)(0xE0 | codePoint >> 12),
+            (char)(0x80 | (codePoint >> 6 & 0x3F)),
+            (char)(0x80 | (codePoint & 0x3F))
+        );
+    else
+        fprintf(out, "%c%c%c%c",
+            (char)(0xF0 | codePoint >> 18),
+            (char)(0x80 | (codePoint >> 12 & 0x3F)),
+            (char)(0x80 | (codePoint >> 6 & 0x3F)),
+            (char)(0x80 | (codePoint & 0x3F))
+        );
+} // vsccRulePrintCodePoint
+
 void vsccRulePrint( FILE *out, const VsccRule *rule ) {
     switch (rule->type) {
     case VSCC_RULE_SEQUENCE: {
@@ -347,32 +756,30 @@ void vsccRulePrint( FILE *out, const VsccRule *rule ) {
     }
 
     case VSCC_RULE_STRING_TERMINAL:
-        fprintf(out, "\"%s\"", rule->stringTerminal);
+        fprintf(out, "\"%.*s\"", (int)rule->stringTerminal.length, rule->stringTerminal.string);
         break;
 
     case VSCC_RULE_CHAR_TERMINAL:
+        if (rule->charTerminal.count == 1 && rule->charTerminal.ranges[0].first == 0 && rule->charTerminal.ranges[0].last == VSCC_CODE_POINT_MAX) {
+            fprintf(out, "__char__");
+            break;
+        }
+
         fprintf(out, "[");
         for (size_t i = 0; i < rule->charTerminal.count; i++) {
             VsccRuleCharRange range = rule->charTerminal.ranges[i];
 
-            if (range.first == range.last)
-                fprintf(out, "%s%c",
-                    range.first == '-' ? "\\" : "",
-                    range.first
-                );
-            else
-                fprintf(out, "%s%c-%s%c",
-                    range.first == '-' ? "\\" : "",
-                    range.first,
-                    range.last == '-' ? "\\" : "",
-                    range.last
-                );
+            vsccRulePrintCodePoint(out, range.first);
+            if (range.first != range.last) {
+                fprintf(out, "-");
+                vsccRulePrintCodePoint(out, range.last);
+            }
         }
         fprintf(out, "]");
         break;
 
     case VSCC_RULE_REFERENCE:
-        fprintf(out, "%s", rule->reference);
+        fprintf(out, "%s", rule->reference.name);
         break;
 
     case VSCC_RULE_END:
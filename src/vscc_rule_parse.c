@@ -1,111 +1,658 @@
 /**
- * @brief rule parser implementation file
+ * @brief rule and grammar parser implementation file
  */
 
 #include <assert.h>
 #include <string.h>
-#include <ctype.h>
 
 #include "vscc.h"
 
+/// @brief referenced name slice (checked after all grammar rules are parsed)
+typedef struct __VsccRuleParserReference {
+    const char * begin; ///< name begin
+    const char * end;   ///< name end
+} VsccRuleParserReference;
+
 /// @brief parser representation structure
 typedef struct __VsccRuleParser {
-    const char         * strRest; ///< rest of string to be parsed
-    const char         * strEnd;  ///< end of substring to be parsed
+    const char          * strRest;    ///< rest of string to be parsed
+    const char          * strEnd;     ///< end of substring to be parsed
+    bool                  newlines;   ///< true if newlines are spaces outside of groups too
+
+    VsccRuleParseStatus   status;     ///< first error status (VSCC_RULE_PARSE_OK if there is no error)
+    const char          * error;      ///< first error position
+
+    VsccArray             rules;      ///< stack of parsed sequence/variant elements (VsccRule *)
+    VsccArray             bytes;      ///< string terminal and rule name scratch buffer (char)
+    VsccArray             ranges;     ///< char terminal scratch buffer (VsccRuleCharRange)
+    VsccArray             references; ///< referenced names (VsccRuleParserReference, nullable if not collected)
+
+    const VsccAllocator * allocator;  ///< allocator of parser and parsed rule memory (nullable)
 } VsccRuleParser;
 
-static void vsccRuleParserSkipSpaces( VsccRuleParser *self ) {
-    while (self->strRest < self->strEnd && isspace(*self->strRest))
-        self->strRest++;
+/**
+ * @brief parsing error reporting function
+ *
+ * @param[in,out] self     parser (non-null)
+ * @param[in]     status   error status
+ * @param[in]     position error position
+ *
+ * @return NULL (for convenience)
+ */
+static VsccRule * vsccRuleParserFail( VsccRuleParser *self, VsccRuleParseStatus status, const char *position ) {
+    if (self->status == VSCC_RULE_PARSE_OK) {
+        self->status = position >= self->strEnd && status == VSCC_RULE_PARSE_UNEXPECTED_CHARACTER
+            ? VSCC_RULE_PARSE_UNEXPECTED_TEXT_END
+            : status
+        ;
+        self->error = position;
+    }
+    return NULL;
+} // vsccRuleParserFail
+
+/**
+ * @brief space and comment skipping function
+ *
+ * @param[in,out] self     parser (non-null)
+ * @param[in]     newlines true if newlines should be skipped too (inside of groups)
+ */
+static void vsccRuleParserSkipSpaces( VsccRuleParser *self, bool newlines ) {
+    newlines = newlines || self->newlines;
+
+    while (self->strRest < self->strEnd) {
+        const char c = *self->strRest;
+
+        if (c == ' ' || c == '\t' || c == '\r' || (newlines && c == '\n'))
+            self->strRest++;
+        else if (c == '#')
+            while (self->strRest < self->strEnd && *self->strRest != '\n')
+                self->strRest++;
+        else
+            break;
+    }
 } // vsccRuleParserSkipSpaces
 
-static VsccRuleParseResult vsccRuleParseTerminal( VsccRuleParser *self ) {
-    vsccRuleParserSkipSpaces(self);
+/**
+ * @brief identifier character checking function
+ *
+ * @param[in] c character to check
+ *
+ * @return true if c may be part of identifier
+ */
+static bool vsccRuleParserIsIdent( char c ) {
+    return false
+        || (c >= 'a' && c <= 'z')
+        || (c >= 'A' && c <= 'Z')
+        || (c >= '0' && c <= '9')
+        || c == '_'
+    ;
+} // vsccRuleParserIsIdent
+
+/**
+ * @brief identifier parsing function
+ *
+ * @param[in,out] self parser (non-null)
+ * @param[out]    end  identifier end destination (non-null)
+ *
+ * @return identifier begin (NULL if there is no identifier)
+ */
+static const char * vsccRuleParseIdent( VsccRuleParser *self, const char **end ) {
+    const char *begin = self->strRest;
+
+    if (begin >= self->strEnd || !vsccRuleParserIsIdent(*begin) || (*begin >= '0' && *begin <= '9')) {
+        vsccRuleParserFail(self, VSCC_RULE_PARSE_UNEXPECTED_CHARACTER, begin);
+        return NULL;
+    }
+    while (self->strRest < self->strEnd && vsccRuleParserIsIdent(*self->strRest))
+        self->strRest++;
+
+    *end = self->strRest;
+    return begin;
+} // vsccRuleParseIdent
+
+/**
+ * @brief escaped or UTF-8 encoded code point parsing function
+ *
+ * @param[in,out] self      parser (non-null)
+ * @param[out]    codePoint code point destination (non-null)
+ *
+ * @return true if parsed, false if not
+ */
+static bool vsccRuleParseCodePoint( VsccRuleParser *self, uint32_t *codePoint ) {
+    const char *begin = self->strRest;
+
+    if (begin >= self->strEnd) {
+        vsccRuleParserFail(self, VSCC_RULE_PARSE_UNEXPECTED_TEXT_END, begin);
+        return false;
+    }
+
+    if (*begin != '\\') {
+        const size_t length = vsccDecodeUtf8(begin, self->strEnd, codePoint);
+
+        if (length == 0) {
+            vsccRuleParserFail(self, VSCC_RULE_PARSE_UNEXPECTED_CHARACTER, begin);
+            return false;
+        }
+        self->strRest += length;
+        return true;
+    }
+
+    if (++self->strRest >= self->strEnd) {
+        vsccRuleParserFail(self, VSCC_RULE_PARSE_UNEXPECTED_TEXT_END, self->strRest);
+        return false;
+    }
+
+    switch (*self->strRest++) {
+    case 'n': *codePoint = '\n'; return true;
+    case 't': *codePoint = '\t'; return true;
+    case 'r': *codePoint = '\r'; return true;
+    case '0': *codePoint = '\0'; return true;
+    case 'x': {
+        *codePoint = 0;
+
+        for (size_t i = 0; i < 2; i++) {
+            const char c = self->strRest < self->strEnd ? *self->strRest : '\0';
+
+            if (c >= '0' && c <= '9')
+                *codePoint = *codePoint * 16 + (c - '0');
+            else if (c >= 'a' && c <= 'f')
+                *codePoint = *codePoint * 16 + (c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F')
+                *codePoint = *codePoint * 16 + (c - 'A' + 10);
+            else {
+                vsccRuleParserFail(self, VSCC_RULE_PARSE_UNEXPECTED_CHARACTER, self->strRest);
+                return false;
+            }
+            self->strRest++;
+        }
+        return true;
+    }
+    default:
+        *codePoint = (uint8_t)self->strRest[-1];
+        return true;
+    }
+} // vsccRuleParseCodePoint
+
+/**
+ * @brief string terminal parsing function (strRest points after opening quote)
+ *
+ * @param[in,out] self parser (non-null)
+ *
+ * @return parsed rule (NULL if failed)
+ */
+static VsccRule * vsccRuleParseStringTerminal( VsccRuleParser *self ) {
+    vsccArrayTruncate(self->bytes, 0);
+
+    while (self->strRest < self->strEnd && *self->strRest != '"') {
+        char byte = *self->strRest;
+
+        if (byte != '\\') {
+            self->strRest++;
+        } else {
+            // escapes produce single bytes, so \xHH may build arbitrary byte strings
+            uint32_t codePoint = 0;
+
+            if (!vsccRuleParseCodePoint(self, &codePoint))
+                return NULL;
+            byte = (char)codePoint;
+        }
 
+        if (!vsccArrayPush(&self->bytes, &byte))
+            return vsccRuleParserFail(self, VSCC_RULE_PARSE_INTERNAL_ERROR, self->strRest);
+    }
     if (self->strRest >= self->strEnd)
-        return (VsccRuleParseResult) { .status = VSCC_RULE_PARSE_UNEXPECTED_TEXT_END };
-    
-    // currently processed character
-    char current = *self->strRest;
-
-    switch (current) {
-    case '[': {
-        assert(false && "Character range parsing isn't supported yet(");
-        break;
+        return vsccRuleParserFail(self, VSCC_RULE_PARSE_UNEXPECTED_TEXT_END, self->strRest);
+    self->strRest++;
+
+    const char *string = (const char *)vsccArrayData(self->bytes);
+    VsccRule *rule = vsccRuleStringTerminalFromSlice(string, string + vsccArraySize(self->bytes), self->allocator);
+
+    return rule == NULL
+        ? vsccRuleParserFail(self, VSCC_RULE_PARSE_INTERNAL_ERROR, self->strRest)
+        : rule
+    ;
+} // vsccRuleParseStringTerminal
+
+/**
+ * @brief char terminal parsing function (strRest points after opening bracket)
+ *
+ * @param[in,out] self parser (non-null)
+ *
+ * @return parsed rule (NULL if failed)
+ */
+static VsccRule * vsccRuleParseCharTerminal( VsccRuleParser *self ) {
+    vsccArrayTruncate(self->ranges, 0);
+
+    while (self->strRest < self->strEnd && *self->strRest != ']') {
+        const char *rangeBegin = self->strRest;
+        VsccRuleCharRange range = { .first = 0, .last = 0 };
+
+        if (!vsccRuleParseCodePoint(self, &range.first))
+            return NULL;
+        range.last = range.first;
+        if (self->strRest < self->strEnd && *self->strRest == '-') {
+            self->strRest++;
+            if (!vsccRuleParseCodePoint(self, &range.last))
+                return NULL;
+        }
+
+        if (range.first > range.last)
+            return vsccRuleParserFail(self, VSCC_RULE_PARSE_UNEXPECTED_CHARACTER, rangeBegin);
+        if (!vsccArrayPush(&self->ranges, &range))
+            return vsccRuleParserFail(self, VSCC_RULE_PARSE_INTERNAL_ERROR, rangeBegin);
     }
+    if (self->strRest >= self->strEnd)
+        return vsccRuleParserFail(self, VSCC_RULE_PARSE_UNEXPECTED_TEXT_END, self->strRest);
+    if (vsccArraySize(self->ranges) == 0)
+        return vsccRuleParserFail(self, VSCC_RULE_PARSE_UNEXPECTED_CHARACTER, self->strRest);
+    self->strRest++;
+
+    VsccRule *rule = vsccRuleCharTerminal((const VsccRuleCharRange *)vsccArrayData(self->ranges), vsccArraySize(self->ranges), self->allocator);
+
+    return rule == NULL
+        ? vsccRuleParserFail(self, VSCC_RULE_PARSE_INTERNAL_ERROR, self->strRest)
+        : rule
+    ;
+} // vsccRuleParseCharTerminal
+
+static VsccRule * vsccRuleParseVariants( VsccRuleParser *self, size_t depth );
+
+/**
+ * @brief terminal (or group) parsing function
+ *
+ * @param[in,out] self  parser (non-null)
+ * @param[in]     depth group nesting depth
+ *
+ * @return parsed rule (NULL if failed)
+ */
+static VsccRule * vsccRuleParseTerminal( VsccRuleParser *self, size_t depth ) {
+    if (self->strRest >= self->strEnd)
+        return vsccRuleParserFail(self, VSCC_RULE_PARSE_UNEXPECTED_TEXT_END, self->strRest);
+
+    VsccRule *rule = NULL;
+
+    switch (*self->strRest) {
+    case '"':
+        self->strRest++;
+        return vsccRuleParseStringTerminal(self);
+
+    case '[':
+        self->strRest++;
+        return vsccRuleParseCharTerminal(self);
 
     case '{': {
-        assert(false && "Group parsing isn't implemented yet");
+        self->strRest++;
+
+        if ((rule = vsccRuleParseVariants(self, depth + 1)) == NULL)
+            return NULL;
+
+        vsccRuleParserSkipSpaces(self, true);
+        if (self->strRest >= self->strEnd || *self->strRest != '}') {
+            vsccRuleDtor(rule);
+            return vsccRuleParserFail(self, VSCC_RULE_PARSE_UNEXPECTED_CHARACTER, self->strRest);
+        }
+        self->strRest++;
+        return rule;
+    }
+
+    case '$':
+        self->strRest++;
+        rule = vsccRuleEnd(self->allocator);
         break;
+
+    default: {
+        const char anyChar[] = "__char__";
+        const size_t anyCharLength = sizeof(anyChar) - 1;
+        const bool isAnyChar = true
+            && (size_t)(self->strEnd - self->strRest) >= anyCharLength
+            && memcmp(self->strRest, anyChar, anyCharLength) == 0
+            && (self->strRest + anyCharLength == self->strEnd || !vsccRuleParserIsIdent(self->strRest[anyCharLength]))
+        ;
+
+        if (isAnyChar) {
+            const VsccRuleCharRange range = { .first = 0, .last = VSCC_CODE_POINT_MAX };
+
+            self->strRest += anyCharLength;
+            rule = vsccRuleCharTerminal(&range, 1, self->allocator);
+            break;
+        }
+
+        VsccRuleParserReference reference = { .begin = NULL, .end = NULL };
+
+        if ((reference.begin = vsccRuleParseIdent(self, &reference.end)) == NULL)
+            return NULL;
+        if (self->references != NULL && !vsccArrayPush(&self->references, &reference))
+            return vsccRuleParserFail(self, VSCC_RULE_PARSE_INTERNAL_ERROR, reference.begin);
+        rule = vsccRuleReferernceFromSlice(reference.begin, reference.end, self->allocator);
+        break;
+    }
     }
 
-    case '\"': {
-        // parse string terminal
-        const char *termBegin = self->strRest + 1;
+    return rule == NULL
+        ? vsccRuleParserFail(self, VSCC_RULE_PARSE_INTERNAL_ERROR, self->strRest)
+        : rule
+    ;
+} // vsccRuleParseTerminal
 
-        while (self->strRest < self->strEnd && *self->strRest != '\"')
-            self->strRest++;
+/**
+ * @brief expression (terminal with postfix operators) parsing function
+ *
+ * @param[in,out] self  parser (non-null)
+ * @param[in]     depth group nesting depth
+ *
+ * @return parsed rule (NULL if failed)
+ */
+static VsccRule * vsccRuleParseExpression( VsccRuleParser *self, size_t depth ) {
+    VsccRule *rule = vsccRuleParseTerminal(self, depth);
 
-        VsccRule *rule = vsccRuleStringTerminalFromSlice(termBegin, self->strRest);
+    while (rule != NULL) {
+        vsccRuleParserSkipSpaces(self, depth > 0);
 
-        return rule == NULL
-            ? (VsccRuleParseResult) { .status = VSCC_RULE_PARSE_INTERNAL_ERROR }
-            : (VsccRuleParseResult) {
-                .status = VSCC_RULE_PARSE_OK,
-                .ok = rule,
-            }
+        if (self->strRest >= self->strEnd)
+            break;
+
+        if (*self->strRest == '?')
+            rule = vsccRuleOptional(rule);
+        else if (*self->strRest == '*' || *self->strRest == '+')
+            rule = vsccRuleRepeat(rule, *self->strRest == '+');
+        else
+            break;
+        self->strRest++;
+
+        if (rule == NULL)
+            return vsccRuleParserFail(self, VSCC_RULE_PARSE_INTERNAL_ERROR, self->strRest);
+    }
+    return rule;
+} // vsccRuleParseExpression
+
+/**
+ * @brief parsed element stack folding function
+ *
+ * @param[in,out] self    parser (non-null)
+ * @param[in]     base    stack size before first element is pushed
+ * @param[in]     variant true if elements are variant alternatives, false if they are sequence elements
+ *
+ * @note elements are popped from stack (and destroyed if parser already failed)
+ *
+ * @return folded rule (NULL if failed)
+ */
+static VsccRule * vsccRuleParserFold( VsccRuleParser *self, size_t base, bool variant ) {
+    VsccRule **elements = (VsccRule **)vsccArrayData(self->rules) + base;
+    const size_t count = vsccArraySize(self->rules) - base;
+    VsccRule *rule = NULL;
+
+    if (self->status != VSCC_RULE_PARSE_OK) {
+        for (size_t i = 0; i < count; i++)
+            vsccRuleDtor(elements[i]);
+    } else if (count == 0) {
+        rule = vsccRuleEmpty(self->allocator);
+    } else if (count == 1) {
+        rule = elements[0];
+    } else {
+        rule = variant
+            ? vsccRuleVariant(elements, count)
+            : vsccRuleSequence(elements, count)
         ;
     }
+    vsccArrayTruncate(self->rules, base);
 
-    default: {
-        VsccRule *result = NULL;
+    return rule == NULL
+        ? vsccRuleParserFail(self, VSCC_RULE_PARSE_INTERNAL_ERROR, self->strRest)
+        : rule
+    ;
+} // vsccRuleParserFold
 
-        const char *anyChar = "__char__";
-        const size_t anyCharLen = strlen(anyChar);
+/**
+ * @brief sequence parsing function
+ *
+ * @param[in,out] self  parser (non-null)
+ * @param[in]     depth group nesting depth
+ *
+ * @return parsed rule (NULL if failed)
+ */
+static VsccRule * vsccRuleParseSequence( VsccRuleParser *self, size_t depth ) {
+    const size_t base = vsccArraySize(self->rules);
 
-        if (self->strRest + anyCharLen <= self->strEnd && strncmp(self->strRest, anyChar, anyCharLen) == 0) {
-            self->strRest += anyCharLen;
+    for (;;) {
+        vsccRuleParserSkipSpaces(self, depth > 0);
+        if (false
+            || self->strRest >= self->strEnd
+            || *self->strRest == '|'
+            || *self->strRest == '}'
+            || *self->strRest == '\n'
+        )
+            break;
 
-            const VsccRuleCharRange range = { .first = '\x00', .last = '\xFF' };
+        VsccRule *rule = vsccRuleParseExpression(self, depth);
 
-            result = vsccRuleCharTerminal(&range, 1);
-        } else {
-            const char *identStart = self->strRest;
+        if (rule == NULL)
+            break;
+        if (!vsccArrayPush(&self->rules, &rule)) {
+            vsccRuleDtor(rule);
+            vsccRuleParserFail(self, VSCC_RULE_PARSE_INTERNAL_ERROR, self->strRest);
+            break;
+        }
+    }
 
-            // parse ident
-            while (self->strRest < self->strEnd && (isalnum(*self->strRest) || *self->strRest == '_'))
-                self->strRest++;
+    return vsccRuleParserFold(self, base, false);
+} // vsccRuleParseSequence
 
-            result = vsccRuleReferernceFromSlice(identStart, self->strRest);
+/**
+ * @brief variants parsing function
+ *
+ * @param[in,out] self  parser (non-null)
+ * @param[in]     depth group nesting depth
+ *
+ * @return parsed rule (NULL if failed)
+ */
+static VsccRule * vsccRuleParseVariants( VsccRuleParser *self, size_t depth ) {
+    const size_t base = vsccArraySize(self->rules);
+
+    for (;;) {
+        VsccRule *rule = vsccRuleParseSequence(self, depth);
+
+        if (rule == NULL)
+            break;
+        if (!vsccArrayPush(&self->rules, &rule)) {
+            vsccRuleDtor(rule);
+            vsccRuleParserFail(self, VSCC_RULE_PARSE_INTERNAL_ERROR, self->strRest);
+            break;
         }
 
-        return result == NULL
-            ? (VsccRuleParseResult) { .status = VSCC_RULE_PARSE_INTERNAL_ERROR }
-            : (VsccRuleParseResult) {
-                .status = VSCC_RULE_PARSE_OK,
-                .ok = result
+        vsccRuleParserSkipSpaces(self, depth > 0);
+        if (self->strRest >= self->strEnd || *self->strRest != '|')
+            break;
+        self->strRest++;
+    }
+
+    return vsccRuleParserFold(self, base, true);
+} // vsccRuleParseVariants
+
+/**
+ * @brief parser constructor
+ *
+ * @param[out] self       parser to construct (non-null)
+ * @param[in]  strBegin   text begin
+ * @param[in]  strEnd     text end
+ * @param[in]  references true if referenced names should be collected
+ * @param[in]  allocator  allocator of parser and parsed rule memory (nullable)
+ *
+ * @return true if constructed, false if allocation failed (parser is destructible anyway)
+ */
+static bool vsccRuleParserCtor( VsccRuleParser *self, const char *strBegin, const char *strEnd, bool references, const VsccAllocator *allocator ) {
+    self->strRest = strBegin;
+    self->strEnd = strEnd;
+    self->newlines = !references;
+    self->status = VSCC_RULE_PARSE_OK;
+    self->error = NULL;
+    self->allocator = allocator;
+    self->rules = vsccArrayCtor(sizeof(VsccRule *), allocator);
+    self->bytes = vsccArrayCtor(sizeof(char), allocator);
+    self->ranges = vsccArrayCtor(sizeof(VsccRuleCharRange), allocator);
+    self->references = references ? vsccArrayCtor(sizeof(VsccRuleParserReference), allocator) : NULL;
+
+    return true
+        && self->rules != NULL
+        && self->bytes != NULL
+        && self->ranges != NULL
+        && (!references || self->references != NULL)
+    ;
+} // vsccRuleParserCtor
+
+/**
+ * @brief parser destructor
+ *
+ * @param[in] self parser to destroy (non-null)
+ */
+static void vsccRuleParserDtor( VsccRuleParser *self ) {
+    vsccArrayDtor(self->rules);
+    vsccArrayDtor(self->bytes);
+    vsccArrayDtor(self->ranges);
+    vsccArrayDtor(self->references);
+} // vsccRuleParserDtor
+
+VsccRuleParseResult vsccRuleParse( const char *strBegin, const char *strEnd, const VsccAllocator *allocator ) {
+    assert(strBegin != NULL);
+    assert(strBegin <= strEnd);
+
+    VsccRuleParser parser;
+    VsccRuleParseResult result = { .status = VSCC_RULE_PARSE_INTERNAL_ERROR, .error = strBegin };
+
+    if (!vsccRuleParserCtor(&parser, strBegin, strEnd, false, allocator)) {
+        vsccRuleParserDtor(&parser);
+        return result;
+    }
+
+    VsccRule *rule = vsccRuleParseVariants(&parser, 0);
+
+    // whole slice must be one rule expression
+    vsccRuleParserSkipSpaces(&parser, true);
+    if (rule != NULL && parser.strRest < parser.strEnd) {
+        vsccRuleDtor(rule);
+        rule = vsccRuleParserFail(&parser, VSCC_RULE_PARSE_UNEXPECTED_CHARACTER, parser.strRest);
+    }
+
+    if (rule != NULL) {
+        result.status = VSCC_RULE_PARSE_OK;
+        result.ok = rule;
+    } else {
+        result.status = parser.status;
+        result.error = parser.error;
+    }
+
+    vsccRuleParserDtor(&parser);
+    return result;
+} // vsccRuleParse
+
+/**
+ * @brief grammar rule definitions parsing function
+ *
+ * @param[in,out] self    parser (non-null, constructed with reference collecting)
+ * @param[in,out] grammar grammar to add rules to (non-null)
+ *
+ * @return true if parsed, false if not (error is stored in parser)
+ */
+static bool vsccRuleParseDefinitions( VsccRuleParser *self, VsccGrammar *grammar ) {
+    for (;;) {
+        vsccRuleParserSkipSpaces(self, true);
+        if (self->strRest >= self->strEnd)
+            break;
+
+        const char *nameEnd = NULL;
+        const char *nameBegin = vsccRuleParseIdent(self, &nameEnd);
+
+        if (nameBegin == NULL)
+            return false;
+
+        vsccRuleParserSkipSpaces(self, false);
+        if (self->strEnd - self->strRest < 3 || memcmp(self->strRest, "::=", 3) != 0) {
+            vsccRuleParserFail(self, VSCC_RULE_PARSE_UNEXPECTED_CHARACTER, self->strRest);
+            return false;
+        }
+        self->strRest += 3;
+
+        VsccRule *rule = vsccRuleParseVariants(self, 0);
+
+        if (rule == NULL)
+            return false;
+
+        vsccRuleParserSkipSpaces(self, false);
+        if (self->strRest < self->strEnd && *self->strRest != '\n') {
+            vsccRuleDtor(rule);
+            vsccRuleParserFail(self, VSCC_RULE_PARSE_UNEXPECTED_CHARACTER, self->strRest);
+            return false;
+        }
+
+        // rule name is zero-terminated in scratch buffer (string terminals aren't parsed until rule is added)
+        const char zero = '\0';
+
+        vsccArrayTruncate(self->bytes, 0);
+        for (const char *c = nameBegin; c <= nameEnd; c++) {
+            if (!vsccArrayPush(&self->bytes, c < nameEnd ? c : &zero)) {
+                vsccRuleDtor(rule);
+                vsccRuleParserFail(self, VSCC_RULE_PARSE_INTERNAL_ERROR, nameBegin);
+                return false;
             }
-        ;
+        }
+
+        const char *name = (const char *)vsccArrayData(self->bytes);
+
+        if (vsccGrammarFindRule(grammar, name) != grammar->ruleCount) {
+            vsccRuleDtor(rule);
+            vsccRuleParserFail(self, VSCC_RULE_PARSE_RULE_REDEFINED, nameBegin);
+            return false;
+        }
+        if (!vsccGrammarAddRule(grammar, name, rule)) {
+            vsccRuleParserFail(self, VSCC_RULE_PARSE_INTERNAL_ERROR, nameBegin);
+            return false;
+        }
     }
+
+    // references are checked here, as linking can't tell where unresolved ones are
+    const VsccRuleParserReference *references = (const VsccRuleParserReference *)vsccArrayData(self->references);
+
+    for (size_t i = 0; i < vsccArraySize(self->references); i++) {
+        const size_t length = references[i].end - references[i].begin;
+        bool found = false;
+
+        for (size_t j = 0; !found && j < grammar->ruleCount; j++)
+            found = strlen(grammar->rules[j].name) == length && memcmp(grammar->rules[j].name, references[i].begin, length) == 0;
+
+        if (!found) {
+            vsccRuleParserFail(self, VSCC_RULE_PARSE_UNDEFINED_REFERENCE, references[i].begin);
+            return false;
+        }
     }
 
-} // vsccRuleParseTerminal
+    return true;
+} // vsccRuleParseDefinitions
 
-static VsccRuleParseResult vsccRuleParseImpl( VsccRuleParser *self ) {
-    return vsccRuleParseTerminal(self); // Tough Mega Parser solution, actually
-} // vsccRuleParseImpl
+VsccGrammarParseResult vsccGrammarParse( const char *strBegin, const char *strEnd, const VsccAllocator *allocator ) {
+    assert(strBegin != NULL);
+    assert(strBegin <= strEnd);
 
-VsccRuleParseResult vsccRuleParse( const char *strBegin, const char *strEnd ) {
-    VsccRuleParser parser = (VsccRuleParser) {
-        .strRest = strBegin,
-        .strEnd  = strEnd,
-    };
+    VsccRuleParser parser;
+    VsccGrammarParseResult result = { .status = VSCC_RULE_PARSE_INTERNAL_ERROR, .error = strBegin };
+    const bool constructed = vsccRuleParserCtor(&parser, strBegin, strEnd, true, allocator);
+    VsccGrammar *grammar = vsccGrammarCtor(allocator);
 
-    // skip initial spaces
-    vsccRuleParserSkipSpaces(&parser);
+    if (grammar == NULL || !constructed)
+        goto vsccGrammarParse_end;
 
-    assert(false && "rule parsing is not implemented yet");
-    return (VsccRuleParseResult) {};
-} // vsccRuleParse
+    if (!vsccRuleParseDefinitions(&parser, grammar)) {
+        result.status = parser.status;
+        result.error = parser.error;
+        goto vsccGrammarParse_end;
+    }
+
+    result.status = VSCC_RULE_PARSE_OK;
+    result.ok = grammar;
+    grammar = NULL;
+
+vsccGrammarParse_end:
+    vsccGrammarDtor(grammar);
+    vsccRuleParserDtor(&parser);
+    return result;
+} // vsccGrammarParse
 
 // vscc_rule_parse.c
@@ -0,0 +1,905 @@
+/**
+ * @brief compile-time grammar embedding header
+ *
+ * @note this header is C++20-only. Grammar source uses .vsg syntax (see examples/grammar.vsg),
+ * is parsed during compilation into a constexpr node table and matched by template-specialized
+ * functions, so matching needs no runtime parsing, linking or allocation.
+ */
+
+#ifndef VSCC_STATIC_H_
+#define VSCC_STATIC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "vscc.h"
+
+/// @brief no node/rule index
+#define VSCC_STATIC_NONE SIZE_MAX
+
+/**
+ * @brief compile-time grammar error reporting function
+ *
+ * @param[in] message error message
+ *
+ * @note it is intentionally not constexpr, so reaching it during constant evaluation
+ * stops compilation with error pointing to message
+ */
+inline void vsccStaticError( const char *message ) {
+    (void)message;
+} // vsccStaticError
+
+/// @brief string literal usable as template argument
+template <size_t N>
+struct VsccStaticString {
+    static constexpr size_t size = N; ///< literal size (including terminating zero)
+
+    char data[N]; ///< literal characters
+
+    /**
+     * @brief string literal constructor
+     *
+     * @param[in] literal literal to copy
+     */
+    constexpr VsccStaticString( const char (&literal)[N] ) : data() {
+        for (size_t i = 0; i < N; i++)
+            data[i] = literal[i];
+    } // VsccStaticString
+}; // VsccStaticString
+
+/**
+ * @brief constexpr UTF-8 code point decoding function (same semantics as vsccDecodeUtf8)
+ *
+ * @param[in]  strBegin  text begin
+ * @param[in]  strEnd    text end
+ * @param[out] codePoint decoded code point
+ *
+ * @return length of decoded sequence, 0 if text is empty or sequence is invalid
+ */
+constexpr size_t vsccStaticDecodeUtf8( const char *strBegin, const char *strEnd, uint32_t *codePoint ) {
+    const size_t available = strEnd - strBegin;
+
+    if (available == 0)
+        return 0;
+
+    const uint8_t first = (uint8_t)strBegin[0];
+
+    if (first < 0x80) {
+        *codePoint = first;
+        return 1;
+    }
+
+    size_t length = 0;
+    uint32_t result = 0;
+    uint32_t minimum = 0;
+
+    if ((first & 0xE0) == 0xC0) {
+        length = 2;
+        result = first & 0x1F;
+        minimum = 0x80;
+    } else if ((first & 0xF0) == 0xE0) {
+        length = 3;
+        result = first & 0x0F;
+        minimum = 0x800;
+    } else if ((first & 0xF8) == 0xF0) {
+        length = 4;
+        result = first & 0x07;
+        minimum = 0x10000;
+    } else {
+        return 0;
+    }
+
+    if (length > available)
+        return 0;
+
+    for (size_t i = 1; i < length; i++) {
+        const uint8_t next = (uint8_t)strBegin[i];
+
+        if ((next & 0xC0) != 0x80)
+            return 0;
+        result = result << 6 | (next & 0x3F);
+    }
+
+    if (result < minimum || result > VSCC_CODE_POINT_MAX || (result >= 0xD800 && result <= 0xDFFF))
+        return 0;
+
+    *codePoint = result;
+    return length;
+} // vsccStaticDecodeUtf8
+
+/// @brief compile-time grammar node
+typedef struct __VsccStaticNode {
+    VsccRuleType type;        ///< node type (same meaning as for VsccRule)
+    size_t       child;       ///< first child (sequence, variant, optional, repeat)
+    size_t       next;        ///< next sibling in parent sequence/variant
+    size_t       begin;       ///< first string pool character (string terminal, reference name) or first range (char terminal)
+    size_t       count;       ///< string length or range count
+    size_t       index;       ///< referenced rule index (reference)
+    bool         atLeastOnce; ///< repeat kind (repeat)
+} VsccStaticNode;
+
+/// @brief compile-time grammar rule
+typedef struct __VsccStaticRule {
+    size_t name; ///< rule name (zero-terminated) first string pool character
+    size_t node; ///< rule root node
+} VsccStaticRule;
+
+/**
+ * @brief compile-time grammar node table
+ *
+ * @tparam N grammar source size (bounds all table parts)
+ */
+template <size_t N>
+struct VsccStaticTable {
+    VsccStaticNode    nodes[2 * N + 2] = {}; ///< nodes
+    size_t            nodeCount        = 0;  ///< count of nodes
+    char              pool[2 * N + 2]  = {}; ///< string terminal contents and zero-terminated names
+    size_t            poolSize         = 0;  ///< count of used pool characters
+    VsccRuleCharRange ranges[N + 1]    = {}; ///< char terminal ranges
+    size_t            rangeCount       = 0;  ///< count of ranges
+    VsccStaticRule    rules[N + 1]     = {}; ///< rules
+    size_t            ruleCount        = 0;  ///< count of rules
+
+    /**
+     * @brief rule by name finding function
+     *
+     * @param[in] name zero-terminated rule name
+     *
+     * @return rule index, ruleCount if there is no such rule
+     */
+    constexpr size_t findRule( const char *name ) const {
+        for (size_t i = 0; i < ruleCount; i++) {
+            const char *ruleName = pool + rules[i].name;
+            size_t j = 0;
+
+            while (ruleName[j] != '\0' && ruleName[j] == name[j])
+                j++;
+            if (ruleName[j] == name[j])
+                return i;
+        }
+        return ruleCount;
+    } // findRule
+}; // VsccStaticTable
+
+/// @brief compile-time .vsg parser
+template <size_t N>
+struct VsccStaticParser {
+    VsccStaticTable<N> table = {};   ///< table being built
+    const char       * rest = NULL;  ///< rest of source
+    const char       * end  = NULL;  ///< source end
+
+    /**
+     * @brief node adding function
+     *
+     * @param[in] node node to add
+     *
+     * @return node index
+     */
+    constexpr size_t addNode( VsccStaticNode node ) {
+        if (table.nodeCount == sizeof(table.nodes) / sizeof(table.nodes[0]))
+            vsccStaticError("Node table overflow.");
+        table.nodes[table.nodeCount] = node;
+        return table.nodeCount++;
+    } // addNode
+
+    /**
+     * @brief empty-childrened node of certain type adding function
+     *
+     * @param[in] type  node type
+     * @param[in] child first child
+     *
+     * @return node index
+     */
+    constexpr size_t addNode( VsccRuleType type, size_t child = VSCC_STATIC_NONE ) {
+        return addNode(VsccStaticNode {
+            .type        = type,
+            .child       = child,
+            .next        = VSCC_STATIC_NONE,
+            .begin       = 0,
+            .count       = 0,
+            .index       = VSCC_STATIC_NONE,
+            .atLeastOnce = false,
+        });
+    } // addNode
+
+    /**
+     * @brief space and comment skipping function
+     *
+     * @param[in] newlines true if newlines should be skipped too (inside of groups)
+     */
+    constexpr void skip( bool newlines ) {
+        while (rest < end) {
+            if (*rest == ' ' || *rest == '\t' || *rest == '\r' || (newlines && *rest == '\n'))
+                rest++;
+            else if (*rest == '#')
+                while (rest < end && *rest != '\n')
+                    rest++;
+            else
+                break;
+        }
+    } // skip
+
+    /**
+     * @brief identifier character checking function
+     *
+     * @param[in] c character to check
+     *
+     * @return true if c may be part of identifier
+     */
+    static constexpr bool isIdent( char c ) {
+        return false
+            || (c >= 'a' && c <= 'z')
+            || (c >= 'A' && c <= 'Z')
+            || (c >= '0' && c <= '9')
+            || c == '_'
+        ;
+    } // isIdent
+
+    /**
+     * @brief identifier parsing function
+     *
+     * @return identifier first pool character (identifier is zero-terminated)
+     */
+    constexpr size_t parseIdent( void ) {
+        const size_t name = table.poolSize;
+
+        if (rest >= end || !isIdent(*rest) || (*rest >= '0' && *rest <= '9'))
+            vsccStaticError("Identifier expected.");
+        while (rest < end && isIdent(*rest))
+            table.pool[table.poolSize++] = *rest++;
+        table.pool[table.poolSize++] = '\0';
+        return name;
+    } // parseIdent
+
+    /**
+     * @brief escaped or UTF-8 encoded code point parsing function
+     *
+     * @return parsed code point
+     */
+    constexpr uint32_t parseCodePoint( void ) {
+        if (rest >= end)
+            vsccStaticError("Unexpected grammar end.");
+
+        if (*rest != '\\') {
+            uint32_t codePoint = 0;
+            const size_t length = vsccStaticDecodeUtf8(rest, end, &codePoint);
+
+            if (length == 0)
+                vsccStaticError("Invalid UTF-8 sequence.");
+            rest += length;
+            return codePoint;
+        }
+
+        if (++rest >= end)
+            vsccStaticError("Unexpected grammar end.");
+
+        switch (*rest++) {
+        case 'n': return '\n';
+        case 't': return '\t';
+        case 'r': return '\r';
+        case '0': return '\0';
+        case 'x': {
+            uint32_t codePoint = 0;
+
+            for (size_t i = 0; i < 2; i++) {
+                const char c = rest < end ? *rest++ : '\0';
+
+                if (c >= '0' && c <= '9')
+                    codePoint = codePoint * 16 + (c - '0');
+                else if (c >= 'a' && c <= 'f')
+                    codePoint = codePoint * 16 + (c - 'a' + 10);
+                else if (c >= 'A' && c <= 'F')
+                    codePoint = codePoint * 16 + (c - 'A' + 10);
+                else
+                    vsccStaticError("Invalid \\x escape.");
+            }
+            return codePoint;
+        }
+        default:
+            return (uint8_t)rest[-1];
+        }
+    } // parseCodePoint
+
+    /**
+     * @brief string terminal parsing function (rest points after opening quote)
+     *
+     * @return parsed node index
+     */
+    constexpr size_t parseStringTerminal( void ) {
+        const size_t begin = table.poolSize;
+
+        while (rest < end && *rest != '"') {
+            if (*rest != '\\') {
+                table.pool[table.poolSize++] = *rest++;
+                continue;
+            }
+
+            // escapes produce single bytes, so \xHH may build arbitrary byte strings
+            table.pool[table.poolSize++] = (char)parseCodePoint();
+        }
+        if (rest >= end)
+            vsccStaticError("Unterminated string terminal.");
+        rest++;
+
+        VsccStaticNode node = {
+            .type        = VSCC_RULE_STRING_TERMINAL,
+            .child       = VSCC_STATIC_NONE,
+            .next        = VSCC_STATIC_NONE,
+            .begin       = begin,
+            .count       = table.poolSize - begin,
+            .index       = VSCC_STATIC_NONE,
+            .atLeastOnce = false,
+        };
+        table.pool[table.poolSize++] = '\0';
+        return addNode(node);
+    } // parseStringTerminal
+
+    /**
+     * @brief char terminal parsing function (rest points after opening bracket)
+     *
+     * @return parsed node index
+     */
+    constexpr size_t parseCharTerminal( void ) {
+        const size_t begin = table.rangeCount;
+
+        while (rest < end && *rest != ']') {
+            VsccRuleCharRange range = {};
+
+            range.first = parseCodePoint();
+            range.last = range.first;
+            if (rest < end && *rest == '-') {
+                rest++;
+                range.last = parseCodePoint();
+            }
+            if (range.first > range.last)
+                vsccStaticError("Invalid character range.");
+            table.ranges[table.rangeCount++] = range;
+        }
+        if (rest >= end)
+            vsccStaticError("Unterminated character terminal.");
+        if (table.rangeCount == begin)
+            vsccStaticError("Empty character terminal.");
+        rest++;
+
+        return addNode(VsccStaticNode {
+            .type        = VSCC_RULE_CHAR_TERMINAL,
+            .child       = VSCC_STATIC_NONE,
+            .next        = VSCC_STATIC_NONE,
+            .begin       = begin,
+            .count       = table.rangeCount - begin,
+            .index       = VSCC_STATIC_NONE,
+            .atLeastOnce = false,
+        });
+    } // parseCharTerminal
+
+    /**
+     * @brief terminal (or group) parsing function
+     *
+     * @param[in] depth group nesting depth
+     *
+     * @return parsed node index
+     */
+    constexpr size_t parseTerminal( size_t depth ) {
+        if (rest >= end)
+            vsccStaticError("Unexpected grammar end.");
+
+        switch (*rest) {
+        case '"':
+            rest++;
+            return parseStringTerminal();
+
+        case '[':
+            rest++;
+            return parseCharTerminal();
+
+        case '{': {
+            rest++;
+
+            const size_t node = parseVariants(depth + 1);
+
+            skip(true);
+            if (rest >= end || *rest != '}')
+                vsccStaticError("'}' expected.");
+            rest++;
+            return node;
+        }
+
+        case '$':
+            rest++;
+            return addNode(VSCC_RULE_END);
+
+        default: {
+            const char anyChar[] = "__char__";
+            const size_t anyCharLength = sizeof(anyChar) - 1;
+            bool isAnyChar = (size_t)(end - rest) >= anyCharLength;
+
+            for (size_t i = 0; isAnyChar && i < anyCharLength; i++)
+                isAnyChar = rest[i] == anyChar[i];
+            isAnyChar = isAnyChar && (rest + anyCharLength == end || !isIdent(rest[anyCharLength]));
+
+            if (isAnyChar) {
+                rest += anyCharLength;
+                table.ranges[table.rangeCount++] = VsccRuleCharRange { .first = 0, .last = VSCC_CODE_POINT_MAX };
+
+                return addNode(VsccStaticNode {
+                    .type        = VSCC_RULE_CHAR_TERMINAL,
+                    .child       = VSCC_STATIC_NONE,
+                    .next        = VSCC_STATIC_NONE,
+                    .begin       = table.rangeCount - 1,
+                    .count       = 1,
+                    .index       = VSCC_STATIC_NONE,
+                    .atLeastOnce = false,
+                });
+            }
+
+            VsccStaticNode node = {
+                .type        = VSCC_RULE_REFERENCE,
+                .child       = VSCC_STATIC_NONE,
+                .next        = VSCC_STATIC_NONE,
+                .begin       = 0,
+                .count       = 0,
+                .index       = VSCC_STATIC_NONE,
+                .atLeastOnce = false,
+            };
+
+            node.begin = parseIdent();
+            return addNode(node);
+        }
+        }
+    } // parseTerminal
+
+    /**
+     * @brief expression (terminal with postfix operators) parsing function
+     *
+     * @param[in] depth group nesting depth
+     *
+     * @return parsed node index
+     */
+    constexpr size_t parseExpression( size_t depth ) {
+        size_t node = parseTerminal(depth);
+
+        for (;;) {
+            skip(depth > 0);
+
+            if (rest >= end)
+                break;
+
+            if (*rest == '?') {
+                node = addNode(VSCC_RULE_OPTIONAL, node);
+            } else if (*rest == '*' || *rest == '+') {
+                node = addNode(VSCC_RULE_REPEAT, node);
+                table.nodes[node].atLeastOnce = *rest == '+';
+            } else {
+                break;
+            }
+            rest++;
+        }
+        return node;
+    } // parseExpression
+
+    /**
+     * @brief sequence parsing function
+     *
+     * @param[in] depth group nesting depth
+     *
+     * @return parsed node index
+     */
+    constexpr size_t parseSequence( size_t depth ) {
+        size_t first = VSCC_STATIC_NONE;
+        size_t last = VSCC_STATIC_NONE;
+        size_t count = 0;
+
+        for (;;) {
+            skip(depth > 0);
+            if (rest >= end || *rest == '|' || *rest == '}' || *rest == '\n')
+                break;
+
+            const size_t node = parseExpression(depth);
+
+            if (count++ == 0)
+                first = node;
+            else
+                table.nodes[last].next = node;
+            last = node;
+        }
+
+        if (count == 0)
+            return addNode(VSCC_RULE_EMPTY);
+        return count == 1
+            ? first
+            : addNode(VSCC_RULE_SEQUENCE, first)
+        ;
+    } // parseSequence
+
+    /**
+     * @brief variants parsing function
+     *
+     * @param[in] depth group nesting depth
+     *
+     * @return parsed node index
+     */
+    constexpr size_t parseVariants( size_t depth ) {
+        const size_t first = parseSequence(depth);
+        size_t last = first;
+        size_t count = 1;
+
+        for (;;) {
+            skip(depth > 0);
+            if (rest >= end || *rest != '|')
+                break;
+            rest++;
+
+            const size_t node = parseSequence(depth);
+
+            table.nodes[last].next = node;
+            last = node;
+            count++;
+        }
+
+        return count == 1
+            ? first
+            : addNode(VSCC_RULE_VARIANT, first)
+        ;
+    } // parseVariants
+
+    /**
+     * @brief grammar parsing function
+     *
+     * @param[in] source grammar source
+     */
+    constexpr void parse( const char (&source)[N] ) {
+        rest = source;
+        end = source + N - 1;
+
+        for (;;) {
+            skip(true);
+            if (rest >= end)
+                break;
+
+            const size_t name = parseIdent();
+
+            skip(false);
+            if (end - rest < 3 || rest[0] != ':' || rest[1] != ':' || rest[2] != '=')
+                vsccStaticError("'::=' expected.");
+            rest += 3;
+
+            if (table.findRule(table.pool + name) != table.ruleCount)
+                vsccStaticError("Rule redefined.");
+
+            const size_t node = parseVariants(0);
+
+            skip(false);
+            if (rest < end && *rest != '\n')
+                vsccStaticError("Unexpected character.");
+
+            table.rules[table.ruleCount++] = VsccStaticRule { .name = name, .node = node };
+        }
+
+        // resolve references
+        for (size_t i = 0; i < table.nodeCount; i++) {
+            if (table.nodes[i].type != VSCC_RULE_REFERENCE)
+                continue;
+
+            table.nodes[i].index = table.findRule(table.pool + table.nodes[i].begin);
+            if (table.nodes[i].index == table.ruleCount)
+                vsccStaticError("Reference to undefined rule.");
+        }
+    } // parse
+}; // VsccStaticParser
+
+/**
+ * @brief compile-time .vsg grammar parsing function
+ *
+ * @tparam Source grammar source
+ *
+ * @return grammar node table
+ */
+template <VsccStaticString Source>
+constexpr VsccStaticTable<Source.size> vsccStaticParse( void ) {
+    VsccStaticParser<Source.size> parser = {};
+
+    parser.parse(Source.data);
+    return parser.table;
+} // vsccStaticParse
+
+/**
+ * @brief compile-time embedded grammar
+ *
+ * @tparam Source grammar source in .vsg syntax
+ *
+ * @note matching follows VsccMatcher semantics (ordered choice, repeats stop on empty iteration),
+ * but only recognizes text: actions, recovery and diagnostics are provided by runtime path (see build)
+ */
+template <VsccStaticString Source>
+struct VsccStaticGrammar {
+    /// @brief grammar node table
+    static constexpr VsccStaticTable<Source.size> table = vsccStaticParse<Source>();
+
+    /**
+     * @brief node matching function
+     *
+     * @tparam Node node index
+     *
+     * @param[in,out] cursor text cursor (garbage on failure)
+     * @param[in]     end    text end
+     *
+     * @return true if matched, false otherwise
+     */
+    template <size_t Node>
+    static inline bool matchNode( const char *&cursor, const char *end ) {
+        constexpr VsccStaticNode node = table.nodes[Node];
+
+        if constexpr (node.type == VSCC_RULE_SEQUENCE) {
+            return matchSequence<node.child>(cursor, end);
+        } else if constexpr (node.type == VSCC_RULE_VARIANT) {
+            const char *start = cursor;
+
+            return matchVariant<node.child>(cursor, end, start);
+        } else if constexpr (node.type == VSCC_RULE_OPTIONAL) {
+            const char *start = cursor;
+
+            if (!matchNode<node.child>(cursor, end))
+                cursor = start;
+            return true;
+        } else if constexpr (node.type == VSCC_RULE_REPEAT) {
+            if constexpr (node.atLeastOnce)
+                if (!matchNode<node.child>(cursor, end))
+                    return false;
+
+            for (;;) {
+                const char *start = cursor;
+
+                if (!matchNode<node.child>(cursor, end)) {
+                    cursor = start;
+                    return true;
+                }
+                if (cursor == start)
+                    return true;
+            }
+        } else if constexpr (node.type == VSCC_RULE_STRING_TERMINAL) {
+            if ((size_t)(end - cursor) < node.count || memcmp(cursor, table.pool + node.begin, node.count) != 0)
+                return false;
+            cursor += node.count;
+            return true;
+        } else if constexpr (node.type == VSCC_RULE_CHAR_TERMINAL) {
+            return matchCharTerminal<Node>(cursor, end);
+        } else if constexpr (node.type == VSCC_RULE_REFERENCE) {
+            return matchRule<node.index>(cursor, end);
+        } else if constexpr (node.type == VSCC_RULE_END) {
+            return cursor == end;
+        } else {
+            return true;
+        }
+    } // matchNode
+
+    /**
+     * @brief sequence elements matching function
+     *
+     * @tparam Node first element to match
+     */
+    template <size_t Node>
+    static inline bool matchSequence( const char *&cursor, const char *end ) {
+        if (!matchNode<Node>(cursor, end))
+            return false;
+        if constexpr (table.nodes[Node].next != VSCC_STATIC_NONE)
+            return matchSequence<table.nodes[Node].next>(cursor, end);
+        return true;
+    } // matchSequence
+
+    /**
+     * @brief variant alternatives matching function
+     *
+     * @tparam Node first alternative to try
+     *
+     * @param[in] start variant start position
+     */
+    template <size_t Node>
+    static inline bool matchVariant( const char *&cursor, const char *end, const char *start ) {
+        if (matchNode<Node>(cursor, end))
+            return true;
+        if constexpr (table.nodes[Node].next != VSCC_STATIC_NONE) {
+            cursor = start;
+            return matchVariant<table.nodes[Node].next>(cursor, end, start);
+        }
+        return false;
+    } // matchVariant
+
+    /**
+     * @brief char terminal matching function
+     *
+     * @tparam Node char terminal node
+     */
+    template <size_t Node>
+    static inline bool matchCharTerminal( const char *&cursor, const char *end ) {
+        constexpr VsccStaticNode node = table.nodes[Node];
+        constexpr uint64_t asciiLow = asciiBitmap(node, 0);
+        constexpr uint64_t asciiHigh = asciiBitmap(node, 64);
+
+        if (cursor == end)
+            return false;
+
+        const uint8_t first = (uint8_t)*cursor;
+
+        if (first < 0x80) {
+            if (!(((first < 64 ? asciiLow : asciiHigh) >> first % 64) & 1))
+                return false;
+            cursor++;
+            return true;
+        }
+
+        uint32_t codePoint = 0;
+        const size_t length = vsccStaticDecodeUtf8(cursor, end, &codePoint);
+
+        if (length == 0)
+            return false;
+
+        for (size_t i = 0; i < node.count; i++)
+            if (table.ranges[node.begin + i].first <= codePoint && codePoint <= table.ranges[node.begin + i].last) {
+                cursor += length;
+                return true;
+            }
+        return false;
+    } // matchCharTerminal
+
+    /**
+     * @brief char terminal ASCII bitmap half computing function
+     *
+     * @param[in] node  char terminal node
+     * @param[in] first first character of bitmap half (0 or 64)
+     *
+     * @return bitmap half
+     */
+    static constexpr uint64_t asciiBitmap( VsccStaticNode node, uint32_t first ) {
+        uint64_t bitmap = 0;
+
+        for (size_t i = 0; i < node.count; i++)
+            for (uint32_t c = first; c < first + 64; c++)
+                if (table.ranges[node.begin + i].first <= c && c <= table.ranges[node.begin + i].last)
+                    bitmap |= (uint64_t)1 << (c - first);
+        return bitmap;
+    } // asciiBitmap
+
+    /**
+     * @brief rule matching function
+     *
+     * @tparam Rule rule index
+     */
+    template <size_t Rule>
+    static bool matchRule( const char *&cursor, const char *end ) {
+        return matchNode<table.rules[Rule].node>(cursor, end);
+    } // matchRule
+
+    /**
+     * @brief grammar matching function
+     *
+     * @tparam Name name of rule to start from
+     *
+     * @param[in]  strBegin text begin (non-null)
+     * @param[in]  strEnd   text end
+     * @param[out] length   matched prefix length (non-null)
+     *
+     * @return true if rule matched, false otherwise
+     */
+    template <VsccStaticString Name>
+    static bool match( const char *strBegin, const char *strEnd, size_t *length ) {
+        constexpr size_t rule = table.findRule(Name.data);
+
+        static_assert(rule != table.ruleCount, "Unknown rule name.");
+
+        const char *cursor = strBegin;
+
+        if (!matchRule<rule>(cursor, strEnd))
+            return false;
+        *length = cursor - strBegin;
+        return true;
+    } // match
+
+    /**
+     * @brief node to runtime rule converting function
+     *
+     * @param[in] index     node index
+     * @param[in] allocator rule allocator (nullable)
+     *
+     * @return created rule (may be NULL)
+     */
+    static VsccRule * buildRule( size_t index, const VsccAllocator *allocator ) {
+        const VsccStaticNode node = table.nodes[index];
+
+        switch (node.type) {
+        case VSCC_RULE_SEQUENCE:
+        case VSCC_RULE_VARIANT: {
+            size_t count = 0;
+
+            for (size_t child = node.child; child != VSCC_STATIC_NONE; child = table.nodes[child].next)
+                count++;
+
+            VsccRule **rules = (VsccRule **)vsccAllocateZeroed(allocator, count, sizeof(VsccRule *));
+            VsccRule *result = NULL;
+            bool built = rules != NULL;
+            size_t i = 0;
+
+            for (size_t child = node.child; built && child != VSCC_STATIC_NONE; child = table.nodes[child].next) {
+                rules[i] = buildRule(child, allocator);
+                built = rules[i++] != NULL;
+            }
+
+            if (built)
+                result = node.type == VSCC_RULE_SEQUENCE
+                    ? vsccRuleSequence(rules, count)
+                    : vsccRuleVariant(rules, count)
+                ;
+            else
+                for (size_t j = 0; rules != NULL && j + 1 < i; j++)
+                    vsccRuleDtor(rules[j]);
+
+            vsccDeallocate(allocator, rules);
+            return result;
+        }
+
+        case VSCC_RULE_OPTIONAL: {
+            VsccRule *child = buildRule(node.child, allocator);
+
+            return child == NULL
+                ? NULL
+                : vsccRuleOptional(child)
+            ;
+        }
+
+        case VSCC_RULE_REPEAT: {
+            VsccRule *child = buildRule(node.child, allocator);
+
+            return child == NULL
+                ? NULL
+                : vsccRuleRepeat(child, node.atLeastOnce)
+            ;
+        }
+
+        case VSCC_RULE_STRING_TERMINAL:
+            return vsccRuleStringTerminalFromSlice(table.pool + node.begin, table.pool + node.begin + node.count, allocator);
+
+        case VSCC_RULE_CHAR_TERMINAL:
+            return vsccRuleCharTerminal(table.ranges + node.begin, node.count, allocator);
+
+        case VSCC_RULE_REFERENCE:
+            return vsccRuleReference(table.pool + node.begin, allocator);
+
+        case VSCC_RULE_END:
+            return vsccRuleEnd(allocator);
+
+        case VSCC_RULE_EMPTY:
+            return vsccRuleEmpty(allocator);
+        }
+
+        return NULL;
+    } // buildRule
+
+    /**
+     * @brief runtime grammar building function
+     *
+     * @note built grammar matches exactly same texts as compile-time one,
+     * so it's the way to get actions, recovery and diagnostics for embedded grammar
+     *
+     * @param[in] allocator grammar allocator (nullable, must outlive grammar)
+     *
+     * @return linked grammar with same rule order (NULL if failed)
+     */
+    static VsccGrammar * build( const VsccAllocator *allocator ) {
+        VsccGrammar *grammar = vsccGrammarCtor(allocator);
+        bool built = grammar != NULL;
+
+        for (size_t i = 0; built && i < table.ruleCount; i++)
+            built = vsccGrammarAddRule(grammar, table.pool + table.rules[i].name, buildRule(table.rules[i].node, allocator));
+
+        if (!built || !vsccGrammarLink(grammar)) {
+            vsccGrammarDtor(grammar);
+            return NULL;
+        }
+        return grammar;
+    } // build
+}; // VsccStaticGrammar
+
+#endif // !defined(VSCC_STATIC_H_)
+
+// vscc_static.h
@@ -0,0 +1,316 @@
+/**
+ * @brief allocation failure handling check
+ *
+ * @note builds grammar, matcher, JIT and lexer and runs them with counting allocator limited to
+ * budgets up to their peak usage. Every operation must either succeed with the same result as
+ * unlimited one or fail gracefully (and succeed at peak budget), and all memory must be freed
+ * after destruction.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "vscc.h"
+
+/// @brief checked grammar (has memoized rule, terminal alternation automaton and token rules)
+static const char vsccAllocatorCheckSource[] =
+    "file ::= ws { stmt }* $\n"
+    "stmt ::= \"let\" ws id ws \"=\" ws expr \";\" ws | expr \";\" ws | expr \",\" ws\n"
+    "expr ::= term { op ws term }*\n"
+    "op   ::= \"+\" | \"-\" | \"*\" | \"/\" | \"%\"\n"
+    "term ::= { num | id | \"(\" ws expr \")\" } ws\n"
+    "id   ::= [a-z]+\n"
+    "num  ::= [0-9]+\n"
+    "ws   ::= [ \\n]*\n"
+    "sep  ::= [;,=()]\n"
+;
+
+/// @brief checked input (has errors, so recovery allocates too)
+static const char vsccAllocatorCheckInput[] =
+    "let x = 1 + 2;\n"
+    "x * (y - 3), let = ;\n"
+    "let abc = (a + b) % c;\n"
+    "a + * b;\n"
+    "q;\n"
+;
+
+/**
+ * @brief next sweep limit getting function
+ *
+ * @param[in] limit     current limit
+ * @param[in] peakSize  peak size of unlimited run (last checked limit)
+ *
+ * @return next checked limit (> peakSize if sweep is finished)
+ */
+static size_t vsccAllocatorCheckNextLimit( size_t limit, size_t peakSize ) {
+    if (limit == peakSize)
+        return SIZE_MAX;
+
+    const size_t next = limit + 1 + limit / 64;
+
+    return next < peakSize
+        ? next
+        : peakSize
+    ;
+} // vsccAllocatorCheckNextLimit
+
+/**
+ * @brief grammar building function
+ *
+ * @param[in] allocator allocator of grammar memory (nullable)
+ * @param[in] tokens    true if grammar terminals should be token rules
+ *
+ * @return linked grammar (NULL if building failed)
+ */
+static VsccGrammar * vsccAllocatorCheckGrammar( const VsccAllocator *allocator, bool tokens ) {
+    const VsccGrammarParseResult result = vsccGrammarParse(vsccAllocatorCheckSource, vsccAllocatorCheckSource + sizeof(vsccAllocatorCheckSource) - 1, allocator);
+
+    if (result.status != VSCC_RULE_PARSE_OK) {
+        // allocation failure is the only possible failure reason
+        if (result.status != VSCC_RULE_PARSE_INTERNAL_ERROR)
+            printf("grammar parsing failed with status %d\n", (int)result.status);
+        return NULL;
+    }
+
+    bool succeeded = vsccGrammarSetRecover(result.ok, "stmt", true);
+
+    if (tokens)
+        succeeded = true
+            && succeeded
+            && vsccGrammarSetToken(result.ok, "op", VSCC_TOKEN_EMIT)
+            && vsccGrammarSetToken(result.ok, "id", VSCC_TOKEN_EMIT)
+            && vsccGrammarSetToken(result.ok, "num", VSCC_TOKEN_EMIT)
+            && vsccGrammarSetToken(result.ok, "sep", VSCC_TOKEN_EMIT)
+            && vsccGrammarSetToken(result.ok, "ws", VSCC_TOKEN_SKIP)
+        ;
+
+    succeeded = succeeded && vsccGrammarLink(result.ok);
+
+    if (succeeded)
+        return result.ok;
+
+    vsccGrammarDtor(result.ok);
+    return NULL;
+} // vsccAllocatorCheckGrammar
+
+/**
+ * @brief leak checking function
+ *
+ * @param[in] counting counting allocator everything allocated by was destroyed (non-null)
+ * @param[in] name     name of checked operation
+ * @param[in] limit    allocator limit
+ *
+ * @return true if all memory is freed, false otherwise
+ */
+static bool vsccAllocatorCheckLeak( const VsccCountingAllocator *counting, const char *name, size_t limit ) {
+    if (counting->size == 0)
+        return true;
+
+    printf("%s with limit %zu: %zu bytes leaked\n", name, limit, counting->size);
+    return false;
+} // vsccAllocatorCheckLeak
+
+/**
+ * @brief grammar building sweep function
+ *
+ * @return true if succeeded, false otherwise
+ */
+static bool vsccAllocatorCheckGrammarSweep( void ) {
+    VsccCountingAllocator counting;
+
+    vsccCountingAllocatorInit(&counting, NULL, SIZE_MAX);
+
+    VsccGrammar *grammar = vsccAllocatorCheckGrammar(&counting.allocator, false);
+    const size_t peakSize = counting.peakSize;
+    bool succeeded = grammar != NULL;
+
+    vsccGrammarDtor(grammar);
+
+    for (size_t limit = 0; succeeded && limit <= peakSize; limit = vsccAllocatorCheckNextLimit(limit, peakSize)) {
+        vsccCountingAllocatorInit(&counting, NULL, limit);
+        grammar = vsccAllocatorCheckGrammar(&counting.allocator, false);
+        succeeded = grammar != NULL || limit != peakSize;
+        vsccGrammarDtor(grammar);
+        succeeded = succeeded && vsccAllocatorCheckLeak(&counting, "grammar building", limit);
+    }
+
+    return succeeded;
+} // vsccAllocatorCheckGrammarSweep
+
+/**
+ * @brief matcher sweep function
+ *
+ * @param[in] grammar grammar (non-null, linked)
+ *
+ * @note matcher runs twice to check that it stays usable after failed run
+ *
+ * @return true if succeeded, false otherwise
+ */
+static bool vsccAllocatorCheckMatcherSweep( const VsccGrammar *grammar ) {
+    const char *input = vsccAllocatorCheckInput;
+    const char *inputEnd = input + sizeof(vsccAllocatorCheckInput) - 1;
+    VsccCountingAllocator counting;
+
+    vsccCountingAllocatorInit(&counting, NULL, SIZE_MAX);
+
+    VsccMatcher matcher = vsccMatcherCtor(grammar, &counting.allocator);
+    const VsccMatchStatus status = matcher == NULL ? VSCC_MATCH_INTERNAL_ERROR : vsccMatcherRun(matcher, 0, input, inputEnd);
+    const size_t length = matcher == NULL ? 0 : vsccMatcherLength(matcher);
+    const size_t errorCount = matcher == NULL ? 0 : vsccMatcherErrorCount(matcher);
+    const size_t peakSize = counting.peakSize;
+    bool succeeded = status == VSCC_MATCH_RECOVERED;
+
+    vsccMatcherDtor(matcher);
+
+    if (!succeeded)
+        printf("unlimited matcher run failed with status %d\n", (int)status);
+
+    for (size_t limit = 0; succeeded && limit <= peakSize; limit = vsccAllocatorCheckNextLimit(limit, peakSize)) {
+        vsccCountingAllocatorInit(&counting, NULL, limit);
+        matcher = vsccMatcherCtor(grammar, &counting.allocator);
+        succeeded = matcher != NULL || limit != peakSize;
+
+        for (size_t run = 0; succeeded && matcher != NULL && run < 2; run++) {
+            const VsccMatchStatus limitedStatus = vsccMatcherRun(matcher, 0, input, inputEnd);
+
+            succeeded = false
+                || (limitedStatus == VSCC_MATCH_INTERNAL_ERROR && limit != peakSize)
+                || (true
+                    && limitedStatus == status
+                    && vsccMatcherLength(matcher) == length
+                    && vsccMatcherErrorCount(matcher) == errorCount
+                )
+            ;
+            if (!succeeded)
+                printf("matcher run with limit %zu: unexpected status %d\n", limit, (int)limitedStatus);
+        }
+
+        vsccMatcherDtor(matcher);
+        succeeded = succeeded && vsccAllocatorCheckLeak(&counting, "matcher run", limit);
+    }
+
+    return succeeded;
+} // vsccAllocatorCheckMatcherSweep
+
+/**
+ * @brief JIT compilation sweep function
+ *
+ * @param[in] grammar grammar (non-null, linked)
+ *
+ * @return true if succeeded, false otherwise
+ */
+static bool vsccAllocatorCheckJitSweep( const VsccGrammar *grammar ) {
+    const char input[] = "1;";
+    VsccCountingAllocator counting;
+
+    vsccCountingAllocatorInit(&counting, NULL, SIZE_MAX);
+
+    VsccJit jit = vsccJitCtor(grammar, &counting.allocator);
+    const size_t peakSize = counting.peakSize;
+    const bool compiled = jit != NULL;
+    bool succeeded = true;
+
+    vsccJitDtor(jit);
+
+    // platforms without JIT allocate nothing, so sweep is empty there
+    for (size_t limit = 0; succeeded && compiled && limit <= peakSize; limit = vsccAllocatorCheckNextLimit(limit, peakSize)) {
+        size_t length = 0;
+
+        vsccCountingAllocatorInit(&counting, NULL, limit);
+        jit = vsccJitCtor(grammar, &counting.allocator);
+        if (jit == NULL ? limit == peakSize : vsccJitMatch(jit, 0, input, input + sizeof(input) - 1, &length) != VSCC_MATCH_OK) {
+            printf("JIT compiled with limit %zu doesn't match\n", limit);
+            succeeded = false;
+        }
+        vsccJitDtor(jit);
+        succeeded = succeeded && vsccAllocatorCheckLeak(&counting, "JIT compilation", limit);
+    }
+
+    return succeeded;
+} // vsccAllocatorCheckJitSweep
+
+/**
+ * @brief lexer sweep function
+ *
+ * @param[in] grammar grammar with token rules (non-null, linked)
+ *
+ * @return true if succeeded, false otherwise
+ */
+static bool vsccAllocatorCheckLexerSweep( const VsccGrammar *grammar ) {
+    const char *input = vsccAllocatorCheckInput;
+    const char *inputEnd = input + sizeof(vsccAllocatorCheckInput) - 1;
+    VsccCountingAllocator counting;
+
+    vsccCountingAllocatorInit(&counting, NULL, SIZE_MAX);
+
+    VsccLexer lexer = vsccLexerCtor(grammar, &counting.allocator);
+    VsccArray tokens = vsccArrayCtor(sizeof(VsccToken), &counting.allocator);
+    const VsccLexStatus status = lexer == NULL || tokens == NULL
+        ? VSCC_LEX_INTERNAL_ERROR
+        : vsccLexerRun(lexer, input, inputEnd, &tokens, NULL)
+    ;
+    const size_t tokenCount = status == VSCC_LEX_OK ? vsccArraySize(tokens) : 0;
+    const size_t peakSize = counting.peakSize;
+    bool succeeded = status == VSCC_LEX_OK;
+
+    vsccArrayDtor(tokens);
+    vsccLexerDtor(lexer);
+
+    if (!succeeded)
+        printf("unlimited lexer run failed with status %d\n", (int)status);
+
+    for (size_t limit = 0; succeeded && limit <= peakSize; limit = vsccAllocatorCheckNextLimit(limit, peakSize)) {
+        vsccCountingAllocatorInit(&counting, NULL, limit);
+        lexer = vsccLexerCtor(grammar, &counting.allocator);
+        tokens = vsccArrayCtor(sizeof(VsccToken), &counting.allocator);
+
+        succeeded = (lexer != NULL && tokens != NULL) || limit != peakSize;
+
+        if (lexer != NULL && tokens != NULL) {
+            const VsccLexStatus limitedStatus = vsccLexerRun(lexer, input, inputEnd, &tokens, NULL);
+
+            succeeded = false
+                || (limitedStatus == VSCC_LEX_INTERNAL_ERROR && limit != peakSize)
+                || (limitedStatus == VSCC_LEX_OK && vsccArraySize(tokens) == tokenCount)
+            ;
+            if (!succeeded)
+                printf("lexer run with limit %zu: unexpected status %d\n", limit, (int)limitedStatus);
+        }
+
+        vsccArrayDtor(tokens);
+        vsccLexerDtor(lexer);
+        succeeded = succeeded && vsccAllocatorCheckLeak(&counting, "lexer run", limit);
+    }
+
+    return succeeded;
+} // vsccAllocatorCheckLexerSweep
+
+/**
+ * @brief check main function
+ *
+ * @return exit status (0 if succeeded, 1 otherwise)
+ */
+int main( void ) {
+    VsccGrammar *grammar = vsccAllocatorCheckGrammar(NULL, false);
+    VsccGrammar *tokenGrammar = vsccAllocatorCheckGrammar(NULL, true);
+    bool succeeded = grammar != NULL && tokenGrammar != NULL;
+
+    if (!succeeded)
+        printf("grammar building failed\n");
+
+    succeeded = true
+        && succeeded
+        && vsccAllocatorCheckGrammarSweep()
+        && vsccAllocatorCheckMatcherSweep(grammar)
+        && vsccAllocatorCheckJitSweep(grammar)
+        && vsccAllocatorCheckLexerSweep(tokenGrammar)
+    ;
+
+    printf(succeeded ? "allocator check passed\n" : "allocator check failed\n");
+
+    vsccGrammarDtor(grammar);
+    vsccGrammarDtor(tokenGrammar);
+    return succeeded ? 0 : 1;
+} // main
+
+// vscc_allocator_check.c
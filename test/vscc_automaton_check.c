@@ -0,0 +1,375 @@
+/**
+ * @brief lazy DFA and ordered terminal choice equivalence check
+ *
+ * @note matches inputs by lazy DFAs of random terminal alternations and by trying alternatives
+ * in order, first matched alternative and its length must be equal. Keyword alternation check
+ * walks more states than DFA cache holds, so it covers cache flushes and fallback to NFA simulation.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "vscc.h"
+#include "vscc_check.h"
+
+/// @brief count of generated alternations
+#define VSCC_AUTOMATON_CHECK_ALTERNATION_COUNT 300
+
+/// @brief count of inputs matched by every alternation
+#define VSCC_AUTOMATON_CHECK_INPUT_COUNT 1000
+
+/// @brief maximal count of code points in generated input
+#define VSCC_AUTOMATON_CHECK_INPUT_LENGTH 8
+
+/// @brief count of keywords in keyword alternation
+#define VSCC_AUTOMATON_CHECK_KEYWORD_COUNT 2000
+
+/// @brief maximal keyword length
+#define VSCC_AUTOMATON_CHECK_KEYWORD_LENGTH 12
+
+/// @brief count of keywords scanned in cache-friendly pass
+#define VSCC_AUTOMATON_CHECK_HOT_KEYWORD_COUNT 16
+
+/**
+ * @brief random code point generating function
+ *
+ * @param[in,out] state generator state (non-null)
+ *
+ * @return code point (not a surrogate)
+ */
+static uint32_t vsccAutomatonCheckCodePoint( uint32_t *state ) {
+    const uint32_t codePoint = vsccCheckRandom(state, 3) == 0
+        ? vsccCheckRandom(state, 0x80)
+        : vsccCheckRandom(state, 0x8000) << 5 | vsccCheckRandom(state, 32)
+    ;
+
+    return codePoint > VSCC_CODE_POINT_MAX || (codePoint >= 0xD800 && codePoint <= 0xDFFF)
+        ? 'A'
+        : codePoint
+    ;
+} // vsccAutomatonCheckCodePoint
+
+/**
+ * @brief code point encoding function
+ *
+ * @param[in]  codePoint code point to encode (<= VSCC_CODE_POINT_MAX)
+ * @param[out] str       UTF-8 destination (non-null, at least 4 bytes)
+ *
+ * @return encoded code point size
+ */
+static size_t vsccAutomatonCheckEncode( uint32_t codePoint, char *str ) {
+    if (codePoint < 0x80) {
+        str[0] = (char)codePoint;
+        return 1;
+    }
+    if (codePoint < 0x800) {
+        str[0] = (char)(0xC0 | codePoint >> 6);
+        str[1] = (char)(0x80 | (codePoint & 0x3F));
+        return 2;
+    }
+    if (codePoint < 0x10000) {
+        str[0] = (char)(0xE0 | codePoint >> 12);
+        str[1] = (char)(0x80 | (codePoint >> 6 & 0x3F));
+        str[2] = (char)(0x80 | (codePoint & 0x3F));
+        return 3;
+    }
+    str[0] = (char)(0xF0 | codePoint >> 18);
+    str[1] = (char)(0x80 | (codePoint >> 12 & 0x3F));
+    str[2] = (char)(0x80 | (codePoint >> 6 & 0x3F));
+    str[3] = (char)(0x80 | (codePoint & 0x3F));
+    return 4;
+} // vsccAutomatonCheckEncode
+
+/**
+ * @brief ordered choice matching function (reference DFA results are compared with)
+ *
+ * @param[in]  nfa         NFA (non-null)
+ * @param[in]  strBegin    text begin (non-null)
+ * @param[in]  strEnd      text end
+ * @param[out] alternative index of first matched alternative destination (non-null)
+ * @param[out] length      matched alternative length destination (non-null)
+ *
+ * @return true if some alternative matched, false otherwise
+ */
+static bool vsccAutomatonCheckOrderedMatch( const VsccNfa nfa, const char *strBegin, const char *strEnd, size_t *alternative, size_t *length ) {
+    for (size_t i = 0; i < vsccNfaAlternativeCount(nfa); i++) {
+        const VsccRule *rule = vsccNfaAlternative(nfa, i);
+
+        *alternative = i;
+        if (rule->type == VSCC_RULE_STRING_TERMINAL) {
+            *length = rule->stringTerminal.length;
+            if (vsccRuleStringTerminalMatch(rule, strBegin, strEnd))
+                return true;
+        } else {
+            *length = vsccRuleCharTerminalMatch(rule, strBegin, strEnd);
+            if (*length != 0)
+                return true;
+        }
+    }
+
+    return false;
+} // vsccAutomatonCheckOrderedMatch
+
+/**
+ * @brief single input checking function
+ *
+ * @param[in,out] dfa      lazy DFA (non-null)
+ * @param[in]     nfa      NFA DFA is built of (non-null)
+ * @param[in]     strBegin text begin (non-null)
+ * @param[in]     strEnd   text end
+ * @param[out]    length   matched length destination (nullable, 0 if nothing matched)
+ *
+ * @return true if results are equal, false otherwise
+ */
+static bool vsccAutomatonCheckInput( VsccLazyDfa dfa, const VsccNfa nfa, const char *strBegin, const char *strEnd, size_t *length ) {
+    size_t alternative = 0, matchedLength = 0;
+    size_t orderedAlternative = 0, orderedLength = 0;
+    const bool matched = vsccLazyDfaMatch(dfa, strBegin, strEnd, &alternative, &matchedLength);
+    const bool orderedMatched = vsccAutomatonCheckOrderedMatch(nfa, strBegin, strEnd, &orderedAlternative, &orderedLength);
+
+    if (length != NULL)
+        *length = matched ? matchedLength : 0;
+
+    if (matched == orderedMatched && (!matched || (alternative == orderedAlternative && matchedLength == orderedLength)))
+        return true;
+
+    printf("MISMATCH \"%.*s\": DFA %s (%zu, %zu), ordered choice %s (%zu, %zu)\n",
+        (int)(strEnd - strBegin),
+        strBegin,
+        matched ? "matched" : "failed",
+        alternative,
+        matchedLength,
+        orderedMatched ? "matched" : "failed",
+        orderedAlternative,
+        orderedLength
+    );
+    return false;
+} // vsccAutomatonCheckInput
+
+/**
+ * @brief random alternation checking function
+ *
+ * @param[in,out] state            generator state (non-null)
+ * @param[in]     alternativeCount count of alternatives (>= 4)
+ *
+ * @return count of mismatched results (SIZE_MAX if alternation building failed)
+ */
+static size_t vsccAutomatonCheckAlternation( uint32_t *state, size_t alternativeCount ) {
+    VsccRule **alternatives = (VsccRule **)calloc(alternativeCount, sizeof(VsccRule *));
+
+    if (alternatives == NULL)
+        return SIZE_MAX;
+
+    for (size_t i = 0; i < alternativeCount; i++) {
+        if (vsccCheckRandom(state, 4) == 0) {
+            VsccRuleCharRange ranges[3];
+            const size_t count = 1 + vsccCheckRandom(state, 3);
+
+            for (size_t j = 0; j < count; j++) {
+                ranges[j].first = vsccAutomatonCheckCodePoint(state);
+                ranges[j].last = ranges[j].first + vsccCheckRandom(state, 300);
+                if (ranges[j].last > VSCC_CODE_POINT_MAX)
+                    ranges[j].last = VSCC_CODE_POINT_MAX;
+            }
+            alternatives[i] = vsccRuleCharTerminal(ranges, count, NULL);
+        } else {
+            char terminal[16];
+            size_t length = 0;
+            const size_t count = vsccCheckRandom(state, 6);
+
+            for (size_t j = 0; j < count; j++) {
+                const char *piece = vsccCheckPieces[vsccCheckRandom(state, 4)];
+
+                memcpy(terminal + length, piece, strlen(piece));
+                length += strlen(piece);
+            }
+            terminal[length] = '\0';
+            alternatives[i] = vsccRuleStringTerminal(terminal, NULL);
+        }
+    }
+
+    VsccRule *variant = vsccRuleVariant(alternatives, alternativeCount);
+    VsccNfa nfa = variant == NULL ? NULL : vsccNfaCtor(variant, NULL, NULL);
+    VsccLazyDfa dfa = nfa == NULL ? NULL : vsccLazyDfaCtor(nfa, NULL);
+    size_t mismatchCount = 0;
+
+    free(alternatives);
+
+    if (dfa == NULL) {
+        vsccNfaDtor(nfa);
+        vsccRuleDtor(variant);
+        return SIZE_MAX;
+    }
+
+    for (size_t i = 0; i < VSCC_AUTOMATON_CHECK_INPUT_COUNT; i++) {
+        char input[VSCC_AUTOMATON_CHECK_INPUT_LENGTH * 4];
+        size_t size = 0;
+        const size_t length = vsccCheckRandom(state, VSCC_AUTOMATON_CHECK_INPUT_LENGTH + 1);
+
+        for (size_t j = 0; j < length; j++) {
+            if (vsccCheckRandom(state, 3) == 0)
+                size += vsccAutomatonCheckEncode(vsccAutomatonCheckCodePoint(state), input + size);
+            else {
+                const char *piece = vsccCheckPieces[vsccCheckRandom(state, 4)];
+
+                memcpy(input + size, piece, strlen(piece));
+                size += strlen(piece);
+            }
+        }
+
+        // some inputs are broken UTF-8
+        if (size != 0 && vsccCheckRandom(state, 10) == 0)
+            input[vsccCheckRandom(state, (uint32_t)size)] ^= 0x40;
+
+        mismatchCount += !vsccAutomatonCheckInput(dfa, nfa, input, input + size, NULL);
+    }
+
+    vsccLazyDfaDtor(dfa);
+    vsccNfaDtor(nfa);
+    vsccRuleDtor(variant);
+    return mismatchCount;
+} // vsccAutomatonCheckAlternation
+
+/**
+ * @brief text scanning checking function
+ *
+ * @param[in,out] dfa      lazy DFA (non-null)
+ * @param[in]     nfa      NFA DFA is built of (non-null)
+ * @param[in]     text     text to scan (non-null)
+ * @param[in]     textSize text size
+ *
+ * @note text is matched at every offset alternative ends at
+ *
+ * @return count of mismatched results
+ */
+static size_t vsccAutomatonCheckScan( VsccLazyDfa dfa, const VsccNfa nfa, const char *text, size_t textSize ) {
+    size_t mismatchCount = 0;
+
+    for (size_t offset = 0; offset < textSize; ) {
+        size_t length = 0;
+
+        mismatchCount += !vsccAutomatonCheckInput(dfa, nfa, text + offset, text + textSize, &length);
+        offset += length == 0 ? 1 : length;
+    }
+
+    return mismatchCount;
+} // vsccAutomatonCheckScan
+
+/**
+ * @brief keyword alternation checking function
+ *
+ * @param[in,out] state generator state (non-null)
+ *
+ * @note few keywords are scanned first, so cache lives long enough to be flushed without
+ *       switching to simulation. Then all keywords are scanned, cache thrashes and DFA
+ *       falls back to NFA simulation.
+ *
+ * @return count of mismatched results (SIZE_MAX if alternation building failed)
+ */
+static size_t vsccAutomatonCheckKeywords( uint32_t *state ) {
+    const size_t keywordStride = VSCC_AUTOMATON_CHECK_KEYWORD_LENGTH + 1;
+    VsccRule **alternatives = (VsccRule **)calloc(VSCC_AUTOMATON_CHECK_KEYWORD_COUNT, sizeof(VsccRule *));
+    char *keywords = (char *)calloc(VSCC_AUTOMATON_CHECK_KEYWORD_COUNT, keywordStride);
+    char *text = (char *)malloc(VSCC_AUTOMATON_CHECK_KEYWORD_COUNT * VSCC_AUTOMATON_CHECK_KEYWORD_LENGTH);
+
+    if (alternatives == NULL || keywords == NULL || text == NULL) {
+        free(alternatives);
+        free(keywords);
+        free(text);
+        return SIZE_MAX;
+    }
+
+    for (size_t i = 0; i < VSCC_AUTOMATON_CHECK_KEYWORD_COUNT; i++) {
+        char *keyword = keywords + i * keywordStride;
+        const size_t length = 4 + vsccCheckRandom(state, VSCC_AUTOMATON_CHECK_KEYWORD_LENGTH - 3);
+
+        for (size_t j = 0; j < length; j++)
+            keyword[j] = (char)('a' + vsccCheckRandom(state, 26));
+        alternatives[i] = vsccRuleStringTerminal(keyword, NULL);
+    }
+
+    VsccRule *variant = vsccRuleVariant(alternatives, VSCC_AUTOMATON_CHECK_KEYWORD_COUNT);
+    VsccNfa nfa = variant == NULL ? NULL : vsccNfaCtor(variant, NULL, NULL);
+    VsccLazyDfa dfa = nfa == NULL ? NULL : vsccLazyDfaCtor(nfa, NULL);
+    size_t mismatchCount = SIZE_MAX;
+
+    free(alternatives);
+
+    if (dfa != NULL) {
+        size_t textSize = 0;
+
+        mismatchCount = 0;
+
+        // hot keywords only, cache is flushed once all of them are built
+        for (size_t pass = 0; pass < 4; pass++) {
+            textSize = 0;
+            for (size_t i = 0; i < VSCC_AUTOMATON_CHECK_KEYWORD_COUNT; i++) {
+                const char *keyword = keywords + (vsccCheckRandom(state, 8) == 0 ? i : i % VSCC_AUTOMATON_CHECK_HOT_KEYWORD_COUNT) * keywordStride;
+
+                memcpy(text + textSize, keyword, strlen(keyword));
+                textSize += strlen(keyword);
+            }
+            mismatchCount += vsccAutomatonCheckScan(dfa, nfa, text, textSize);
+        }
+
+        // every keyword builds its own states, so caches don't live long
+        for (size_t pass = 0; pass < 2; pass++) {
+            textSize = 0;
+            for (size_t i = 0; i < VSCC_AUTOMATON_CHECK_KEYWORD_COUNT; i++) {
+                const char *keyword = keywords + vsccCheckRandom(state, VSCC_AUTOMATON_CHECK_KEYWORD_COUNT) * keywordStride;
+
+                memcpy(text + textSize, keyword, strlen(keyword));
+                textSize += strlen(keyword);
+            }
+            mismatchCount += vsccAutomatonCheckScan(dfa, nfa, text, textSize);
+        }
+    }
+
+    vsccLazyDfaDtor(dfa);
+    vsccNfaDtor(nfa);
+    vsccRuleDtor(variant);
+    free(keywords);
+    free(text);
+    return mismatchCount;
+} // vsccAutomatonCheckKeywords
+
+/**
+ * @brief check main function
+ *
+ * @return exit status (0 if all results are equal, 1 otherwise)
+ */
+int main( void ) {
+    uint32_t state = 1;
+    size_t mismatchCount = 0;
+
+    for (size_t i = 0; mismatchCount != SIZE_MAX && i < VSCC_AUTOMATON_CHECK_ALTERNATION_COUNT; i++) {
+        // most alternations are small, some have hundreds of alternatives
+        const size_t alternationMismatchCount = vsccAutomatonCheckAlternation(&state, i % 10 == 0
+            ? 4 + vsccCheckRandom(&state, 400)
+            : 4 + vsccCheckRandom(&state, 10)
+        );
+
+        mismatchCount = alternationMismatchCount == SIZE_MAX
+            ? SIZE_MAX
+            : mismatchCount + alternationMismatchCount
+        ;
+    }
+
+    if (mismatchCount != SIZE_MAX) {
+        const size_t keywordMismatchCount = vsccAutomatonCheckKeywords(&state);
+
+        mismatchCount = keywordMismatchCount == SIZE_MAX
+            ? SIZE_MAX
+            : mismatchCount + keywordMismatchCount
+        ;
+    }
+
+    if (mismatchCount == SIZE_MAX)
+        printf("automaton building failed\n");
+    else
+        printf("%zu mismatches\n", mismatchCount);
+    return mismatchCount == 0 ? 0 : 1;
+} // main
+
+// vscc_automaton_check.c
@@ -0,0 +1,187 @@
+/**
+ * @brief differential check utility header
+ *
+ * @note random grammars and inputs are generated by fixed-seed LCG, so every check run
+ * covers the same cases and failures are reproducible
+ */
+
+#ifndef VSCC_CHECK_H_
+#define VSCC_CHECK_H_
+
+#include <stdio.h>
+#include <string.h>
+
+#include "vscc.h"
+
+/// @brief maximal nesting depth of generated rules (deeper rules are terminals)
+#define VSCC_CHECK_RULE_DEPTH 4
+
+/// @brief pieces generated inputs are made of (first three are pieces of string terminals)
+static const char *vsccCheckPieces[] = { "a", "b", "é", "c", "d" };
+
+/// @brief count of pieces string terminals are made of
+#define VSCC_CHECK_TERMINAL_PIECE_COUNT 3
+
+/**
+ * @brief random number generating function
+ *
+ * @param[in,out] state generator state (non-null)
+ * @param[in]     bound number upper bound (>= 1, <= 65536)
+ *
+ * @return number in [0, bound) range
+ */
+static inline uint32_t vsccCheckRandom( uint32_t *state, uint32_t bound ) {
+    *state = *state * 1664525 + 1013904223;
+    return (*state >> 16) % bound;
+} // vsccCheckRandom
+
+/**
+ * @brief random input generating function
+ *
+ * @param[in,out] state     generator state (non-null)
+ * @param[out]    input     input destination (non-null, at least maxPieces * 2 bytes)
+ * @param[in]     maxPieces maximal count of pieces in input
+ *
+ * @return generated input size
+ */
+static inline size_t vsccCheckRandomInput( uint32_t *state, char *input, size_t maxPieces ) {
+    const size_t count = vsccCheckRandom(state, (uint32_t)maxPieces + 1);
+    size_t size = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        // pieces no string terminal starts with are rarer, so inputs are mostly matched past first bytes
+        const char *piece = vsccCheckRandom(state, 4) != 0
+            ? vsccCheckPieces[vsccCheckRandom(state, VSCC_CHECK_TERMINAL_PIECE_COUNT)]
+            : vsccCheckPieces[VSCC_CHECK_TERMINAL_PIECE_COUNT + vsccCheckRandom(state, 2)]
+        ;
+
+        memcpy(input + size, piece, strlen(piece));
+        size += strlen(piece);
+    }
+
+    return size;
+} // vsccCheckRandomInput
+
+/**
+ * @brief random rule generating function
+ *
+ * @param[in,out] state     generator state (non-null)
+ * @param[in]     ruleIndex index of rule generated rule belongs to
+ * @param[in]     ruleCount count of rules in grammar
+ * @param[in]     depth     rule nesting depth
+ *
+ * @note rules reference only rules with greater index, so generated grammars are never left-recursive.
+ *       Top-level rules are always sequences, variants, optionals or repeats.
+ *
+ * @return generated rule (NULL if allocation failed)
+ */
+static inline VsccRule * vsccCheckRandomRule( uint32_t *state, size_t ruleIndex, size_t ruleCount, size_t depth ) {
+    VsccRule *rules[8];
+    uint32_t kind = vsccCheckRandom(state, 9);
+
+    if (depth == 0)
+        kind %= 4;
+    else if (depth >= VSCC_CHECK_RULE_DEPTH)
+        kind = 4 + kind % 5;
+
+    switch (kind) {
+    case 0:
+    case 1: {
+        const size_t count = kind == 0
+            ? 1 + vsccCheckRandom(state, 3)
+            : 2 + vsccCheckRandom(state, 5)
+        ;
+
+        for (size_t i = 0; i < count; i++)
+            rules[i] = vsccCheckRandomRule(state, ruleIndex, ruleCount, depth + 1);
+        return kind == 0
+            ? vsccRuleSequence(rules, count)
+            : vsccRuleVariant(rules, count)
+        ;
+    }
+
+    case 2:
+        return vsccRuleOptional(vsccCheckRandomRule(state, ruleIndex, ruleCount, depth + 1));
+
+    case 3: {
+        const bool atLeastOnce = vsccCheckRandom(state, 2);
+
+        return vsccRuleRepeat(vsccCheckRandomRule(state, ruleIndex, ruleCount, depth + 1), atLeastOnce);
+    }
+
+    case 4:
+    case 5: {
+        char terminal[16];
+        size_t length = 0;
+        const size_t count = vsccCheckRandom(state, 4);
+
+        for (size_t i = 0; i < count; i++) {
+            const char *piece = vsccCheckPieces[vsccCheckRandom(state, VSCC_CHECK_TERMINAL_PIECE_COUNT)];
+
+            memcpy(terminal + length, piece, strlen(piece));
+            length += strlen(piece);
+        }
+        terminal[length] = '\0';
+        return vsccRuleStringTerminal(terminal, NULL);
+    }
+
+    case 6: {
+        VsccRuleCharRange ranges[3];
+        const size_t count = 1 + vsccCheckRandom(state, 3);
+
+        for (size_t i = 0; i < count; i++) {
+            ranges[i].first = vsccCheckRandom(state, 3) != 0
+                ? 'a' + vsccCheckRandom(state, 3)
+                : 0xE0 + vsccCheckRandom(state, 20)
+            ;
+            ranges[i].last = ranges[i].first + vsccCheckRandom(state, 3);
+        }
+        return vsccRuleCharTerminal(ranges, count, NULL);
+    }
+
+    case 7:
+        if (ruleIndex + 1 < ruleCount) {
+            char name[32];
+
+            sprintf(name, "r%zu", ruleIndex + 1 + vsccCheckRandom(state, (uint32_t)(ruleCount - ruleIndex - 1)));
+            return vsccRuleReference(name, NULL);
+        }
+        return vsccRuleEnd(NULL);
+
+    default:
+        return vsccCheckRandom(state, 2)
+            ? vsccRuleEnd(NULL)
+            : vsccRuleEmpty(NULL)
+        ;
+    }
+} // vsccCheckRandomRule
+
+/**
+ * @brief random grammar generating function
+ *
+ * @param[in,out] state     generator state (non-null)
+ * @param[in]     ruleCount count of rules to generate (>= 1, rules are named r0, r1, ...)
+ *
+ * @return linked grammar (NULL if building failed, should be destroyed)
+ */
+static inline VsccGrammar * vsccCheckRandomGrammar( uint32_t *state, size_t ruleCount ) {
+    VsccGrammar *grammar = vsccGrammarCtor(NULL);
+    bool succeeded = grammar != NULL;
+
+    for (size_t i = 0; succeeded && i < ruleCount; i++) {
+        char name[32];
+
+        sprintf(name, "r%zu", i);
+        succeeded = vsccGrammarAddRule(grammar, name, vsccCheckRandomRule(state, i, ruleCount, 0));
+    }
+
+    if (succeeded && vsccGrammarLink(grammar))
+        return grammar;
+
+    vsccGrammarDtor(grammar);
+    return NULL;
+} // vsccCheckRandomGrammar
+
+#endif // !defined(VSCC_CHECK_H_)
+
+// vscc_check.h
@@ -0,0 +1,106 @@
+/**
+ * @brief JIT and matcher equivalence check
+ *
+ * @note matches random inputs by every rule of random grammars with VsccJit and VsccMatcher,
+ * results and matched lengths must be equal
+ */
+
+#include <stdio.h>
+
+#include "vscc.h"
+#include "vscc_check.h"
+
+/// @brief count of generated grammars
+#define VSCC_JIT_CHECK_GRAMMAR_COUNT 400
+
+/// @brief count of inputs matched by every grammar
+#define VSCC_JIT_CHECK_INPUT_COUNT 200
+
+/// @brief maximal count of pieces in generated input
+#define VSCC_JIT_CHECK_INPUT_PIECES 30
+
+/**
+ * @brief single grammar checking function
+ *
+ * @param[in,out] state generator state (non-null)
+ * @param[in]     index grammar index (for mismatch reporting)
+ *
+ * @return count of mismatched results (SIZE_MAX if grammar or JIT building failed)
+ */
+static size_t vsccJitCheckGrammar( uint32_t *state, size_t index ) {
+    const size_t ruleCount = 1 + vsccCheckRandom(state, 6);
+    VsccGrammar *grammar = vsccCheckRandomGrammar(state, ruleCount);
+    VsccMatcher matcher = grammar == NULL ? NULL : vsccMatcherCtor(grammar, NULL);
+    VsccJit jit = matcher == NULL ? NULL : vsccJitCtor(grammar, NULL);
+    size_t mismatchCount = 0;
+
+    if (jit == NULL) {
+        printf("grammar %zu: building failed\n", index);
+        vsccMatcherDtor(matcher);
+        vsccGrammarDtor(grammar);
+        return SIZE_MAX;
+    }
+
+    for (size_t i = 0; i < VSCC_JIT_CHECK_INPUT_COUNT; i++) {
+        char input[VSCC_JIT_CHECK_INPUT_PIECES * 2];
+        const size_t size = vsccCheckRandomInput(state, input, VSCC_JIT_CHECK_INPUT_PIECES);
+
+        for (size_t rule = 0; rule < ruleCount; rule++) {
+            size_t jitLength = 0;
+            const VsccMatchStatus jitStatus = vsccJitMatch(jit, rule, input, input + size, &jitLength);
+            const VsccMatchStatus status = vsccMatcherRun(matcher, rule, input, input + size);
+
+            if (jitStatus == status && (status != VSCC_MATCH_OK || jitLength == vsccMatcherLength(matcher)))
+                continue;
+
+            printf("MISMATCH grammar %zu rule r%zu \"%.*s\": JIT %d (%zu), matcher %d (%zu)\n",
+                index,
+                rule,
+                (int)size,
+                input,
+                (int)jitStatus,
+                jitLength,
+                (int)status,
+                vsccMatcherLength(matcher)
+            );
+            mismatchCount++;
+        }
+    }
+
+    vsccJitDtor(jit);
+    vsccMatcherDtor(matcher);
+    vsccGrammarDtor(grammar);
+    return mismatchCount;
+} // vsccJitCheckGrammar
+
+/**
+ * @brief check main function
+ *
+ * @return exit status (0 if all results are equal or platform has no JIT, 1 otherwise)
+ */
+int main( void ) {
+#if !(defined(__x86_64__) && (defined(__linux__) || defined(__unix__)))
+    printf("JIT isn't supported, check skipped\n");
+    return 0;
+#endif
+
+    uint32_t state = 1;
+    size_t mismatchCount = 0;
+
+    for (size_t i = 0; mismatchCount != SIZE_MAX && i < VSCC_JIT_CHECK_GRAMMAR_COUNT; i++) {
+        const size_t grammarMismatchCount = vsccJitCheckGrammar(&state, i);
+
+        mismatchCount = grammarMismatchCount == SIZE_MAX
+            ? SIZE_MAX
+            : mismatchCount + grammarMismatchCount
+        ;
+    }
+
+    if (mismatchCount == SIZE_MAX)
+        printf("JIT check failed\n");
+    else
+        printf("%zu mismatches\n", mismatchCount);
+    return mismatchCount == 0 ? 0 : 1;
+} // main
+
+// vscc_jit_check.c
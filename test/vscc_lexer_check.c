@@ -0,0 +1,250 @@
+/**
+ * @brief lexer and token stream matching check
+ *
+ * @note tokenizes random texts by VsccLexer and by trying every token rule with VsccMatcher at
+ * every offset (longest match, earlier rule wins ties), token streams and failure offsets must be
+ * equal. Then matches fixed texts in token mode.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "vscc.h"
+#include "vscc_check.h"
+
+/// @brief count of generated texts
+#define VSCC_LEXER_CHECK_TEXT_COUNT 20000
+
+/// @brief maximal count of pieces in generated text
+#define VSCC_LEXER_CHECK_TEXT_PIECES 20
+
+/// @brief checked grammar
+static const char vsccLexerCheckSource[] =
+    "program ::= stmt* $\n"
+    "stmt    ::= \"let\" id \"=\" expr \";\"\n"
+    "expr    ::= term { [+\\-] term }*\n"
+    "term    ::= atom { [*/] atom }*\n"
+    "atom    ::= num | id { \"(\" expr \")\" }? | \"(\" expr \")\"\n"
+    "keyword ::= \"let\"\n"
+    "id      ::= [a-zA-Z_] [a-zA-Z_0-9]*\n"
+    "num     ::= [0-9]+ { \".\" [0-9]+ }?\n"
+    "punct   ::= [=;+\\-*/()]\n"
+    "ws      ::= [ \\n\\t]+\n"
+    "comment ::= \"#\" [\\x00-\\x09\\x0B-\\x7Fé]*\n"
+;
+
+/// @brief pieces generated texts are made of
+static const char *vsccLexerCheckPieces[] = {
+    "let", " ", "x", "=", "1", "+", "(", ")", ";", "*", "\n", "#c", "ab", "2.5", "l", "et", "7", "é", "\t", "@",
+};
+
+/**
+ * @brief reference tokenizing function
+ *
+ * @param[in]  matcher     matcher over checked grammar (non-null)
+ * @param[in]  grammar     checked grammar (non-null)
+ * @param[in]  strBegin    text begin (non-null)
+ * @param[in]  strEnd      text end
+ * @param[out] tokens      token array (non-null, VsccToken elements), truncated and filled with tokens
+ * @param[out] errorOffset offset no token matches at destination (non-null, set if tokenizing failed)
+ *
+ * @return true if tokenized, false if no token matches at some offset or allocation failed
+ */
+static bool vsccLexerCheckReference( VsccMatcher matcher, const VsccGrammar *grammar, const char *strBegin, const char *strEnd, VsccArray *tokens, size_t *errorOffset ) {
+    vsccArrayTruncate(*tokens, 0);
+
+    for (const char *str = strBegin; str < strEnd; ) {
+        VsccToken token = { 0, (uint32_t)(str - strBegin), 0 };
+
+        for (size_t i = 0; i < grammar->ruleCount; i++)
+            if (true
+                && grammar->rules[i].token != VSCC_TOKEN_NONE
+                && vsccMatcherRun(matcher, i, str, strEnd) == VSCC_MATCH_OK
+                && vsccMatcherLength(matcher) > token.length
+            ) {
+                token.kind = (uint32_t)i;
+                token.length = (uint32_t)vsccMatcherLength(matcher);
+            }
+
+        if (token.length == 0) {
+            *errorOffset = str - strBegin;
+            return false;
+        }
+
+        if (grammar->rules[token.kind].token == VSCC_TOKEN_EMIT && !vsccArrayPush(tokens, &token)) {
+            *errorOffset = str - strBegin;
+            return false;
+        }
+        str += token.length;
+    }
+
+    return true;
+} // vsccLexerCheckReference
+
+/**
+ * @brief random texts checking function
+ *
+ * @param[in] lexer   lexer (non-null)
+ * @param[in] matcher matcher over checked grammar (non-null)
+ * @param[in] grammar checked grammar (non-null)
+ *
+ * @return count of mismatched results (SIZE_MAX if allocation failed)
+ */
+static size_t vsccLexerCheckTexts( VsccLexer lexer, VsccMatcher matcher, const VsccGrammar *grammar ) {
+    const size_t pieceCount = sizeof(vsccLexerCheckPieces) / sizeof(vsccLexerCheckPieces[0]);
+    VsccArray tokens = vsccArrayCtor(sizeof(VsccToken), NULL);
+    VsccArray referenceTokens = vsccArrayCtor(sizeof(VsccToken), NULL);
+    size_t mismatchCount = 0;
+    uint32_t state = 1;
+
+    if (tokens == NULL || referenceTokens == NULL) {
+        vsccArrayDtor(tokens);
+        vsccArrayDtor(referenceTokens);
+        return SIZE_MAX;
+    }
+
+    for (size_t i = 0; i < VSCC_LEXER_CHECK_TEXT_COUNT; i++) {
+        char text[VSCC_LEXER_CHECK_TEXT_PIECES * 3];
+        size_t size = 0;
+        const size_t count = vsccCheckRandom(&state, VSCC_LEXER_CHECK_TEXT_PIECES + 1);
+
+        for (size_t j = 0; j < count; j++) {
+            // invalid pieces are rare, so most texts are tokenized completely
+            const char *piece = vsccLexerCheckPieces[vsccCheckRandom(&state, (uint32_t)(vsccCheckRandom(&state, 16) == 0 ? pieceCount : pieceCount - 1))];
+
+            memcpy(text + size, piece, strlen(piece));
+            size += strlen(piece);
+        }
+
+        size_t errorOffset = 0, referenceErrorOffset = 0;
+        const VsccLexStatus status = vsccLexerRun(lexer, text, text + size, &tokens, &errorOffset);
+        const bool referenceLexed = vsccLexerCheckReference(matcher, grammar, text, text + size, &referenceTokens, &referenceErrorOffset);
+        const bool equal = referenceLexed
+            ? true
+                && status == VSCC_LEX_OK
+                && vsccArraySize(tokens) == vsccArraySize(referenceTokens)
+                && memcmp(vsccArrayData(tokens), vsccArrayData(referenceTokens), vsccArraySize(tokens) * sizeof(VsccToken)) == 0
+            : status == VSCC_LEX_FAILED && errorOffset == referenceErrorOffset
+        ;
+
+        if (!equal) {
+            printf("MISMATCH \"%.*s\": lexer status %d (%zu tokens), reference %s (%zu tokens)\n",
+                (int)size,
+                text,
+                (int)status,
+                vsccArraySize(tokens),
+                referenceLexed ? "tokenized" : "failed",
+                vsccArraySize(referenceTokens)
+            );
+            mismatchCount++;
+        }
+    }
+
+    vsccArrayDtor(tokens);
+    vsccArrayDtor(referenceTokens);
+    return mismatchCount;
+} // vsccLexerCheckTexts
+
+/**
+ * @brief token mode text checking function
+ *
+ * @param[in] lexer       lexer (non-null)
+ * @param[in] matcher     matcher over checked grammar (non-null)
+ * @param[in] text        text (non-null, null-terminated)
+ * @param[in] lexStatus   expected lexing status
+ * @param[in] matchStatus expected status of 'program' rule matching (if text is tokenized)
+ * @param[in] offset      expected lexing failure offset or first error offset (if matching failed)
+ *
+ * @return true if results are as expected, false otherwise
+ */
+static bool vsccLexerCheckTokenMode( VsccLexer lexer, VsccMatcher matcher, const char *text, VsccLexStatus lexStatus, VsccMatchStatus matchStatus, size_t offset ) {
+    const char *textEnd = text + strlen(text);
+    VsccArray tokens = vsccArrayCtor(sizeof(VsccToken), NULL);
+    size_t errorOffset = 0;
+    const VsccLexStatus status = tokens == NULL
+        ? VSCC_LEX_INTERNAL_ERROR
+        : vsccLexerRun(lexer, text, textEnd, &tokens, &errorOffset)
+    ;
+    bool succeeded = status == lexStatus;
+
+    if (succeeded && status == VSCC_LEX_FAILED)
+        succeeded = errorOffset == offset;
+    else if (succeeded) {
+        const VsccMatchStatus runStatus = vsccMatcherRunTokens(matcher, 0, text, textEnd, (const VsccToken *)vsccArrayData(tokens), vsccArraySize(tokens));
+
+        succeeded = true
+            && runStatus == matchStatus
+            && (runStatus != VSCC_MATCH_OK || vsccMatcherLength(matcher) == vsccArraySize(tokens))
+            && (runStatus != VSCC_MATCH_FAILED || (vsccMatcherErrorCount(matcher) != 0 && vsccMatcherError(matcher, 0).offset == offset))
+        ;
+    }
+
+    if (!succeeded)
+        printf("\"%s\": unexpected token mode result\n", text);
+
+    vsccArrayDtor(tokens);
+    return succeeded;
+} // vsccLexerCheckTokenMode
+
+/**
+ * @brief check main function
+ *
+ * @return exit status (0 if succeeded, 1 otherwise)
+ */
+int main( void ) {
+    const char *emitted[] = { "keyword", "id", "num", "punct" };
+    const char *skipped[] = { "ws", "comment" };
+    const VsccGrammarParseResult result = vsccGrammarParse(vsccLexerCheckSource, vsccLexerCheckSource + sizeof(vsccLexerCheckSource) - 1, NULL);
+
+    if (result.status != VSCC_RULE_PARSE_OK) {
+        printf("grammar parsing failed\n");
+        return 1;
+    }
+
+    VsccGrammar *grammar = result.ok;
+    bool succeeded = true;
+
+    for (size_t i = 0; i < sizeof(emitted) / sizeof(emitted[0]); i++)
+        succeeded = succeeded && vsccGrammarSetToken(grammar, emitted[i], VSCC_TOKEN_EMIT);
+    for (size_t i = 0; i < sizeof(skipped) / sizeof(skipped[0]); i++)
+        succeeded = succeeded && vsccGrammarSetToken(grammar, skipped[i], VSCC_TOKEN_SKIP);
+
+    succeeded = succeeded && vsccGrammarLink(grammar);
+
+    VsccLexer lexer = succeeded ? vsccLexerCtor(grammar, NULL) : NULL;
+    VsccMatcher matcher = succeeded ? vsccMatcherCtor(grammar, NULL) : NULL;
+
+    if (lexer == NULL || matcher == NULL) {
+        printf("lexer building failed\n");
+        succeeded = false;
+    }
+
+    if (succeeded) {
+        const size_t mismatchCount = vsccLexerCheckTexts(lexer, matcher, grammar);
+
+        if (mismatchCount == SIZE_MAX)
+            printf("token array allocation failed\n");
+        else
+            printf("%zu mismatches\n", mismatchCount);
+        succeeded = mismatchCount == 0;
+    }
+
+    succeeded = true
+        && succeeded
+        && vsccLexerCheckTokenMode(lexer, matcher, "", VSCC_LEX_OK, VSCC_MATCH_OK, 0)
+        && vsccLexerCheckTokenMode(lexer, matcher, "let x = 1;", VSCC_LEX_OK, VSCC_MATCH_OK, 0)
+        && vsccLexerCheckTokenMode(lexer, matcher, "let letter = f(2.5) * y; # note\nlet y=1;", VSCC_LEX_OK, VSCC_MATCH_OK, 0)
+        && vsccLexerCheckTokenMode(lexer, matcher, "letx = 1;", VSCC_LEX_OK, VSCC_MATCH_FAILED, 0)
+        && vsccLexerCheckTokenMode(lexer, matcher, "let x = (1 + ;", VSCC_LEX_OK, VSCC_MATCH_FAILED, 13)
+        && vsccLexerCheckTokenMode(lexer, matcher, "let x = 1 @;", VSCC_LEX_FAILED, VSCC_MATCH_FAILED, 10)
+    ;
+
+    printf(succeeded ? "lexer check passed\n" : "lexer check failed\n");
+
+    vsccMatcherDtor(matcher);
+    vsccLexerDtor(lexer);
+    vsccGrammarDtor(grammar);
+    return succeeded ? 0 : 1;
+} // main
+
+// vscc_lexer_check.c
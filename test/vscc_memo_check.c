@@ -0,0 +1,267 @@
+/**
+ * @brief memoizing and plain matcher equivalence check
+ *
+ * @note matches random inputs by random grammars with actions and recovery twice: with all
+ * rules memoized and with memoization disabled, statuses, lengths, values and errors must be equal.
+ * Then checks rule selection and that memo size follows memo window instead of input length.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "vscc.h"
+#include "vscc_check.h"
+
+/// @brief count of generated grammars
+#define VSCC_MEMO_CHECK_GRAMMAR_COUNT 1000
+
+/// @brief count of inputs matched by every grammar
+#define VSCC_MEMO_CHECK_INPUT_COUNT 100
+
+/// @brief maximal count of pieces in generated input
+#define VSCC_MEMO_CHECK_INPUT_PIECES 40
+
+/// @brief count of statements in long input
+#define VSCC_MEMO_CHECK_STATEMENT_COUNT 100000
+
+/// @brief memo size long input must fit into (in bytes)
+#define VSCC_MEMO_CHECK_SIZE_LIMIT (64 * 1024)
+
+/// @brief count of action invocations
+static size_t vsccMemoCheckActionCount = 0;
+
+/**
+ * @brief action function
+ *
+ * @note result is hash of rule, matched length and children, so equal value trees have equal results
+ */
+static bool vsccMemoCheckAction( void *context, const char *strBegin, const char *strEnd, void **children, size_t childCount, void **result ) {
+    uintptr_t hash = (uintptr_t)context * 31 + (uintptr_t)(strEnd - strBegin);
+
+    for (size_t i = 0; i < childCount; i++)
+        hash = hash * 1000003 ^ (uintptr_t)children[i];
+
+    vsccMemoCheckActionCount++;
+    *result = (void *)hash;
+    return true;
+} // vsccMemoCheckAction
+
+/**
+ * @brief matcher results comparing function
+ *
+ * @param[in] memoized memoizing matcher (non-null)
+ * @param[in] plain    non-memoizing matcher (non-null)
+ * @param[in] status   memoizing matcher run status
+ *
+ * @return true if results are equal, false otherwise
+ */
+static bool vsccMemoCheckEqual( const VsccMatcher memoized, const VsccMatcher plain, VsccMatchStatus status ) {
+    if (false
+        || vsccMatcherLength(memoized) != vsccMatcherLength(plain)
+        || vsccMatcherErrorCount(memoized) != vsccMatcherErrorCount(plain)
+        || (status != VSCC_MATCH_FAILED && vsccMatcherValueCount(memoized) != vsccMatcherValueCount(plain))
+    )
+        return false;
+
+    for (size_t i = 0; status != VSCC_MATCH_FAILED && i < vsccMatcherValueCount(memoized); i++)
+        if (vsccMatcherValue(memoized, i) != vsccMatcherValue(plain, i))
+            return false;
+
+    for (size_t i = 0; i < vsccMatcherErrorCount(memoized); i++) {
+        const VsccMatchError memoizedError = vsccMatcherError(memoized, i);
+        const VsccMatchError plainError = vsccMatcherError(plain, i);
+
+        if (false
+            || memoizedError.offset != plainError.offset
+            || memoizedError.expectedCount != plainError.expectedCount
+            || memcmp(memoizedError.expected, plainError.expected, memoizedError.expectedCount * sizeof(memoizedError.expected[0])) != 0
+        )
+            return false;
+    }
+
+    return true;
+} // vsccMemoCheckEqual
+
+/**
+ * @brief single random grammar checking function
+ *
+ * @param[in,out] state generator state (non-null)
+ * @param[in]     index grammar index (for mismatch reporting)
+ *
+ * @return count of mismatched results (SIZE_MAX if grammar or matcher building failed)
+ */
+static size_t vsccMemoCheckGrammar( uint32_t *state, size_t index ) {
+    const size_t ruleCount = 3 + vsccCheckRandom(state, 6);
+    VsccGrammar *grammar = vsccCheckRandomGrammar(state, ruleCount);
+    VsccMatcher memoized = NULL, plain = NULL;
+    size_t mismatchCount = SIZE_MAX;
+
+    if (grammar == NULL)
+        return SIZE_MAX;
+
+    for (size_t i = 0; i < ruleCount; i++) {
+        if (i != 0 && vsccCheckRandom(state, 2) == 0)
+            vsccGrammarSetRecover(grammar, grammar->rules[i].name, true);
+        if (vsccCheckRandom(state, 2))
+            vsccGrammarSetAction(grammar, grammar->rules[i].name, vsccMemoCheckAction, (void *)(uintptr_t)(i + 1));
+    }
+
+    memoized = vsccMatcherCtor(grammar, NULL);
+    plain = vsccMatcherCtor(grammar, NULL);
+
+    for (size_t i = 0; memoized != NULL && plain != NULL && i < ruleCount; i++)
+        if (!vsccMatcherSetMemo(memoized, i, true) || !vsccMatcherSetMemo(plain, i, false))
+            break;
+
+    if (memoized != NULL && plain != NULL)
+        mismatchCount = 0;
+
+    for (size_t i = 0; mismatchCount != SIZE_MAX && i < VSCC_MEMO_CHECK_INPUT_COUNT; i++) {
+        char input[VSCC_MEMO_CHECK_INPUT_PIECES * 2];
+        const size_t size = vsccCheckRandomInput(state, input, VSCC_MEMO_CHECK_INPUT_PIECES);
+        const size_t rule = vsccCheckRandom(state, (uint32_t)ruleCount);
+        const VsccMatchStatus memoizedStatus = vsccMatcherRun(memoized, rule, input, input + size);
+        const VsccMatchStatus plainStatus = vsccMatcherRun(plain, rule, input, input + size);
+
+        if (memoizedStatus == plainStatus && vsccMemoCheckEqual(memoized, plain, memoizedStatus))
+            continue;
+
+        printf("MISMATCH grammar %zu rule r%zu \"%.*s\": memoized %d (%zu), plain %d (%zu)\n",
+            index,
+            rule,
+            (int)size,
+            input,
+            (int)memoizedStatus,
+            vsccMatcherLength(memoized),
+            (int)plainStatus,
+            vsccMatcherLength(plain)
+        );
+        mismatchCount++;
+    }
+
+    vsccMatcherDtor(memoized);
+    vsccMatcherDtor(plain);
+    vsccGrammarDtor(grammar);
+    return mismatchCount;
+} // vsccMemoCheckGrammar
+
+/**
+ * @brief selection and memo window checking function
+ *
+ * @param[in,out] state generator state (non-null)
+ *
+ * @note 'expr' is invoked twice at every statement, so vsccGrammarLink must select it.
+ *       Statements are committed one by one, so memo of long input must stay small.
+ *
+ * @return true if succeeded, false otherwise
+ */
+static bool vsccMemoCheckWindow( uint32_t *state ) {
+    const char source[] =
+        "file ::= { stmt }* $\n"
+        "stmt ::= expr \";\" | expr \",\"\n"
+        "expr ::= term { \"+\" term }*\n"
+        "term ::= [a-z]+\n"
+    ;
+    const char *statements[] = { "ab+c;", "x,", "abc+de+f,", "q+q;" };
+    const VsccGrammarParseResult result = vsccGrammarParse(source, source + sizeof(source) - 1, NULL);
+
+    if (result.status != VSCC_RULE_PARSE_OK || !vsccGrammarLink(result.ok)) {
+        printf("grammar building failed\n");
+        return false;
+    }
+
+    VsccGrammar *grammar = result.ok;
+    const size_t expr = vsccGrammarFindRule(grammar, "expr");
+    char *input = (char *)malloc(VSCC_MEMO_CHECK_STATEMENT_COUNT * 9);
+    VsccMatcher memoized = vsccMatcherCtor(grammar, NULL);
+    VsccMatcher plain = vsccMatcherCtor(grammar, NULL);
+    size_t size = 0;
+    bool succeeded = input != NULL && memoized != NULL && plain != NULL;
+
+    if (succeeded && !grammar->rules[expr].memoize) {
+        printf("'expr' isn't selected for memoization\n");
+        succeeded = false;
+    }
+
+    for (size_t i = 0; succeeded && i < VSCC_MEMO_CHECK_STATEMENT_COUNT; i++) {
+        const char *statement = statements[vsccCheckRandom(state, sizeof(statements) / sizeof(statements[0]))];
+
+        memcpy(input + size, statement, strlen(statement));
+        size += strlen(statement);
+    }
+
+    for (size_t i = 0; succeeded && i < grammar->ruleCount; i++)
+        succeeded = vsccGrammarSetAction(grammar, grammar->rules[i].name, vsccMemoCheckAction, (void *)(uintptr_t)(i + 1));
+
+    if (succeeded) {
+        size_t memoizedActionCount, plainActionCount;
+
+        succeeded = vsccMatcherSetMemo(plain, expr, false);
+
+        vsccMemoCheckActionCount = 0;
+        succeeded = succeeded && vsccMatcherRun(memoized, 0, input, input + size) == VSCC_MATCH_OK;
+        memoizedActionCount = vsccMemoCheckActionCount;
+
+        vsccMemoCheckActionCount = 0;
+        succeeded = succeeded && vsccMatcherRun(plain, 0, input, input + size) == VSCC_MATCH_OK;
+        plainActionCount = vsccMemoCheckActionCount;
+
+        if (!succeeded || !vsccMemoCheckEqual(memoized, plain, VSCC_MATCH_OK)) {
+            printf("long input: memoized and plain results differ\n");
+            succeeded = false;
+        } else if (vsccMatcherMemoStats(memoized, expr).hits == 0 || memoizedActionCount >= plainActionCount) {
+            printf("long input: memoized 'expr' is never reused\n");
+            succeeded = false;
+        } else if (vsccMatcherMemoSize(memoized) > VSCC_MEMO_CHECK_SIZE_LIMIT) {
+            printf("long input: memo size %zu doesn't fit into %d bytes\n", vsccMatcherMemoSize(memoized), VSCC_MEMO_CHECK_SIZE_LIMIT);
+            succeeded = false;
+        }
+    }
+
+    // profile keeps memoization of rules that were reused only
+    if (succeeded) {
+        succeeded = vsccMatcherApplyMemoProfile(memoized)
+            && vsccMatcherRun(memoized, 0, input, input + size) == VSCC_MATCH_OK
+            && vsccMatcherMemoStats(memoized, expr).hits != 0
+        ;
+        if (!succeeded)
+            printf("memo profile dropped 'expr'\n");
+    }
+
+    vsccMatcherDtor(memoized);
+    vsccMatcherDtor(plain);
+    vsccGrammarDtor(grammar);
+    free(input);
+    return succeeded;
+} // vsccMemoCheckWindow
+
+/**
+ * @brief check main function
+ *
+ * @return exit status (0 if all results are equal, 1 otherwise)
+ */
+int main( void ) {
+    uint32_t state = 1;
+    size_t mismatchCount = 0;
+
+    for (size_t i = 0; mismatchCount != SIZE_MAX && i < VSCC_MEMO_CHECK_GRAMMAR_COUNT; i++) {
+        const size_t grammarMismatchCount = vsccMemoCheckGrammar(&state, i);
+
+        mismatchCount = grammarMismatchCount == SIZE_MAX
+            ? SIZE_MAX
+            : mismatchCount + grammarMismatchCount
+        ;
+    }
+
+    if (mismatchCount == SIZE_MAX)
+        printf("grammar building failed\n");
+    else
+        printf("%zu mismatches\n", mismatchCount);
+
+    const bool windowSucceeded = vsccMemoCheckWindow(&state);
+
+    return mismatchCount == 0 && windowSucceeded ? 0 : 1;
+} // main
+
+// vscc_memo_check.c
@@ -0,0 +1,114 @@
+/**
+ * @brief deep nesting check
+ *
+ * @note inputs nesting deeper than stack budget must be rejected with VSCC_MATCH_TOO_DEEP
+ * by both matcher and JIT instead of overflowing stack
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "vscc.h"
+
+/**
+ * @brief nested input building function
+ *
+ * @param[in]  depth nesting depth
+ * @param[out] size  input size destination (non-null)
+ *
+ * @return input (NULL if allocation failed, should be freed)
+ */
+static char * vsccNestingCheckInput( size_t depth, size_t *size ) {
+    char *input = (char *)malloc(depth * 2 + 1);
+
+    if (input == NULL)
+        return NULL;
+
+    memset(input, '(', depth);
+    input[depth] = 'x';
+    memset(input + depth + 1, ')', depth);
+    *size = depth * 2 + 1;
+    return input;
+} // vsccNestingCheckInput
+
+/**
+ * @brief single depth checking function
+ *
+ * @param[in] matcher matcher (non-null)
+ * @param[in] jit     JIT (nullable)
+ * @param[in] depth   nesting depth
+ * @param[in] status  expected status of matcher and JIT
+ *
+ * @return true if both returned expected status, false otherwise
+ */
+static bool vsccNestingCheckDepth( VsccMatcher matcher, VsccJit jit, size_t depth, VsccMatchStatus status ) {
+    size_t size = 0, length = 0;
+    char *input = vsccNestingCheckInput(depth, &size);
+
+    if (input == NULL) {
+        printf("input allocation failed\n");
+        return false;
+    }
+
+    const VsccMatchStatus matcherStatus = vsccMatcherRun(matcher, 0, input, input + size);
+    const VsccMatchStatus jitStatus = jit != NULL
+        ? vsccJitMatch(jit, 0, input, input + size, &length)
+        : status
+    ;
+    const bool succeeded = true
+        && matcherStatus == status
+        && jitStatus == status
+        && (status != VSCC_MATCH_OK || (vsccMatcherLength(matcher) == size && (jit == NULL || length == size)))
+    ;
+
+    if (!succeeded)
+        printf("depth %zu: expected status %d, matcher %d, JIT %d\n", depth, (int)status, (int)matcherStatus, (int)jitStatus);
+    free(input);
+    return succeeded;
+} // vsccNestingCheckDepth
+
+/**
+ * @brief check main function
+ *
+ * @return exit status (0 if succeeded, 1 otherwise)
+ */
+int main( void ) {
+    const char source[] = "e ::= \"(\" e \")\" | \"x\"\n";
+    const VsccGrammarParseResult result = vsccGrammarParse(source, source + sizeof(source) - 1, NULL);
+
+    if (result.status != VSCC_RULE_PARSE_OK || !vsccGrammarLink(result.ok)) {
+        printf("grammar building failed\n");
+        return 1;
+    }
+
+    VsccGrammar *grammar = result.ok;
+    VsccMatcher matcher = vsccMatcherCtor(grammar, NULL);
+    VsccJit jit = vsccJitCtor(grammar, NULL);
+    bool succeeded = matcher != NULL;
+
+    // memoized rules take another path to nested rule, so both are checked
+    for (size_t memoize = 0; succeeded && memoize < 2; memoize++) {
+        succeeded = true
+            && vsccMatcherSetMemo(matcher, 0, memoize)
+            && vsccNestingCheckDepth(matcher, jit, 1000, VSCC_MATCH_OK)
+            && vsccNestingCheckDepth(matcher, jit, 1000000, VSCC_MATCH_TOO_DEEP)
+            && vsccNestingCheckDepth(matcher, jit, 1000, VSCC_MATCH_OK)
+        ;
+    }
+
+    // budget is per matcher, so small one rejects moderate nesting too
+    if (succeeded) {
+        vsccMatcherSetStackSize(matcher, 64 << 10);
+        succeeded = vsccNestingCheckDepth(matcher, NULL, 10000, VSCC_MATCH_TOO_DEEP);
+    }
+
+    printf(succeeded ? "nesting check passed\n" : "nesting check failed\n");
+
+    vsccJitDtor(jit);
+    vsccMatcherDtor(matcher);
+    vsccGrammarDtor(grammar);
+    return succeeded ? 0 : 1;
+} // main
+
+// vscc_nesting_check.c
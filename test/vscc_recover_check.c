@@ -0,0 +1,195 @@
+/**
+ * @brief error recovery and farthest failure diagnostics check
+ *
+ * @note matches fixed inputs by statement grammar with and without recovery, statuses,
+ * matched lengths, error offsets and expected terminals must be as listed
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "vscc.h"
+
+/// @brief maximal count of errors in single case
+#define VSCC_RECOVER_CHECK_MAX_ERRORS 4
+
+/// @brief checked grammar
+static const char vsccRecoverCheckSource[] =
+    "file  ::= { stmt }* $\n"
+    "stmt  ::= ident \"=\" num \";\"\n"
+    "ident ::= [a-z]+\n"
+    "num   ::= [0-9]+\n"
+    "pairs ::= { \"a\" \"b\" }*\n"
+;
+
+/// @brief check case
+typedef struct __VsccRecoverCheckCase {
+    const char      * input;                                 ///< input text
+    VsccMatchStatus   status;                                ///< expected run status
+    size_t            length;                                ///< expected matched length (if status isn't VSCC_MATCH_FAILED)
+    size_t            errorCount;                            ///< expected count of errors
+    size_t            offsets[VSCC_RECOVER_CHECK_MAX_ERRORS]; ///< expected error offsets
+} VsccRecoverCheckCase;
+
+/**
+ * @brief statement action function
+ *
+ * @note matched statements produce non-null value, so NULL values of recovered statements are visible
+ */
+static bool vsccRecoverCheckAction( void *context, const char *strBegin, const char *strEnd, void **children, size_t childCount, void **result ) {
+    (void)context;
+    (void)strEnd;
+    (void)children;
+    (void)childCount;
+    *result = (void *)strBegin;
+    return true;
+} // vsccRecoverCheckAction
+
+/**
+ * @brief single case checking function
+ *
+ * @param[in] matcher   matcher (non-null)
+ * @param[in] ruleIndex index of rule to match
+ * @param[in] check     case to check (non-null)
+ *
+ * @return true if results are as expected, false otherwise
+ */
+static bool vsccRecoverCheckCase( VsccMatcher matcher, size_t ruleIndex, const VsccRecoverCheckCase *check ) {
+    const VsccMatchStatus status = vsccMatcherRun(matcher, ruleIndex, check->input, check->input + strlen(check->input));
+    bool succeeded = true
+        && status == check->status
+        && (status == VSCC_MATCH_FAILED || vsccMatcherLength(matcher) == check->length)
+        && vsccMatcherErrorCount(matcher) == check->errorCount
+    ;
+
+    for (size_t i = 0; succeeded && i < check->errorCount; i++)
+        succeeded = vsccMatcherError(matcher, i).offset == check->offsets[i];
+
+    if (!succeeded) {
+        printf("\"%s\": status %d, length %zu, errors:\n", check->input, (int)status, vsccMatcherLength(matcher));
+        vsccMatcherPrintErrors(stdout, matcher);
+    }
+    return succeeded;
+} // vsccRecoverCheckCase
+
+/**
+ * @brief terminal expectation checking function
+ *
+ * @param[in] matcher  matcher (non-null)
+ * @param[in] index    error index
+ * @param[in] terminal only terminal expected at error offset (non-null, linked)
+ *
+ * @return true if error expects 'terminal' only, false otherwise
+ */
+static bool vsccRecoverCheckExpected( const VsccMatcher matcher, size_t index, const VsccRule *terminal ) {
+    const VsccMatchError error = vsccMatcherError(matcher, index);
+
+    if (error.expectedCount == 1 && error.expected[0] == terminal->id)
+        return true;
+
+    printf("error %zu at %zu: unexpected expectation set of %zu terminals\n", index, error.offset, error.expectedCount);
+    return false;
+} // vsccRecoverCheckExpected
+
+/**
+ * @brief check main function
+ *
+ * @return exit status (0 if succeeded, 1 otherwise)
+ */
+int main( void ) {
+    const VsccRecoverCheckCase plainCases[] = {
+        { "a=1;bc=22;",     VSCC_MATCH_OK,     10, 0, { 0 } },
+        { "a=1;b=;c=3;",    VSCC_MATCH_FAILED, 0,  1, { 6 } },
+        { "a=1;b=2",        VSCC_MATCH_FAILED, 0,  1, { 7 } },
+    };
+    const VsccRecoverCheckCase recoverCases[] = {
+        { "a=1;bc=22;",          VSCC_MATCH_OK,        10, 0, { 0 } },
+        { "a=1;b=;c=3;d=x;e=5;", VSCC_MATCH_RECOVERED, 19, 2, { 6, 13 } },
+        { "a=;",                 VSCC_MATCH_RECOVERED, 3,  1, { 2 } },
+        { "=1;a=1;",             VSCC_MATCH_FAILED,    0,  1, { 0 } },
+    };
+    const VsccGrammarParseResult result = vsccGrammarParse(vsccRecoverCheckSource, vsccRecoverCheckSource + sizeof(vsccRecoverCheckSource) - 1, NULL);
+
+    if (result.status != VSCC_RULE_PARSE_OK || !vsccGrammarLink(result.ok)) {
+        printf("grammar building failed\n");
+        return 1;
+    }
+
+    VsccGrammar *grammar = result.ok;
+    const size_t file = vsccGrammarFindRule(grammar, "file");
+    const size_t pairs = vsccGrammarFindRule(grammar, "pairs");
+    const VsccRule *digits = grammar->rules[vsccGrammarFindRule(grammar, "num")].rule->repeat.rule;
+    VsccMatcher matcher = vsccMatcherCtor(grammar, NULL);
+    bool succeeded = matcher != NULL;
+
+    // errors are reported at farthest failure, missing number expects digits only
+    for (size_t i = 0; succeeded && i < sizeof(plainCases) / sizeof(plainCases[0]); i++)
+        succeeded = vsccRecoverCheckCase(matcher, file, &plainCases[i]);
+    succeeded = true
+        && succeeded
+        && vsccRecoverCheckCase(matcher, file, &plainCases[1])
+        && vsccRecoverCheckExpected(matcher, 0, digits)
+    ;
+
+    vsccMatcherDtor(matcher);
+
+    // statements recover by skipping to next offset statement matches at
+    succeeded = true
+        && succeeded
+        && vsccGrammarSetRecover(grammar, "stmt", true)
+        && vsccGrammarSetAction(grammar, "stmt", vsccRecoverCheckAction, NULL)
+    ;
+    matcher = succeeded ? vsccMatcherCtor(grammar, NULL) : NULL;
+    succeeded = matcher != NULL;
+
+    for (size_t i = 0; succeeded && i < sizeof(recoverCases) / sizeof(recoverCases[0]); i++)
+        succeeded = vsccRecoverCheckCase(matcher, file, &recoverCases[i]);
+
+    // recovered statements produce NULL values
+    if (succeeded) {
+        const char input[] = "a=1;b=;c=3;d=x;e=5;";
+
+        succeeded = true
+            && vsccMatcherRun(matcher, file, input, input + sizeof(input) - 1) == VSCC_MATCH_RECOVERED
+            && vsccRecoverCheckExpected(matcher, 0, digits)
+            && vsccMatcherValueCount(matcher) == 5
+            && vsccMatcherValue(matcher, 0) == input + 0
+            && vsccMatcherValue(matcher, 1) == NULL
+            && vsccMatcherValue(matcher, 2) == input + 7
+            && vsccMatcherValue(matcher, 3) == NULL
+            && vsccMatcherValue(matcher, 4) == input + 15
+        ;
+        if (!succeeded)
+            printf("unexpected values of recovered statements\n");
+    }
+
+    // error limit stops recovery, so the second error fails the run
+    if (succeeded) {
+        const VsccRecoverCheckCase limitCase = { "a=1;b=;c=3;d=x;e=5;", VSCC_MATCH_FAILED, 0, 2, { 6, 13 } };
+
+        vsccMatcherSetErrorLimit(matcher, 1);
+        succeeded = vsccRecoverCheckCase(matcher, file, &limitCase);
+        vsccMatcherSetErrorLimit(matcher, 16);
+    }
+
+    // partial match is reported at farthest failure, not at matched prefix end
+    if (succeeded) {
+        const VsccRecoverCheckCase partialCases[] = {
+            { "abab",  VSCC_MATCH_OK,     4, 0, { 0 } },
+            { "ababa", VSCC_MATCH_FAILED, 0, 1, { 5 } },
+            { "abx",   VSCC_MATCH_FAILED, 0, 1, { 2 } },
+        };
+
+        vsccMatcherSetRequireEnd(matcher, true);
+        for (size_t i = 0; succeeded && i < sizeof(partialCases) / sizeof(partialCases[0]); i++)
+            succeeded = vsccRecoverCheckCase(matcher, pairs, &partialCases[i]);
+    }
+
+    printf(succeeded ? "recovery check passed\n" : "recovery check failed\n");
+
+    vsccMatcherDtor(matcher);
+    vsccGrammarDtor(grammar);
+    return succeeded ? 0 : 1;
+} // main
+
+// vscc_recover_check.c
@@ -0,0 +1,288 @@
+/**
+ * @brief grammar slot concurrency check
+ *
+ * @note publishes sequence of grammar versions to slot while reader threads acquire snapshots and
+ * match by them. Freed grammar memory is poisoned and kept till the end, so reader that gets
+ * snapshot after it was destroyed sees broken version. Versions seen by every reader must be
+ * valid and non-decreasing, and all grammars must be destroyed after the last release.
+ */
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "vscc.h"
+
+/// @brief count of reader threads
+#define VSCC_SNAPSHOT_CHECK_READER_COUNT 4
+
+/// @brief count of published grammar versions
+#define VSCC_SNAPSHOT_CHECK_VERSION_COUNT 2000
+
+/// @brief count of acquires between matcher constructions by same reader
+#define VSCC_SNAPSHOT_CHECK_MATCH_PERIOD 16
+
+/// @brief poisoning allocator block header
+typedef union __VsccSnapshotCheckHeader {
+    struct {
+        union __VsccSnapshotCheckHeader * next; ///< next freed block
+        size_t                            size; ///< block size
+    } block; ///< block information
+    max_align_t _aligner; ///< header alignment forcer (so block data is aligned as malloc result)
+} VsccSnapshotCheckHeader;
+
+/// @brief poisoning allocator
+typedef struct __VsccSnapshotCheckAllocator {
+    VsccAllocator             allocator; ///< allocator interface
+    pthread_mutex_t           mutex;     ///< lock of allocator state
+    size_t                    liveCount; ///< count of allocated blocks
+    VsccSnapshotCheckHeader * freed;     ///< freed (poisoned) blocks
+} VsccSnapshotCheckAllocator;
+
+/// @brief reader thread state
+typedef struct __VsccSnapshotCheckReader {
+    VsccGrammarSlot   slot;         ///< slot to acquire snapshots from
+    const bool      * stop;         ///< reading stop flag (atomic)
+    size_t            acquireCount; ///< count of acquired snapshots
+    size_t            errorCount;   ///< count of broken or outdated snapshots seen
+} VsccSnapshotCheckReader;
+
+/**
+ * @brief poisoning allocator allocation function
+ *
+ * @param[in,out] context poisoning allocator (VsccSnapshotCheckAllocator *)
+ * @param[in]     size    block size
+ *
+ * @return allocated block (NULL if failed)
+ */
+static void * vsccSnapshotCheckAllocate( void *context, size_t size ) {
+    VsccSnapshotCheckAllocator *self = (VsccSnapshotCheckAllocator *)context;
+    VsccSnapshotCheckHeader *header = (VsccSnapshotCheckHeader *)malloc(sizeof(VsccSnapshotCheckHeader) + size);
+
+    if (header == NULL)
+        return NULL;
+    header->block.size = size;
+
+    pthread_mutex_lock(&self->mutex);
+    self->liveCount++;
+    pthread_mutex_unlock(&self->mutex);
+
+    return header + 1;
+} // vsccSnapshotCheckAllocate
+
+/**
+ * @brief poisoning allocator deallocation function
+ *
+ * @param[in,out] context poisoning allocator (VsccSnapshotCheckAllocator *)
+ * @param[in]     block   block to free (nullable)
+ *
+ * @note block is filled with garbage and isn't returned to malloc, so it can't be reused by other allocation
+ */
+static void vsccSnapshotCheckDeallocate( void *context, void *block ) {
+    VsccSnapshotCheckAllocator *self = (VsccSnapshotCheckAllocator *)context;
+
+    if (block == NULL)
+        return;
+
+    VsccSnapshotCheckHeader *header = (VsccSnapshotCheckHeader *)block - 1;
+
+    memset(block, 0xDD, header->block.size);
+
+    pthread_mutex_lock(&self->mutex);
+    self->liveCount--;
+    header->block.next = self->freed;
+    self->freed = header;
+    pthread_mutex_unlock(&self->mutex);
+} // vsccSnapshotCheckDeallocate
+
+/**
+ * @brief poisoning allocator reallocation function
+ *
+ * @param[in,out] context poisoning allocator (VsccSnapshotCheckAllocator *)
+ * @param[in]     block   block to resize (nullable)
+ * @param[in]     size    new block size
+ *
+ * @return resized block (NULL if failed, 'block' is kept valid then)
+ */
+static void * vsccSnapshotCheckReallocate( void *context, void *block, size_t size ) {
+    if (block == NULL)
+        return vsccSnapshotCheckAllocate(context, size);
+
+    void *newBlock = vsccSnapshotCheckAllocate(context, size);
+    const size_t oldSize = ((VsccSnapshotCheckHeader *)block - 1)->block.size;
+
+    if (newBlock == NULL)
+        return NULL;
+
+    memcpy(newBlock, block, oldSize < size ? oldSize : size);
+    vsccSnapshotCheckDeallocate(context, block);
+    return newBlock;
+} // vsccSnapshotCheckReallocate
+
+/**
+ * @brief snapshot version getting function
+ *
+ * @param[in] snapshot snapshot (non-null)
+ *
+ * @return version (SIZE_MAX if snapshot grammar is broken)
+ */
+static size_t vsccSnapshotCheckVersion( const VsccGrammarSnapshot snapshot ) {
+    const VsccGrammar *grammar = vsccGrammarSnapshotGrammar(snapshot);
+
+    if (grammar->ruleCount != 1 || grammar->rules[0].rule->type != VSCC_RULE_STRING_TERMINAL)
+        return SIZE_MAX;
+
+    const VsccRule *terminal = grammar->rules[0].rule;
+    size_t version = 0;
+
+    if (terminal->stringTerminal.length == 0 || terminal->stringTerminal.length > 8)
+        return SIZE_MAX;
+
+    for (size_t i = 0; i < terminal->stringTerminal.length; i++) {
+        const char digit = terminal->stringTerminal.string[i];
+
+        if (digit < '0' || digit > '9')
+            return SIZE_MAX;
+        version = version * 10 + (digit - '0');
+    }
+
+    return version;
+} // vsccSnapshotCheckVersion
+
+/**
+ * @brief reader thread function
+ *
+ * @param[in,out] context reader state (VsccSnapshotCheckReader *)
+ *
+ * @return NULL
+ */
+static void * vsccSnapshotCheckRead( void *context ) {
+    VsccSnapshotCheckReader *reader = (VsccSnapshotCheckReader *)context;
+    size_t lastVersion = 0;
+
+    while (!__atomic_load_n(reader->stop, __ATOMIC_ACQUIRE)) {
+        VsccGrammarSnapshot snapshot = vsccGrammarSlotAcquire(reader->slot);
+        const size_t version = vsccSnapshotCheckVersion(snapshot);
+
+        if (version == SIZE_MAX || version < lastVersion)
+            reader->errorCount++;
+        else
+            lastVersion = version;
+
+        // matcher uses snapshot grammar for a while, so snapshot must stay alive
+        if (reader->acquireCount % VSCC_SNAPSHOT_CHECK_MATCH_PERIOD == 0 && version != SIZE_MAX) {
+            const VsccRule *terminal = vsccGrammarSnapshotGrammar(snapshot)->rules[0].rule;
+            VsccMatcher matcher = vsccMatcherCtor(vsccGrammarSnapshotGrammar(snapshot), NULL);
+            const bool matched = true
+                && matcher != NULL
+                && vsccMatcherRun(matcher, 0, terminal->stringTerminal.string, terminal->stringTerminal.string + terminal->stringTerminal.length) == VSCC_MATCH_OK
+                && vsccSnapshotCheckVersion(snapshot) == version
+            ;
+
+            reader->errorCount += !matched;
+            vsccMatcherDtor(matcher);
+        }
+
+        vsccGrammarSnapshotRelease(snapshot);
+        reader->acquireCount++;
+    }
+
+    return NULL;
+} // vsccSnapshotCheckRead
+
+/**
+ * @brief grammar version snapshot building function
+ *
+ * @param[in] allocator allocator of grammar memory (non-null)
+ * @param[in] version   grammar version
+ *
+ * @return snapshot of grammar with single rule matching decimal version (NULL if building failed)
+ */
+static VsccGrammarSnapshot vsccSnapshotCheckBuild( const VsccAllocator *allocator, size_t version ) {
+    char source[64];
+    const int length = snprintf(source, sizeof(source), "version ::= \"%zu\"\n", version);
+    const VsccGrammarParseResult result = vsccGrammarParse(source, source + length, allocator);
+
+    return result.status == VSCC_RULE_PARSE_OK
+        ? vsccGrammarFreeze(result.ok)
+        : NULL
+    ;
+} // vsccSnapshotCheckBuild
+
+/**
+ * @brief check main function
+ *
+ * @return exit status (0 if succeeded, 1 otherwise)
+ */
+int main( void ) {
+    VsccSnapshotCheckAllocator poisoning = {
+        .allocator = {
+            .allocate   = vsccSnapshotCheckAllocate,
+            .reallocate = vsccSnapshotCheckReallocate,
+            .deallocate = vsccSnapshotCheckDeallocate,
+            .context    = NULL,
+        },
+        .mutex     = PTHREAD_MUTEX_INITIALIZER,
+        .liveCount = 0,
+        .freed     = NULL,
+    };
+    VsccSnapshotCheckReader readers[VSCC_SNAPSHOT_CHECK_READER_COUNT];
+    pthread_t threads[VSCC_SNAPSHOT_CHECK_READER_COUNT];
+    bool stop = false;
+    size_t startedCount = 0;
+
+    poisoning.allocator.context = &poisoning;
+
+    VsccGrammarSnapshot initial = vsccSnapshotCheckBuild(&poisoning.allocator, 0);
+    VsccGrammarSlot slot = initial == NULL ? NULL : vsccGrammarSlotCtor(initial, NULL);
+    bool succeeded = slot != NULL;
+
+    for (; succeeded && startedCount < VSCC_SNAPSHOT_CHECK_READER_COUNT; startedCount++) {
+        readers[startedCount] = (VsccSnapshotCheckReader) {
+            .slot         = slot,
+            .stop         = &stop,
+            .acquireCount = 0,
+            .errorCount   = 0,
+        };
+        succeeded = pthread_create(&threads[startedCount], NULL, vsccSnapshotCheckRead, &readers[startedCount]) == 0;
+    }
+
+    // every publish releases previous version, last reader holding it destroys grammar
+    for (size_t version = 1; succeeded && version <= VSCC_SNAPSHOT_CHECK_VERSION_COUNT; version++) {
+        VsccGrammarSnapshot snapshot = vsccSnapshotCheckBuild(&poisoning.allocator, version);
+
+        if (snapshot == NULL) {
+            printf("grammar building failed\n");
+            succeeded = false;
+        } else
+            vsccGrammarSlotPublish(slot, snapshot);
+    }
+
+    __atomic_store_n(&stop, true, __ATOMIC_RELEASE);
+
+    size_t acquireCount = 0, errorCount = 0;
+
+    for (size_t i = 0; i < startedCount; i++) {
+        pthread_join(threads[i], NULL);
+        acquireCount += readers[i].acquireCount;
+        errorCount += readers[i].errorCount;
+    }
+
+    vsccGrammarSlotDtor(slot);
+
+    printf("%zu acquires, %zu broken or outdated snapshots, %zu blocks leaked\n", acquireCount, errorCount, poisoning.liveCount);
+    succeeded = succeeded && errorCount == 0 && poisoning.liveCount == 0;
+
+    while (poisoning.freed != NULL) {
+        VsccSnapshotCheckHeader *next = poisoning.freed->block.next;
+
+        free(poisoning.freed);
+        poisoning.freed = next;
+    }
+
+    return succeeded ? 0 : 1;
+} // main
+
+// vscc_snapshot_check.c
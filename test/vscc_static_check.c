@@ -0,0 +1,166 @@
+/**
+ * @brief compile-time grammar equivalence check
+ *
+ * @note matches fixed input set by VsccStaticGrammar and by VsccMatcher over grammar built from it,
+ * results and matched lengths must be equal
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "vscc.h"
+#include "vscc_static.h"
+
+/// @brief count of generated inputs
+#define VSCC_STATIC_CHECK_GENERATED_COUNT 4096
+
+/// @brief maximal count of pieces in generated input
+#define VSCC_STATIC_CHECK_GENERATED_PIECES 24
+
+/// @brief checked grammar
+using VsccStaticCheckGrammar = VsccStaticGrammar<R"vsg(
+file   ::= { expr ";" }* $
+expr   ::= ws term { ws [+\-] ws term }* ws
+term   ::= factor { ws [*/] ws factor }*
+factor ::= number | ident | "(" expr ")" | "-" factor
+number ::= [0-9]+ { "." [0-9]+ }?
+ident  ::= [a-zA-Z_а-яё] [a-zA-Z0-9_а-яё]*
+ws     ::= [ \t\n]*
+)vsg">;
+
+/// @brief fixed inputs
+static const char *vsccStaticCheckInputs[] = {
+    "",
+    "1",
+    "1+2",
+    "(1+2)*3",
+    "  x * (y - 3.14) ;",
+    "переменная+1;",
+    "((((1))))",
+    "1+",
+    ")(",
+    "ё*ж;",
+    "1.;",
+    "a;b;c;",
+    "--1;",
+    "\xD0",
+    "\xFF",
+    "я\xD1",
+    "x\t*\n-y ; 2/3;",
+};
+
+/// @brief pieces generated inputs are made of
+static const char *vsccStaticCheckPieces[] = {
+    "1", "2", ".", "+", "-", "*", "/", "(", ")", " ", "\n", "x", "_", "Z", "я", "ё", ";", "\xD0", "\x80",
+};
+
+/**
+ * @brief single input checking function
+ *
+ * @tparam Name rule name
+ *
+ * @param[in] matcher matcher over built grammar (non-null)
+ * @param[in] grammar built grammar (non-null)
+ * @param[in] input   input text (non-null, null-terminated)
+ *
+ * @return true if results are equal, false otherwise
+ */
+template <VsccStaticString Name>
+static bool vsccStaticCheckInput( VsccMatcher matcher, const VsccGrammar *grammar, const char *input ) {
+    const char *inputEnd = input + strlen(input);
+    size_t staticLength = 0;
+    const bool staticMatched = VsccStaticCheckGrammar::match<Name>(input, inputEnd, &staticLength);
+    const VsccMatchStatus status = vsccMatcherRun(matcher, vsccGrammarFindRule(grammar, Name.data), input, inputEnd);
+    const bool matched = status == VSCC_MATCH_OK;
+
+    if (matched == staticMatched && (!matched || vsccMatcherLength(matcher) == staticLength))
+        return true;
+
+    printf("MISMATCH %s \"%s\": static %s (%zu), matcher %s (%zu)\n",
+        Name.data,
+        input,
+        staticMatched ? "matched" : "failed",
+        staticLength,
+        matched ? "matched" : "failed",
+        vsccMatcherLength(matcher)
+    );
+    return false;
+} // vsccStaticCheckInput
+
+/**
+ * @brief rule checking function
+ *
+ * @tparam Name rule name
+ *
+ * @param[in] matcher matcher over built grammar (non-null)
+ * @param[in] grammar built grammar (non-null)
+ *
+ * @return count of mismatched inputs
+ */
+template <VsccStaticString Name>
+static size_t vsccStaticCheckRule( VsccMatcher matcher, const VsccGrammar *grammar ) {
+    const size_t pieceCount = sizeof(vsccStaticCheckPieces) / sizeof(vsccStaticCheckPieces[0]);
+    size_t mismatchCount = 0;
+    char input[VSCC_STATIC_CHECK_GENERATED_PIECES * 2 + 1]; // pieces are at most 2 bytes long
+    uint32_t state = 1;
+
+    for (size_t i = 0; i < sizeof(vsccStaticCheckInputs) / sizeof(vsccStaticCheckInputs[0]); i++)
+        mismatchCount += !vsccStaticCheckInput<Name>(matcher, grammar, vsccStaticCheckInputs[i]);
+
+    // generated set is fixed too, because generator is seeded with constant
+    for (size_t i = 0; i < VSCC_STATIC_CHECK_GENERATED_COUNT; i++) {
+        size_t length = 0;
+
+        state = state * 1664525 + 1013904223;
+
+        const size_t count = (state >> 16) % (VSCC_STATIC_CHECK_GENERATED_PIECES + 1);
+
+        for (size_t j = 0; j < count; j++) {
+            state = state * 1664525 + 1013904223;
+
+            const char *piece = vsccStaticCheckPieces[(state >> 16) % pieceCount];
+
+            memcpy(input + length, piece, strlen(piece));
+            length += strlen(piece);
+        }
+        input[length] = '\0';
+
+        mismatchCount += !vsccStaticCheckInput<Name>(matcher, grammar, input);
+    }
+
+    return mismatchCount;
+} // vsccStaticCheckRule
+
+/**
+ * @brief check main function
+ *
+ * @return exit status (0 if all results are equal, 1 otherwise)
+ */
+int main( void ) {
+    VsccGrammar *grammar = VsccStaticCheckGrammar::build(NULL);
+    VsccMatcher matcher = grammar == NULL ? NULL : vsccMatcherCtor(grammar, NULL);
+
+    if (matcher == NULL) {
+        printf("grammar building failed\n");
+        vsccGrammarDtor(grammar);
+        return 1;
+    }
+
+    const size_t mismatchCount = 0
+        + vsccStaticCheckRule<"file">(matcher, grammar)
+        + vsccStaticCheckRule<"expr">(matcher, grammar)
+        + vsccStaticCheckRule<"term">(matcher, grammar)
+        + vsccStaticCheckRule<"factor">(matcher, grammar)
+        + vsccStaticCheckRule<"number">(matcher, grammar)
+        + vsccStaticCheckRule<"ident">(matcher, grammar)
+        + vsccStaticCheckRule<"ws">(matcher, grammar)
+    ;
+
+    printf("%zu mismatches\n", mismatchCount);
+
+    vsccMatcherDtor(matcher);
+    vsccGrammarDtor(grammar);
+    return mismatchCount == 0 ? 0 : 1;
+} // main
+
+// vscc_static_check.c